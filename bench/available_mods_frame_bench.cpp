@@ -0,0 +1,143 @@
+#include "bench.hpp"
+#include "gui/virtual_list.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <imgui.h>
+#include <string>
+#include <vector>
+
+// Frame time of the Available Mods list over a synthetic catalog, on ImGui without a renderer backend:
+// the draw lists are built every frame but never submitted, so this is the CPU side of a frame only.
+//   bench_available_mods_frame [package count = 10000] [frame count = 600]
+// The list scrolls through the whole catalog over the frames, laid out with virtual_list and with every row.
+namespace
+{
+	struct synthetic_package
+	{
+		std::string name;
+		std::string owner;
+		std::string description;
+		std::string version_number;
+	};
+
+	// Same widgets as a row of the real panel.
+	void render_row(const synthetic_package& package)
+	{
+		ImGui::BeginChild(package.name.c_str(), ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
+		ImGui::Dummy(ImVec2(128, 128));
+		ImGui::SameLine();
+		ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nLatest Version: %s",
+		                   package.owner.c_str(),
+		                   package.name.c_str(),
+		                   package.description.c_str(),
+		                   package.version_number.c_str());
+		ImGui::Button("Install");
+		ImGui::EndChild();
+	}
+
+	template<typename F>
+	std::vector<double> run_frames(int frame_count, float scroll_per_frame, F&& render_list)
+	{
+		std::vector<double> frame_ms;
+		for (int frame = 0; frame < frame_count; frame++)
+		{
+			const imm::bench::stopwatch watch;
+			ImGui::NewFrame();
+
+			ImGui::SetNextWindowPos(ImVec2(0, 0));
+			ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+			ImGui::Begin("Available Mods", nullptr, ImGuiWindowFlags_NoDecoration);
+			ImGui::BeginChild("Available Mods List");
+			ImGui::SetScrollY(std::min(frame * scroll_per_frame, ImGui::GetScrollMaxY()));
+			render_list();
+			ImGui::EndChild();
+			ImGui::End();
+
+			ImGui::Render();
+			frame_ms.push_back(watch.elapsed_ms());
+		}
+		return frame_ms;
+	}
+
+	void report_frames(const char* name, std::vector<double> frame_ms)
+	{
+		std::sort(frame_ms.begin(), frame_ms.end());
+		double total = 0;
+		for (const auto ms : frame_ms)
+		{
+			total += ms;
+		}
+		std::printf("%s\n", name);
+		imm::bench::report("  mean frame", total / frame_ms.size());
+		imm::bench::report("  p50 frame", frame_ms[frame_ms.size() / 2]);
+		imm::bench::report("  p99 frame", frame_ms[frame_ms.size() * 99 / 100]);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const size_t package_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000;
+	const int frame_count      = argc > 2 ? std::atoi(argv[2]) : 600;
+
+	std::vector<synthetic_package> packages(package_count);
+	std::vector<const synthetic_package*> items;
+	for (size_t i = 0; i < package_count; i++)
+	{
+		// One to three lines once wrapped, like most catalog descriptions.
+		std::string description;
+		for (size_t sentence = 0; sentence < 1 + i % 3 * 4; sentence++)
+		{
+			description += "Adds a few things to the game, tweaks a few others. ";
+		}
+
+		packages[i] = {.name           = "Mod_" + std::to_string(i),
+		               .owner          = "Owner" + std::to_string(i % 700),
+		               .description    = std::move(description),
+		               .version_number = "1." + std::to_string(i % 10) + ".0"};
+		items.push_back(&packages[i]);
+	}
+
+	ImGui::CreateContext();
+	auto& io       = ImGui::GetIO();
+	io.DisplaySize = ImVec2(1280, 800);
+	io.DeltaTime   = 1.0f / 60.0f;
+	io.IniFilename = nullptr;
+	// Building the font atlas is all a renderer backend would have done before the first frame.
+	unsigned char* font_pixels = nullptr;
+	int font_width             = 0;
+	int font_height            = 0;
+	io.Fonts->GetTexDataAsRGBA32(&font_pixels, &font_width, &font_height);
+
+	// Roughly the height of the catalog, so both runs scroll from top to bottom.
+	const float scroll_per_frame = package_count * 150.0f / frame_count;
+
+	imm::ui::virtual_list list(200.0f);
+	list.set_items(items);
+	report_frames("virtual_list",
+	              run_frames(frame_count,
+	                         scroll_per_frame,
+	                         [&]
+	                         {
+		                         list.render(
+		                             [&](size_t row)
+		                             {
+			                             render_row(*items[row]);
+		                             });
+	                         }));
+
+	report_frames("every row",
+	              run_frames(frame_count,
+	                         scroll_per_frame,
+	                         [&]
+	                         {
+		                         for (const auto& package : packages)
+		                         {
+			                         render_row(package);
+		                         }
+	                         }));
+
+	ImGui::DestroyContext();
+	imm::bench::report_peak_rss();
+	return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <Psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+// Shared by the benchmarks, each one is its own executable so peak RSS only covers what it measured.
+namespace imm::bench
+{
+	// Peak resident set of the process so far.
+	inline uint64_t peak_rss_bytes()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return 0;
+		}
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+		{
+			return 0;
+		}
+		// Kilobytes on Linux.
+		return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+	}
+
+	class stopwatch
+	{
+		std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+
+	public:
+		double elapsed_ms() const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+		}
+	};
+
+	inline void report(const char* name, double ms)
+	{
+		std::printf("%-40s %10.3f ms\n", name, ms);
+	}
+
+	inline void report_peak_rss()
+	{
+		std::printf("%-40s %10.1f MiB\n", "peak rss", peak_rss_bytes() / (1024.0 * 1024.0));
+	}
+} // namespace imm::bench
@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include "logger.hpp"
+#include "thunderstore/v1/catalog_file.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Cold start of the catalog, from a recorded /api/v1/package/ response:
+//   bench_catalog_load <index.json> convert    writes <index.json>.bin, run it once first
+//   bench_catalog_load <index.json> json       nlohmann::json::parse of the index into packages
+//   bench_catalog_load <index.json> views      maps the .bin and reads every string through the views
+//   bench_catalog_load <index.json> packages   maps the .bin and copies every package out with to_package()
+// Run each mode in its own process, peak RSS is per process.
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::fprintf(stderr, "usage: %s <index.json> convert|json|views|packages\n", argv[0]);
+		return 1;
+	}
+
+	logger = spdlog::default_logger();
+
+	const std::filesystem::path index_path = argv[1];
+	const auto catalog_path                = std::filesystem::path(index_path).concat(".bin");
+	const std::string mode                 = argv[2];
+
+	const imm::bench::stopwatch watch;
+	size_t package_count = 0;
+	if (mode == "convert")
+	{
+		std::ifstream f(index_path, std::ios::binary);
+		if (!ts::v1::convert_package_index(f, catalog_path))
+		{
+			std::fprintf(stderr, "could not convert %s\n", argv[1]);
+			return 1;
+		}
+		package_count = ts::v1::catalog_file(catalog_path).package_count();
+	}
+	else if (mode == "json")
+	{
+		std::ifstream f(index_path, std::ios::binary);
+		const auto packages = nlohmann::json::parse(f).get<std::vector<ts::v1::package>>();
+		package_count       = packages.size();
+	}
+	else if (mode == "views" || mode == "packages")
+	{
+		const ts::v1::catalog_file catalog(catalog_path);
+		if (!catalog.is_open())
+		{
+			std::fprintf(stderr, "no catalog at %s, run convert first\n", catalog_path.string().c_str());
+			return 1;
+		}
+
+		// Summed so the reads can't be optimized out.
+		size_t string_bytes = 0;
+		std::vector<ts::v1::package> packages;
+		for (size_t i = 0; i < catalog.package_count(); i++)
+		{
+			const auto package = catalog.package(i);
+			if (mode == "packages")
+			{
+				packages.push_back(package.to_package());
+				continue;
+			}
+
+			string_bytes += package.full_name().size() + package.owner().size() + package.date_updated().size();
+			for (size_t c = 0; c < package.category_count(); c++)
+			{
+				string_bytes += package.category(c).size();
+			}
+			for (size_t v = 0; v < package.version_count(); v++)
+			{
+				const auto version  = package.version(v);
+				string_bytes       += version.full_name().size() + version.description().size() + version.icon().size() + version.download_url().size();
+				for (size_t d = 0; d < version.dependency_count(); d++)
+				{
+					string_bytes += version.dependency(d).size();
+				}
+			}
+		}
+		package_count = catalog.package_count();
+		std::printf("%zu string bytes read, %zu packages copied\n", string_bytes, packages.size());
+	}
+	else
+	{
+		std::fprintf(stderr, "unknown mode %s\n", mode.c_str());
+		return 1;
+	}
+
+	std::printf("%zu packages (%s)\n", package_count, mode.c_str());
+	imm::bench::report("load", watch.elapsed_ms());
+	imm::bench::report_peak_rss();
+	return 0;
+}
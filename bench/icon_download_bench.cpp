@@ -0,0 +1,82 @@
+#include "bench.hpp"
+#include "logger.hpp"
+#include "net/download_pool.hpp"
+#include "support/http_stand_in.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Icon download throughput of download_pool at several in flight limits, against a local server:
+//   bench_icon_download [icon count, 200 by default] [server latency in ms, 30 by default]
+// Every icon is a 24 KiB body, each request answered after the latency.
+// The last run asks for icons that don't exist, they fail on their first 404 instead of tying up a worker with retries.
+namespace
+{
+	// Downloads count icons with max_in_flight workers, returns how many succeeded.
+	size_t download_icons(const imm::test::http_stand_in& server, const std::filesystem::path& folder, const char* target_prefix, size_t count, size_t max_in_flight)
+	{
+		std::filesystem::remove_all(folder);
+		std::filesystem::create_directories(folder);
+
+		std::atomic<size_t> succeeded = 0;
+		imm::net::download_pool pool(max_in_flight);
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto name = std::to_string(i) + ".png";
+			pool.enqueue({.url     = server.url(target_prefix + name),
+			              .path    = folder / name,
+			              .on_done = [&](bool success)
+			              {
+				              succeeded += success;
+			              }});
+		}
+		pool.wait_idle();
+		return succeeded;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const size_t icon_count = argc > 1 ? std::stoul(argv[1]) : 200;
+	const auto latency      = std::chrono::milliseconds(argc > 2 ? std::stoi(argv[2]) : 30);
+
+	logger = spdlog::default_logger();
+	logger->set_level(spdlog::level::warn);
+
+	const std::string icon(24 * 1024, 'x');
+	imm::test::http_stand_in server(
+	    [&](const imm::test::http_request& request) -> imm::test::http_response
+	    {
+		    std::this_thread::sleep_for(latency);
+		    if (request.target.starts_with("/missing/"))
+		    {
+			    return {.status = 404};
+		    }
+		    return {.status = 200, .headers = {{"Content-Type", "image/png"}}, .body = icon};
+	    });
+
+	const auto folder = std::filesystem::temp_directory_path() / "imm_bench_icon_download";
+	for (const size_t max_in_flight : {1, 2, 4, 8, 16, 32})
+	{
+		const imm::bench::stopwatch watch;
+		const auto succeeded = download_icons(server, folder, "/icons/", icon_count, max_in_flight);
+		const auto ms        = watch.elapsed_ms();
+
+		const auto name = std::to_string(max_in_flight) + " in flight (" + std::to_string(succeeded) + " icons)";
+		imm::bench::report(name.c_str(), ms);
+		std::printf("    %.0f icons/s\n", succeeded * 1000.0 / ms);
+	}
+
+	{
+		const size_t missing_count = 32;
+		const imm::bench::stopwatch watch;
+		download_icons(server, folder, "/missing/", missing_count, 8);
+		const auto name = std::to_string(missing_count) + " missing icons, 8 in flight";
+		imm::bench::report(name.c_str(), watch.elapsed_ms());
+	}
+
+	std::filesystem::remove_all(folder);
+	imm::bench::report_peak_rss();
+	return 0;
+}
@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include "hash/fnv1a.hpp"
+#include "icons/image.hpp"
+#include "icons/thumbnail_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// What icon_cache::load_icon costs per icon on a cold start (PNG decode and downscale) versus a warm one (cached thumbnail):
+//   bench_icon_thumbnails <folder of downloaded icon PNGs>
+// Thumbnails are written to a temporary folder that is removed afterwards.
+namespace
+{
+	constexpr int cell_size = 128;
+
+	std::vector<char> read_file(const std::filesystem::path& path)
+	{
+		std::ifstream f(path, std::ios::binary);
+		return std::vector<char>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <icons folder>\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<std::filesystem::path> png_paths;
+	for (const auto& entry : std::filesystem::directory_iterator(argv[1]))
+	{
+		if (entry.path().extension() == ".png")
+		{
+			png_paths.push_back(entry.path());
+		}
+	}
+	if (png_paths.empty())
+	{
+		std::fprintf(stderr, "no .png in %s\n", argv[1]);
+		return 1;
+	}
+
+	const auto thumbnails_folder = std::filesystem::temp_directory_path() / "imm_bench_thumbnails";
+	std::filesystem::remove_all(thumbnails_folder);
+	const imm::icons::thumbnail_cache thumbnails(thumbnails_folder);
+
+	double decode_ms = 0;
+	for (const auto& path : png_paths)
+	{
+		const auto file_data = read_file(path);
+
+		const imm::bench::stopwatch watch;
+		int width                 = 0;
+		int height                = 0;
+		unsigned char* image_data = stbi_load_from_memory((const stbi_uc*)file_data.data(), (int)file_data.size(), &width, &height, NULL, 4);
+		if (!image_data)
+		{
+			continue;
+		}
+		imm::icons::rgba_image decoded{.width = width, .height = height};
+		decoded.pixels.assign(image_data, image_data + (size_t)width * height * 4);
+		stbi_image_free(image_data);
+		const auto image  = imm::icons::resize_icon(std::move(decoded), cell_size, cell_size);
+		decode_ms        += watch.elapsed_ms();
+
+		thumbnails.store(imm::hash::fnv1a_64(file_data.data(), file_data.size()), image);
+	}
+
+	double thumbnail_ms    = 0;
+	size_t thumbnail_count = 0;
+	for (const auto& path : png_paths)
+	{
+		const imm::bench::stopwatch watch;
+		// The PNG is still read and hashed on a warm start, the hash names the thumbnail.
+		const auto file_data  = read_file(path);
+		const auto thumbnail  = thumbnails.load(imm::hash::fnv1a_64(file_data.data(), file_data.size()), cell_size, cell_size);
+		thumbnail_ms         += watch.elapsed_ms();
+		thumbnail_count      += thumbnail.has_value();
+	}
+
+	std::filesystem::remove_all(thumbnails_folder);
+
+	std::printf("%zu icons, %zu thumbnails\n", png_paths.size(), thumbnail_count);
+	imm::bench::report("png decode + downscale", decode_ms);
+	imm::bench::report("png decode + downscale per icon", decode_ms / png_paths.size());
+	imm::bench::report("read + hash + thumbnail", thumbnail_ms);
+	imm::bench::report("read + hash + thumbnail per icon", thumbnail_ms / png_paths.size());
+	return 0;
+}
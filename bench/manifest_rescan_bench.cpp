@@ -0,0 +1,109 @@
+#include "bench.hpp"
+#include "install/manifest_index.hpp"
+
+#include <fstream>
+#include <string>
+
+// Installed packages scan on a synthetic plugins folder written to a scratch folder:
+//   bench_manifest_rescan [mod count, 300 by default] [scratch folder, under the temp folder by default]
+// "full walk" is the scan the manifest index replaced: every file below the plugins folder visited, every manifest parsed.
+// Each mod has a manifest, a few dlls and 3 levels of asset folders, like the bigger content mods do.
+namespace
+{
+	void write_file(const std::filesystem::path& path, const std::string& content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+	}
+
+	void write_mod(const std::filesystem::path& plugins, const std::string& name)
+	{
+		const auto folder = plugins / ("Owner-" + name);
+		write_file(folder / "manifest.json", R"({"name": ")" + name + R"(", "version_number": "1.0.0", "website_url": "", "description": "A synthetic mod", "dependencies": ["Owner-Library-1.0.0"]})");
+		write_file(folder / "README.md", "readme");
+		for (int i = 0; i < 3; i++)
+		{
+			write_file(folder / (name + std::to_string(i) + ".dll"), "dll");
+		}
+		for (const char* sub : {"assets/textures", "assets/sounds", "lang/en"})
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				write_file(folder / sub / ("file" + std::to_string(i)), "data");
+			}
+		}
+	}
+
+	size_t full_walk(const std::filesystem::path& plugins)
+	{
+		size_t count = 0;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(plugins, std::filesystem::directory_options::skip_permission_denied))
+		{
+			if (entry.is_directory() || (entry.path().filename() != "manifest.json" && entry.path().filename() != "manifest_disabled.json"))
+			{
+				continue;
+			}
+
+			std::ifstream f(entry.path());
+			const auto j = nlohmann::json::parse(f, nullptr, false, true);
+			count       += j.is_object();
+		}
+		return count;
+	}
+
+	void report_scan(const char* name, imm::install::manifest_index& index, const std::filesystem::path& plugins)
+	{
+		const imm::bench::stopwatch watch;
+		const auto manifests = index.scan(plugins, {});
+		const auto ms        = watch.elapsed_ms();
+
+		const auto stats = index.last_stats();
+		imm::bench::report(name, ms);
+		std::printf("    %zu manifests, %zu directories listed, %zu reused, %zu manifests parsed\n",
+		            manifests.size(),
+		            stats.listed_directories,
+		            stats.reused_directories,
+		            stats.parsed_manifests);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const size_t mod_count = argc > 1 ? std::stoul(argv[1]) : 300;
+	const auto scratch     = argc > 2 ? std::filesystem::path(argv[2]) : std::filesystem::temp_directory_path() / "imm_bench_manifest_rescan";
+	std::filesystem::remove_all(scratch);
+
+	const auto plugins    = scratch / "plugins";
+	const auto index_path = scratch / "installed_manifests.json";
+	for (size_t i = 0; i < mod_count; i++)
+	{
+		write_mod(plugins, "Mod" + std::to_string(i));
+	}
+
+	{
+		const imm::bench::stopwatch watch;
+		const auto count = full_walk(plugins);
+		imm::bench::report("full walk", watch.elapsed_ms());
+		std::printf("    %zu manifests\n", count);
+	}
+
+	{
+		imm::install::manifest_index index(index_path);
+		report_scan("first scan, no index", index, plugins);
+	}
+
+	// Like the next start of the app, the index is loaded from disk.
+	const imm::bench::stopwatch load_watch;
+	imm::install::manifest_index index(index_path);
+	imm::bench::report("load index", load_watch.elapsed_ms());
+	report_scan("rescan, nothing changed", index, plugins);
+
+	write_mod(plugins, "JustInstalled");
+	report_scan("rescan after one install", index, plugins);
+
+	std::filesystem::remove_all(plugins / "Owner-Mod0");
+	report_scan("rescan after one uninstall", index, plugins);
+
+	std::filesystem::remove_all(scratch);
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "logger.hpp"
+#include "thunderstore/v1/package_reader.hpp"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Replays a recorded /api/v1/package/ response:
+//   bench_package_index_load <index.json> [sax|dom]
+// sax streams it like the catalog loader does, dom is the old path: the whole body in a string, a json DOM of it,
+// then a copy of every package. Run each mode in its own process, peak RSS is per process.
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <index.json> [sax|dom]\n", argv[0]);
+		return 1;
+	}
+
+	logger = spdlog::default_logger();
+
+	const std::string mode = argc > 2 ? argv[2] : "sax";
+	std::vector<std::unique_ptr<ts::v1::package>> packages;
+
+	const imm::bench::stopwatch watch;
+	if (mode == "sax")
+	{
+		std::ifstream f(argv[1], std::ios::binary);
+		const auto ok = ts::v1::read_package_index(f,
+		                                           [&](ts::v1::package&& package)
+		                                           {
+			                                           packages.push_back(std::make_unique<ts::v1::package>(std::move(package)));
+		                                           });
+		if (!ok)
+		{
+			std::fprintf(stderr, "%s is not a package index\n", argv[1]);
+			return 1;
+		}
+	}
+	else if (mode == "dom")
+	{
+		std::ifstream f(argv[1], std::ios::binary);
+		const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+		const auto j               = nlohmann::json::parse(text);
+		const auto packages_json   = j.get<std::vector<ts::v1::package>>();
+		for (const auto& package : packages_json)
+		{
+			packages.push_back(std::make_unique<ts::v1::package>(package));
+		}
+	}
+	else
+	{
+		std::fprintf(stderr, "unknown mode %s\n", mode.c_str());
+		return 1;
+	}
+
+	std::printf("%zu packages (%s)\n", packages.size(), mode.c_str());
+	imm::bench::report("load", watch.elapsed_ms());
+	imm::bench::report_peak_rss();
+	return 0;
+}
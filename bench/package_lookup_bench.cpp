@@ -0,0 +1,86 @@
+#include "bench.hpp"
+#include "thunderstore/v1/package_lookup.hpp"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Matching installed manifests to catalog packages on a synthetic catalog:
+//   bench_package_lookup [package count, 10000 by default] [installed count, 500 by default]
+// "lookup" goes through ts::v1::package_lookup, "linear scan" walks every package and version like startup used to.
+int main(int argc, char** argv)
+{
+	const size_t package_count   = argc > 1 ? std::stoul(argv[1]) : 10'000;
+	const size_t installed_count = argc > 2 ? std::stoul(argv[2]) : 500;
+
+	std::mt19937 rng(1234);
+	std::vector<std::unique_ptr<ts::v1::package>> packages;
+	for (size_t i = 0; i < package_count; i++)
+	{
+		auto& pkg     = *packages.emplace_back(std::make_unique<ts::v1::package>());
+		pkg.name      = "Mod" + std::to_string(i);
+		pkg.owner     = "Owner" + std::to_string(i % 700);
+		pkg.full_name = pkg.owner.str() + "-" + pkg.name;
+		for (size_t v = 0, n = 1 + rng() % 6; v < n; v++)
+		{
+			auto& pkg_version          = pkg.versions.emplace_back();
+			pkg_version.version_number = "1." + std::to_string(n - v - 1) + ".0";
+			pkg_version.full_name      = pkg.full_name + "-" + pkg_version.version_number;
+		}
+	}
+
+	struct installed_manifest
+	{
+		std::string full_name;
+		std::string version_number;
+	};
+	std::vector<installed_manifest> installed;
+	for (size_t i = 0; i < installed_count; i++)
+	{
+		const auto& pkg = *packages[rng() % packages.size()];
+		installed.push_back({.full_name = pkg.full_name, .version_number = pkg.versions[rng() % pkg.versions.size()].version_number});
+	}
+
+	ts::v1::package_lookup lookup;
+	const imm::bench::stopwatch build_watch;
+	for (const auto& pkg : packages)
+	{
+		lookup.add(pkg.get());
+	}
+	imm::bench::report("build lookup", build_watch.elapsed_ms());
+
+	size_t found = 0;
+	const imm::bench::stopwatch lookup_watch;
+	for (const auto& manifest : installed)
+	{
+		found += lookup.find_version(manifest.full_name, manifest.version_number).has_value();
+	}
+	imm::bench::report("match installed (lookup)", lookup_watch.elapsed_ms());
+
+	size_t scanned_found = 0;
+	const imm::bench::stopwatch scan_watch;
+	for (const auto& manifest : installed)
+	{
+		for (const auto& pkg : packages)
+		{
+			if (pkg->full_name != manifest.full_name)
+			{
+				continue;
+			}
+
+			for (const auto& pkg_version : pkg->versions)
+			{
+				if (pkg_version.version_number == manifest.version_number)
+				{
+					scanned_found++;
+					break;
+				}
+			}
+		}
+	}
+	imm::bench::report("match installed (linear scan)", scan_watch.elapsed_ms());
+
+	std::printf("%zu of %zu installed matched, %zu by the scan\n", found, installed.size(), scanned_found);
+	return found == scanned_found ? 0 : 1;
+}
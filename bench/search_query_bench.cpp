@@ -0,0 +1,73 @@
+#include "bench.hpp"
+#include "search/search_index.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Query latency of the Available Mods search on a synthetic catalog:
+//   bench_search_query [package count, 10000 by default]
+// Names, owners and descriptions are drawn from fixed word lists with a fixed seed, so runs are comparable.
+int main(int argc, char** argv)
+{
+	const size_t package_count = argc > 1 ? std::stoul(argv[1]) : 10'000;
+
+	static const char* words[] = {"better", "more",  "bosses",   "items",  "artifact", "drones",  "survivor", "lunar",
+	                              "void",   "skill", "loadout",  "chef",   "huntress", "engi",    "mul",      "sniper",
+	                              "stage",  "music", "language", "config", "api",      "library", "fix",      "quality",
+	                              "ui",     "hud",   "damage",   "elite",  "portal",   "shrine",  "teleport", "risk"};
+	static const char* categories[] = {"Mods", "Tools", "Libraries", "Items", "Survivors", "Skins", "Client-side", "Server-side", "Modpacks", "Tweaks"};
+	constexpr size_t word_count     = std::size(words);
+	constexpr size_t category_count = std::size(categories);
+
+	std::mt19937 rng(1234);
+	const auto pick = [&](size_t n)
+	{
+		return (size_t)(rng() % n);
+	};
+
+	imm::search::search_index index;
+	const imm::bench::stopwatch build_watch;
+	for (size_t i = 0; i < package_count; i++)
+	{
+		std::string name = words[pick(word_count)];
+		name[0]          = (char)(name[0] - 'a' + 'A');
+		name            += words[pick(word_count)];
+		name            += std::to_string(i);
+
+		std::string description;
+		for (size_t w = 0, n = 6 + pick(10); w < n; w++)
+		{
+			description += words[pick(word_count)];
+			description += ' ';
+		}
+
+		std::vector<imm::string::interned> package_categories;
+		for (size_t c = 0, n = 1 + pick(3); c < n; c++)
+		{
+			package_categories.emplace_back(categories[pick(category_count)]);
+		}
+
+		index.add(name, std::string("Owner") + std::to_string(pick(1500)), package_categories, description);
+	}
+	imm::bench::report("build index", build_watch.elapsed_ms());
+
+	// One or two characters scan every document, 3+ go through trigrams, typos fall through to the fuzzy pass.
+	static const char* queries[] = {"b", "mu", "bos", "better", "betterbosses", "owner12", "items drones", "huntress skill", "tweaks", "bettr", "hntrss", "zzzzqx"};
+	constexpr int runs           = 50;
+	for (const char* query : queries)
+	{
+		size_t matches = 0;
+		const imm::bench::stopwatch watch;
+		for (int r = 0; r < runs; r++)
+		{
+			matches = index.query(query).size();
+		}
+
+		const auto name = std::string("query \"") + query + "\" (" + std::to_string(matches) + " hits)";
+		imm::bench::report(name.c_str(), watch.elapsed_ms() / runs);
+	}
+
+	imm::bench::report_peak_rss();
+	return 0;
+}
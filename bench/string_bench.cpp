@@ -0,0 +1,171 @@
+#include "bench.hpp"
+
+// string.hpp also carries the ImGui::InputText helpers.
+#include <imgui.h>
+#include <string/string.hpp>
+
+#include <locale>
+#include <random>
+#include <sstream>
+
+// imm::string against the stringstream / std::locale code it replaced:
+//   bench_string [iterations, 200 by default]
+// Inputs are 10k catalog like names, ASCII only and with some Latin-1 / Cyrillic mixed in.
+namespace
+{
+	// Results are stored here so nothing gets optimized out.
+	volatile size_t sink = 0;
+
+	std::string locale_to_lower(const std::string& input)
+	{
+		std::string result = input;
+		std::locale loc;
+		for (auto& c : result)
+		{
+			c = std::tolower(c, loc);
+		}
+		return result;
+	}
+
+	std::vector<std::string> stringstream_split(const std::string& text, char delim)
+	{
+		std::vector<std::string> result;
+		std::stringstream ss(text);
+		std::string field;
+		while (std::getline(ss, field, delim))
+		{
+			result.push_back(field);
+		}
+		return result;
+	}
+
+	int stringstream_int(const std::string& text)
+	{
+		int value = 0;
+		std::stringstream(text) >> value;
+		return value;
+	}
+
+	template<typename F>
+	void run(const char* name, int iterations, F&& f)
+	{
+		const imm::bench::stopwatch watch;
+		for (int i = 0; i < iterations; i++)
+		{
+			sink = f();
+		}
+		imm::bench::report(name, watch.elapsed_ms() / iterations);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const int iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+
+	static const char* ascii_words[] = {"Better", "Bosses", "Items", "Artifact", "Drones", "Survivor", "Lunar", "Void", "API", "Library"};
+	static const char* utf8_words[]  = {"Édition", "Spéciale", "Ÿöür", "Ящик", "Ёлка", "Über"};
+
+	std::mt19937 rng(1234);
+	std::vector<std::string> ascii_names;
+	std::vector<std::string> mixed_names;
+	std::vector<std::string> versions;
+	for (int i = 0; i < 10'000; i++)
+	{
+		auto name = std::string("Owner") + std::to_string(i % 700) + "-" + ascii_words[rng() % std::size(ascii_words)] + ascii_words[rng() % std::size(ascii_words)];
+		ascii_names.push_back(name);
+		mixed_names.push_back(name + utf8_words[rng() % std::size(utf8_words)]);
+		versions.push_back(std::to_string(rng() % 10) + "." + std::to_string(rng() % 30) + "." + std::to_string(rng() % 100));
+	}
+
+	run("to_lower ascii", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : ascii_names)
+		    {
+			    n += imm::string::to_lower(name).size();
+		    }
+		    return n;
+	    });
+	run("to_lower ascii (std::locale)", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : ascii_names)
+		    {
+			    n += locale_to_lower(name).size();
+		    }
+		    return n;
+	    });
+	run("to_lower utf-8", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : mixed_names)
+		    {
+			    n += imm::string::to_lower(name).size();
+		    }
+		    return n;
+	    });
+	run("to_lower utf-8 (std::locale)", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : mixed_names)
+		    {
+			    n += locale_to_lower(name).size();
+		    }
+		    return n;
+	    });
+	run("split_view", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : ascii_names)
+		    {
+			    for (const auto field : imm::string::split_view(name, '-'))
+			    {
+				    n += field.size();
+			    }
+		    }
+		    return n;
+	    });
+	run("split (stringstream)", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& name : ascii_names)
+		    {
+			    n += stringstream_split(name, '-').size();
+		    }
+		    return n;
+	    });
+	run("split<int> versions", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& version : versions)
+		    {
+			    for (const auto part : imm::string::split<int>(version, '.'))
+			    {
+				    n += part;
+			    }
+		    }
+		    return n;
+	    });
+	run("split<int> versions (stringstream)", iterations,
+	    [&]
+	    {
+		    size_t n = 0;
+		    for (const auto& version : versions)
+		    {
+			    for (const auto& part : stringstream_split(version, '.'))
+			    {
+				    n += stringstream_int(part);
+			    }
+		    }
+		    return n;
+	    });
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include "bench.hpp"
+#include "logger.hpp"
+#include "thunderstore/v1/package_reader.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Memory held by the strings interning replaced, from a recorded /api/v1/package/ response:
+//   bench_string_interning <index.json>
+// "before" is what owners, categories and dependencies cost as one std::string each, plus the full_name_lower copy
+// every package and version had. "after" is the handles plus the pool behind them. Heap sizes assume the 15 character
+// small string buffer of MSVC and libstdc++, allocator overhead is left out of both.
+namespace
+{
+	size_t string_bytes(const std::string& str)
+	{
+		return sizeof(std::string) + (str.size() > 15 ? str.size() + 1 : 0);
+	}
+
+	void report_bytes(const char* name, size_t bytes)
+	{
+		std::printf("%-40s %10.1f MiB\n", name, bytes / (1024.0 * 1024.0));
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <index.json>\n", argv[0]);
+		return 1;
+	}
+
+	logger = spdlog::default_logger();
+
+	size_t package_count = 0;
+	size_t version_count = 0;
+	size_t handle_count  = 0;
+	size_t before_bytes  = 0;
+
+	const imm::bench::stopwatch watch;
+	std::ifstream f(argv[1], std::ios::binary);
+	const auto ok = ts::v1::read_package_index(f,
+	                                           [&](ts::v1::package&& package)
+	                                           {
+		                                           package_count++;
+		                                           handle_count += 1 + package.categories.size();
+		                                           before_bytes += string_bytes(package.owner) + string_bytes(package.full_name);
+		                                           for (const auto& category : package.categories)
+		                                           {
+			                                           before_bytes += string_bytes(category);
+		                                           }
+
+		                                           for (const auto& version : package.versions)
+		                                           {
+			                                           version_count++;
+			                                           handle_count += version.dependencies.size();
+			                                           before_bytes += string_bytes(version.full_name);
+			                                           for (const auto& dependency : version.dependencies)
+			                                           {
+				                                           before_bytes += string_bytes(dependency);
+			                                           }
+		                                           }
+	                                           });
+	if (!ok)
+	{
+		std::fprintf(stderr, "%s is not a package index\n", argv[1]);
+		return 1;
+	}
+	imm::bench::report("load", watch.elapsed_ms());
+
+	// Each entry is two strings in a deque, looked up through an unordered_map node of a string_view and a pointer.
+	const auto& pool         = imm::string::intern_pool::global();
+	constexpr size_t node    = sizeof(std::string_view) + 3 * sizeof(void*);
+	const size_t pool_bytes  = pool.count() * (2 * sizeof(std::string) + node) + pool.bytes();
+	const size_t after_bytes = handle_count * sizeof(imm::string::interned) + pool_bytes;
+
+	std::printf("%zu packages, %zu versions, %zu handles, %zu pooled strings\n", package_count, version_count, handle_count, pool.count());
+	report_bytes("before: one std::string each", before_bytes);
+	report_bytes("after: handles + pool", after_bytes);
+	report_bytes("  of which pool", pool_bytes);
+	imm::bench::report_peak_rss();
+	return 0;
+}
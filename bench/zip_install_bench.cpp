@@ -0,0 +1,156 @@
+#include "bench.hpp"
+#include "install/zip_install.hpp"
+#include "logger.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+#include <zip/zip.h>
+
+// Installing a package zip into its plugin folders, on synthetic zips written to a scratch folder:
+//   bench_zip_install [scratch folder, under the temp folder by default]
+// "extract + copy" is the old path: zip_extract to a folder next to the zip, then copy the tree into the plugin folders.
+// "single pass" is imm::install::extract_zip routing every entry straight to its destination.
+namespace
+{
+	struct synthetic_zip
+	{
+		const char* name;
+		size_t file_count;
+		size_t file_size;
+	};
+
+	// Text like bytes, so the zip deflates about as well as real mods do.
+	std::string make_content(std::mt19937& rng, size_t size)
+	{
+		static const char* words[] = {"local ", "function ", "return ", "end\n", "self.", "damage ", "= ", "0.5 ", "if ", "then\n", "item_", "-- "};
+
+		std::string content;
+		content.reserve(size + 16);
+		while (content.size() < size)
+		{
+			content += words[rng() % std::size(words)];
+		}
+		content.resize(size);
+		return content;
+	}
+
+	bool write_zip(const std::filesystem::path& zip_path, const synthetic_zip& spec)
+	{
+		std::mt19937 rng(1234);
+		auto zip = zip_open((const char*)zip_path.u8string().c_str(), 6, 'w');
+		if (!zip)
+		{
+			return false;
+		}
+
+		// A tenth of the files in config and plugins_data, the rest spread over a few plugin folders.
+		for (size_t i = 0; i < spec.file_count; i++)
+		{
+			std::string name;
+			if (i % 10 == 0)
+			{
+				name = "config/file" + std::to_string(i) + ".cfg";
+			}
+			else if (i % 10 == 1)
+			{
+				name = "plugins_data/file" + std::to_string(i) + ".bin";
+			}
+			else
+			{
+				name = "folder" + std::to_string(i % 8) + "/file" + std::to_string(i) + ".lua";
+			}
+
+			const auto content = make_content(rng, spec.file_size);
+			zip_entry_open(zip, name.c_str());
+			zip_entry_write(zip, content.data(), content.size());
+			zip_entry_close(zip);
+		}
+
+		zip_close(zip);
+		return true;
+	}
+
+	imm::install::plugin_folders make_folders(const std::filesystem::path& root)
+	{
+		return {.plugins = root / "plugins" / "Owner-Mod", .plugins_data = root / "plugins_data" / "Owner-Mod", .config = root / "config" / "Owner-Mod"};
+	}
+
+	// What handle_zip did before the single pass install.
+	bool extract_and_copy(const std::filesystem::path& zip_path, const imm::install::plugin_folders& folders)
+	{
+		const auto extracted_folder = zip_path.parent_path() / zip_path.stem();
+		if (zip_extract((const char*)zip_path.u8string().c_str(), (const char*)extracted_folder.u8string().c_str(), nullptr, nullptr) != 0)
+		{
+			return false;
+		}
+
+		constexpr auto options = std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing;
+		for (const auto& entry : std::filesystem::directory_iterator(extracted_folder))
+		{
+			const auto filename = entry.path().filename();
+			const auto& folder  = filename == "plugins_data" ? folders.plugins_data : filename == "config" ? folders.config : folders.plugins;
+			std::filesystem::create_directories(folder);
+			std::filesystem::copy(entry.path(), folder / filename, options);
+		}
+		return true;
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	logger = spdlog::default_logger();
+
+	const auto scratch = argc > 1 ? std::filesystem::path(argv[1]) : std::filesystem::temp_directory_path() / "imm_bench_zip_install";
+	std::filesystem::remove_all(scratch);
+	std::filesystem::create_directories(scratch);
+
+	static const synthetic_zip zips[] = {
+	    {.name = "many_small", .file_count = 4000, .file_size = 4 * 1024},
+	    {.name = "few_large", .file_count = 6, .file_size = 32 * 1024 * 1024},
+	};
+
+	for (const auto& spec : zips)
+	{
+		const auto zip_path = scratch / (std::string(spec.name) + ".zip");
+		if (!write_zip(zip_path, spec))
+		{
+			std::fprintf(stderr, "can't write %s\n", zip_path.string().c_str());
+			return 1;
+		}
+
+		std::printf("%s: %zu files of %zu KiB, %.1f MiB zipped\n", spec.name, spec.file_count, spec.file_size / 1024, std::filesystem::file_size(zip_path) / (1024.0 * 1024.0));
+
+		{
+			const auto folders = make_folders(scratch / "old");
+			const imm::bench::stopwatch watch;
+			if (!extract_and_copy(zip_path, folders))
+			{
+				return 1;
+			}
+			imm::bench::report("  extract + copy", watch.elapsed_ms());
+		}
+
+		{
+			const auto folders = make_folders(scratch / "new");
+			const imm::bench::stopwatch watch;
+			const auto ok = imm::install::extract_zip(zip_path,
+			                                          [&](std::string_view entry_name)
+			                                          {
+				                                          return imm::install::route_plugin_zip_entry(entry_name, folders);
+			                                          });
+			if (!ok)
+			{
+				return 1;
+			}
+			imm::bench::report("  single pass", watch.elapsed_ms());
+		}
+
+		std::filesystem::remove_all(scratch / "old");
+		std::filesystem::remove_all(scratch / "new");
+		std::filesystem::remove_all(scratch / spec.name);
+	}
+
+	std::filesystem::remove_all(scratch);
+	return 0;
+}
@@ -1,29 +1,46 @@
 #include "gui.hpp"
 
+#include "icons/icon_cache.hpp"
+#include "install/dependency_resolver.hpp"
+#include "install/linked_install.hpp"
+#include "install/manifest_index.hpp"
+#include "install/plan_runner.hpp"
+#include "install/transaction.hpp"
+#include "install/zip_install.hpp"
+#include "gui/virtual_list.hpp"
 #include "logger.hpp"
+#include "net/download_pool.hpp"
+#include "platform/directory_watcher.hpp"
+#include "search/fuzzy_match.hpp"
+#include "search/search_index.hpp"
+#include "store/extracted_store.hpp"
+#include "store/zip_store.hpp"
 
 #include <codecvt>
-#include <cpr/cpr.h>
 #include <d3d11.h>
 #include <fcntl.h>
+#include <future>
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <imgui_toggle/imgui_toggle.h>
 #include <io.h>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <queue>
 #include <semver.hpp>
 #include <shellapi.h>
 #include <string/string.hpp>
+#include <thunderstore/v1/catalog_cache.hpp>
 #include <thunderstore/v1/manifest.hpp>
 #include <thunderstore/v1/package.hpp>
+#include <thunderstore/v1/package_lookup.hpp>
 #include <tlhelp32.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
-#include <zip/zip.h>
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 
 static std::filesystem::path _root_cache_folder = "";
 
@@ -75,6 +92,10 @@ struct profile
 
 static std::filesystem::path app_cache_path;
 
+// Guards package_enabled_states of every profile, the rescans, the install matching and the UI all touch them.
+// Nothing else is locked while it is held.
+static std::mutex package_enabled_states_mutex;
+
 struct app_cache
 {
 	std::string game_folder_path_utf8{};
@@ -93,8 +114,13 @@ struct app_cache
 
 	void save()
 	{
+		nlohmann::json j;
+		{
+			std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+			j = *this;
+		}
+
 		std::ofstream app_cache_file_stream(app_cache_path);
-		nlohmann::json j = *this;
 		app_cache_file_stream << j << std::endl;
 	}
 };
@@ -179,55 +205,6 @@ void gui::render_main_menu_bar()
 	// }
 }
 
-// Simple helper function to load an image into a DX11 texture with common settings
-bool LoadTextureFromFile(FILE* f, ID3D11ShaderResourceView** out_srv, int* out_width, int* out_height)
-{
-	// Load from disk into a raw RGBA buffer
-	int image_width           = 0;
-	int image_height          = 0;
-	unsigned char* image_data = stbi_load_from_file(f, &image_width, &image_height, NULL, 4);
-	if (image_data == NULL)
-	{
-		return false;
-	}
-
-	// Create texture
-	D3D11_TEXTURE2D_DESC desc;
-	ZeroMemory(&desc, sizeof(desc));
-	desc.Width            = image_width;
-	desc.Height           = image_height;
-	desc.MipLevels        = 1;
-	desc.ArraySize        = 1;
-	desc.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
-	desc.SampleDesc.Count = 1;
-	desc.Usage            = D3D11_USAGE_DEFAULT;
-	desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
-	desc.CPUAccessFlags   = 0;
-
-	ID3D11Texture2D* pTexture = NULL;
-	D3D11_SUBRESOURCE_DATA subResource;
-	subResource.pSysMem          = image_data;
-	subResource.SysMemPitch      = desc.Width * 4;
-	subResource.SysMemSlicePitch = 0;
-	g_pd3dDevice->CreateTexture2D(&desc, &subResource, &pTexture);
-
-	// Create texture view
-	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
-	ZeroMemory(&srvDesc, sizeof(srvDesc));
-	srvDesc.Format                    = DXGI_FORMAT_R8G8B8A8_UNORM;
-	srvDesc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels       = desc.MipLevels;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	g_pd3dDevice->CreateShaderResourceView(pTexture, &srvDesc, out_srv);
-	pTexture->Release();
-
-	*out_width  = image_width;
-	*out_height = image_height;
-	stbi_image_free(image_data);
-
-	return true;
-}
-
 static auto available_packages_ready = false;
 static std::mutex packages_mutex;
 static std::vector<std::unique_ptr<ts::v1::package>> packages;
@@ -241,202 +218,578 @@ struct installed_package
 	bool is_enabled = true;
 	bool is_local   = false;
 	std::filesystem::path folder;
+	// Version full name, its folded form is what the search matches against.
+	imm::string::interned full_name;
 };
 
+// When both are needed, packages_mutex is taken first.
+// Packages are only freed once no entry of installed_packages points to them, so pkg stays valid while installed_packages_mutex is held,
+// though its mutable fields (is_installed, installed_version_number, has_icon_file, ...) still need packages_mutex.
 static std::mutex installed_packages_mutex;
 static std::vector<installed_package> installed_packages;
-static std::vector<ts::v1::package> packages_json;
 static std::mutex t_queue_mutex;
 static std::queue<std::function<void()>> t_queue;
 
-static void init_available_packages()
+// Doc ids of the search index are indices in package_search_documents, both guarded by packages_mutex.
+static imm::search::search_index package_search_index;
+static std::vector<ts::v1::package*> package_search_documents;
+
+// Every change to packages goes through index_available_package, merge_available_package or rebuild_available_packages_index,
+// both bump this so views over packages know they are stale. Guarded by packages_mutex.
+static uint64_t packages_generation = 0;
+
+// Guarded by packages_mutex.
+static ts::v1::package_lookup package_lookup;
+
+// One bit per category name, in order of first appearance. Guarded by packages_mutex.
+static std::unordered_map<std::string, uint64_t> category_masks;
+
+// 0 for unknown categories and past the 64th one, which only makes the category filter miss them.
+static uint64_t get_category_mask(const std::string& category)
 {
-	packages.clear();
-	for (auto& package : packages_json)
+	const auto it = category_masks.find(category);
+	if (it != category_masks.end())
 	{
-		package.full_name_lower = imm::string::to_lower(package.full_name);
-		if (package.full_name_lower.contains("immediatemodman"))
-		{
-			continue;
-		}
-		for (auto& pkg_version : package.versions)
-		{
-			pkg_version.full_name_lower = imm::string::to_lower(pkg_version.full_name);
-		}
-		packages.push_back(std::make_unique<ts::v1::package>(package));
+		return it->second;
 	}
+
+	const auto mask = category_masks.size() < 64 ? 1ull << category_masks.size() : 0;
+	category_masks.emplace(category, mask);
+	return mask;
 }
 
-static void on_game_folder_found()
+// Caller must hold packages_mutex.
+static void update_category_mask(ts::v1::package* package)
 {
-	if (installed_packages.size())
+	package->category_mask = 0;
+	for (const auto& category : package->categories)
 	{
-		std::unique_lock installed_packages_lock(installed_packages_mutex);
-		installed_packages.clear();
-		std::unordered_map<std::string, ID3D11ShaderResourceView*> full_name_to_tex;
-		std::unique_lock packages_lock(packages_mutex);
-		for (const auto& pkg : packages)
-		{
-			for (const auto& pkg_version : pkg->versions)
-			{
-				full_name_to_tex[pkg_version.full_name] = pkg_version.icon_texture;
-			}
-		}
-		init_available_packages();
-		for (const auto& pkg : packages)
-		{
-			for (auto& pkg_version : pkg->versions)
-			{
-				pkg_version.icon_texture = full_name_to_tex[pkg_version.full_name];
-			}
-		}
+		package->category_mask |= get_category_mask(category);
 	}
+}
 
-	if (!s_app_cache.active_profile)
+// Searched along with the name, owner and categories.
+static std::string_view get_search_description(const ts::v1::package* package)
+{
+	return package->versions.size() ? std::string_view(package->versions[0].description) : std::string_view();
+}
+
+// Caller must hold packages_mutex.
+static void index_available_package(ts::v1::package* package)
+{
+	update_category_mask(package);
+
+	package->search_document = package_search_index.add(package->full_name, package->owner, package->categories, get_search_description(package));
+	package_search_documents.push_back(package);
+
+	package_lookup.add(package);
+
+	packages_generation++;
+}
+
+// Caller must hold packages_mutex.
+static void rebuild_available_packages_index()
+{
+	package_search_index.clear();
+	package_search_documents.clear();
+	package_lookup.clear();
+	for (const auto& package : packages)
 	{
-		if (!s_app_cache.profiles.size())
-		{
-			s_app_cache.profiles.push_back(std::make_shared<profile>());
-		}
+		index_available_package(package.get());
+	}
+	packages_generation++;
+}
 
-		for (const auto& prof : s_app_cache.profiles)
-		{
-			if (prof->name == s_app_cache.active_profile_name)
-			{
-				s_app_cache.active_profile = prof.get();
-				break;
-			}
-		}
+enum class available_packages_sort
+{
+	catalog,
+	name_ascending,
+	name_descending,
+	last_updated,
+};
+
+static void sort_available_packages(std::vector<ts::v1::package*>& view, available_packages_sort sort_order)
+{
+	switch (sort_order)
+	{
+	case available_packages_sort::catalog: break;
+	case available_packages_sort::name_ascending:
+		std::sort(view.begin(),
+		          view.end(),
+		          [](const ts::v1::package* a, const ts::v1::package* b)
+		          {
+			          return a->full_name < b->full_name;
+		          });
+		break;
+	case available_packages_sort::name_descending:
+		std::sort(view.begin(),
+		          view.end(),
+		          [](const ts::v1::package* a, const ts::v1::package* b)
+		          {
+			          return a->full_name > b->full_name;
+		          });
+		break;
+	case available_packages_sort::last_updated:
+		std::sort(view.begin(),
+		          view.end(),
+		          [](const ts::v1::package* a, const ts::v1::package* b)
+		          {
+			          return a->date_updated > b->date_updated;
+		          });
+		break;
 	}
+}
 
-	const auto rom_folder = std::filesystem::path(s_app_cache.game_folder_path) / "ReturnOfModding";
+// Everything the Available Mods view depends on.
+struct available_packages_view_state
+{
+	uint64_t packages_generation = 0;
+	uint64_t search_generation   = 0;
+	std::string search_text;
+	available_packages_sort sort_order = available_packages_sort::catalog;
+	bool show_modpacks                 = false;
+	bool show_only_modpacks            = false;
+	bool show_deprecated               = false;
+
+	bool operator==(const available_packages_view_state&) const = default;
+};
 
-	const auto config_folder = rom_folder / "config";
-	if (!std::filesystem::exists(config_folder))
+static bool add_available_package(ts::v1::package&& package)
+{
+	if (imm::string::to_lower(package.full_name).contains("immediatemodman"))
 	{
-		std::filesystem::create_directories(config_folder);
+		return false;
 	}
 
-	const auto plugins_data_folder = rom_folder / "plugins_data";
-	if (!std::filesystem::exists(plugins_data_folder))
+	std::unique_lock packages_lock(packages_mutex);
+	packages.push_back(std::make_unique<ts::v1::package>(std::move(package)));
+	index_available_package(packages.back().get());
+	return true;
+}
+
+// Warm start: only what the app reads is copied out of the snapshot, urls, dates, uuids and download counts stay on disk.
+static bool add_available_package(const ts::v1::package_view& view)
+{
+	ts::v1::package package{};
+	package.name             = view.name();
+	package.full_name        = view.full_name();
+	package.owner            = view.owner();
+	package.date_updated     = view.date_updated();
+	package.rating_score     = view.rating_score();
+	package.is_pinned        = view.is_pinned();
+	package.is_deprecated    = view.is_deprecated();
+	package.has_nsfw_content = view.has_nsfw_content();
+	if (const auto link = view.donation_link())
 	{
-		std::filesystem::create_directories(plugins_data_folder);
+		package.donation_link = std::string(*link);
 	}
 
-	const auto plugins_folder = rom_folder / "plugins";
-	if (!std::filesystem::exists(plugins_folder))
+	package.categories.reserve(view.category_count());
+	for (size_t i = 0; i < view.category_count(); i++)
 	{
-		std::filesystem::create_directories(plugins_folder);
+		package.categories.emplace_back(view.category(i));
 	}
-	for (const auto& entry : std::filesystem::recursive_directory_iterator(plugins_folder, std::filesystem::directory_options::skip_permission_denied))
+
+	package.versions.resize(view.version_count());
+	for (size_t i = 0; i < view.version_count(); i++)
 	{
-		if (entry.is_directory())
+		const auto version_view    = view.version(i);
+		auto& pkg_version          = package.versions[i];
+		pkg_version.name           = version_view.name();
+		pkg_version.full_name      = version_view.full_name();
+		pkg_version.description    = version_view.description();
+		pkg_version.icon           = version_view.icon();
+		pkg_version.version_number = version_view.version_number();
+		pkg_version.download_url   = version_view.download_url();
+
+		pkg_version.dependencies.reserve(version_view.dependency_count());
+		for (size_t j = 0; j < version_view.dependency_count(); j++)
 		{
-			continue;
+			pkg_version.dependencies.emplace_back(version_view.dependency(j));
 		}
+	}
+
+	return add_available_package(std::move(package));
+}
 
-		if (entry.path().filename() != "manifest.json" && entry.path().filename() != "manifest_disabled.json")
+// packages is appended to by the loader thread, anything outside of packages_mutex reads its size through this.
+static size_t get_available_packages_count()
+{
+	std::unique_lock packages_lock(packages_mutex);
+	return packages.size();
+}
+
+// Drops local packages and installed state so that installed mods can be matched again.
+// Caller must hold packages_mutex.
+static void reset_available_packages()
+{
+	std::erase_if(packages,
+	              [](const std::unique_ptr<ts::v1::package>& pkg)
+	              {
+		              return pkg->is_local;
+	              });
+
+	for (auto& pkg : packages)
+	{
+		pkg->is_installed = false;
+		pkg->installed_version_number.clear();
+	}
+
+	rebuild_available_packages_index();
+}
+
+static imm::install::manifest_index& get_manifest_index()
+{
+	static imm::install::manifest_index index(get_root_cache_folder() / "installed_manifests.json");
+	return index;
+}
+
+static std::filesystem::path get_install_journal_folder()
+{
+	return get_root_cache_folder() / "install_journal";
+}
+
+static imm::store::extracted_store& get_extracted_store()
+{
+	static imm::store::extracted_store store(get_root_cache_folder() / "extracted");
+	return store;
+}
+
+// Manifests don't name their author, the package folder ("Author-Name") does.
+static ts::v1::manifest read_installed_manifest(const imm::install::scanned_manifest& scanned)
+{
+	auto m = scanned.manifest;
+
+	m.author_name = (char*)scanned.path.parent_path().filename().u8string().c_str();
+	if (m.author_name.contains('-'))
+	{
+		m.author_name = imm::string::split(m.author_name, '-')[0];
+	}
+
+	return m;
+}
+
+static std::vector<imm::install::scanned_manifest> scan_installed_manifests(const std::filesystem::path& plugins_folder)
+{
+	// Only the directories that changed since the last scan are listed, only the manifests that changed are parsed.
+	auto manifests = get_manifest_index().scan(plugins_folder,
+	                                           [](const std::filesystem::path& directory)
+	                                           {
+		                                           // Half of an install or uninstall in flight.
+		                                           return imm::install::is_transaction_path(directory);
+	                                           });
+	const auto scan_stats = get_manifest_index().last_stats();
+	SPDLOG_LOGGER_INFO(logger,
+	                   "found {} manifests, {} directories listed, {} unchanged, {} manifests parsed",
+	                   manifests.size(),
+	                   scan_stats.listed_directories,
+	                   scan_stats.reused_directories,
+	                   scan_stats.parsed_manifests);
+	return manifests;
+}
+
+// Every rescan of the plugins folder, from the watcher, an uninstall, an install or on_game_folder_found, runs under it,
+// so two of them never drop and queue the same folders at once.
+static std::mutex installed_packages_refresh_mutex;
+
+// Queues matching the package of an installed manifest against the available ones, making a local package if none matches.
+static void queue_installed_manifest(const imm::install::scanned_manifest& scanned)
+{
+	const auto m          = read_installed_manifest(scanned);
+	const auto pkg_folder = scanned.path.parent_path();
+
+	const auto full_name_package = m.author_name + '-' + m.name;
+
+	bool is_enabled        = true;
+	bool has_enabled_entry = false;
+	std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+	for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
+	{
+		if (enabled_state.full_name == full_name_package)
 		{
-			continue;
+			is_enabled = enabled_state.is_enabled;
+
+			if (is_enabled && scanned.path.filename() == "manifest_disabled.json")
+			{
+				// inconsistency between profile state and manifest filename
+				// the filename has priority
+
+				is_enabled               = false;
+				enabled_state.is_enabled = false;
+			}
+
+			has_enabled_entry = true;
+			break;
 		}
+	}
+	enabled_states_lock.unlock();
+
+	std::unique_lock t_queue_lock(t_queue_mutex);
+	t_queue.push(
+	    [full_name_package, m, pkg_folder, is_enabled, has_enabled_entry]
+	    {
+		    auto find_installed_pkg_from_available_packages = [&](bool is_local)
+		    {
+			    std::unique_lock packages_lock(packages_mutex);
+			    const auto found = package_lookup.find_version(full_name_package, m.version_number);
+			    if (!found)
+			    {
+				    return false;
+			    }
+
+			    auto package        = found->pkg;
+			    const auto& pkg_ver = package->versions[found->version_index];
+			    {
+				    std::unique_lock installed_packages_lock(installed_packages_mutex);
+				    // A rescan can queue a folder again before its first match ran.
+				    std::erase_if(installed_packages,
+				                  [&](const installed_package& installed)
+				                  {
+					                  return installed.folder == pkg_folder;
+				                  });
+				    installed_packages.push_back({.pkg = package, .pkg_version_index = found->version_index, .is_enabled = is_enabled, .is_local = is_local, .folder = pkg_folder, .full_name = pkg_ver.full_name});
+			    }
+
+			    if (!has_enabled_entry)
+			    {
+				    std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+				    s_app_cache.active_profile->package_enabled_states.push_back({.is_enabled = is_enabled, .full_name = full_name_package, .version = m.version_number});
+			    }
 
-		std::ifstream f(entry.path());
-		ts::v1::manifest m = nlohmann::json::parse(f, nullptr, false, true);
+			    package->is_installed             = true;
+			    package->installed_version_number = pkg_ver.version_number;
 
-		const auto pkg_folder = entry.path().parent_path();
+			    return true;
+		    };
 
-		m.author_name = (char*)pkg_folder.filename().u8string().c_str();
-		if (m.author_name.contains('-'))
+		    if (find_installed_pkg_from_available_packages(false))
+		    {
+			    return;
+		    }
+
+		    // Reaching here means it's just a local package
+
+		    auto local_pkg                      = std::make_unique<ts::v1::package>();
+		    local_pkg->name                     = m.name;
+		    local_pkg->full_name                = full_name_package;
+		    local_pkg->owner                    = m.author_name;
+		    local_pkg->is_local                 = true;
+		    local_pkg->is_installed             = true;
+		    local_pkg->installed_version_number = m.version_number;
+
+		    auto full_name_version = full_name_package + '-' + m.version_number;
+		    local_pkg->versions.push_back({.name = m.name, .full_name = full_name_version, .description = m.description, .version_number = m.version_number, .dependencies = {m.dependencies.begin(), m.dependencies.end()}, .is_installed = true});
+		    {
+			    std::unique_lock packages_lock(packages_mutex);
+			    packages.push_back(std::move(local_pkg));
+			    index_available_package(packages.back().get());
+		    }
+
+		    find_installed_pkg_from_available_packages(true);
+	    });
+}
+
+// Brings installed_packages in line with the plugins folder after a change on disk. Only the packages whose manifest
+// appeared, disappeared, changed version or got disabled are dropped and matched again, the others are left alone.
+static void refresh_installed_packages()
+{
+	std::unique_lock refresh_lock(installed_packages_refresh_mutex);
+
+	const auto plugins_folder = std::filesystem::path(s_app_cache.game_folder_path) / "ReturnOfModding" / "plugins";
+	const auto manifests      = scan_installed_manifests(plugins_folder);
+
+	std::map<std::filesystem::path, const imm::install::scanned_manifest*> changed_manifests;
+	for (const auto& scanned : manifests)
+	{
+		changed_manifests[scanned.path.parent_path()] = &scanned;
+	}
+
+	std::unordered_set<ts::v1::package*> dropped_packages;
+	{
+		std::unique_lock installed_packages_lock(installed_packages_mutex);
+		std::erase_if(installed_packages,
+		              [&](const installed_package& installed)
+		              {
+			              // ReturnOfModding itself, its version.dll isn't in the plugins folder.
+			              if (installed.folder == s_app_cache.game_folder_path)
+			              {
+				              return false;
+			              }
+
+			              const auto it = changed_manifests.find(installed.folder);
+			              if (it != changed_manifests.end())
+			              {
+				              const auto m             = read_installed_manifest(*it->second);
+				              const bool is_disabled   = it->second->path.filename() == "manifest_disabled.json";
+				              const bool is_up_to_date = installed.full_name.str() == m.author_name + '-' + m.name + '-' + m.version_number && !(is_disabled && installed.is_enabled);
+				              if (is_up_to_date)
+				              {
+					              changed_manifests.erase(it);
+					              return false;
+				              }
+			              }
+
+			              dropped_packages.insert(installed.pkg);
+			              return true;
+		              });
+
+		for (const auto& installed : installed_packages)
 		{
-			m.author_name = imm::string::split(m.author_name, '-')[0];
+			dropped_packages.erase(installed.pkg);
 		}
+	}
 
-		const auto full_name_package = m.author_name + '-' + m.name;
+	if (dropped_packages.size())
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		for (auto pkg : dropped_packages)
+		{
+			pkg->is_installed = false;
+			pkg->installed_version_number.clear();
+		}
 
-		bool is_enabled        = true;
-		bool has_enabled_entry = false;
-		for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
+		// Same as reset_available_packages, but only for the local packages that went away.
+		const auto local_count = packages.size();
+		std::erase_if(packages,
+		              [&](const std::unique_ptr<ts::v1::package>& pkg)
+		              {
+			              return pkg->is_local && dropped_packages.contains(pkg.get());
+		              });
+		if (packages.size() != local_count)
 		{
-			if (enabled_state.full_name == full_name_package)
-			{
-				is_enabled = enabled_state.is_enabled;
+			rebuild_available_packages_index();
+		}
+	}
 
-				if (is_enabled && entry.path().filename() == "manifest_disabled.json")
-				{
-					// inconsistency between profile state and manifest filename
-					// the filename has priority
+	for (const auto& [folder, scanned] : changed_manifests)
+	{
+		queue_installed_manifest(*scanned);
+	}
 
-					is_enabled               = false;
-					enabled_state.is_enabled = false;
-				}
+	SPDLOG_LOGGER_INFO(logger, "installed packages refreshed, {} dropped, {} queued", dropped_packages.size(), changed_manifests.size());
+}
 
-				has_enabled_entry = true;
-				break;
-			}
-		}
+static constexpr auto mod_folders_watch_debounce = std::chrono::milliseconds(500);
 
-		std::unique_lock t_queue_lock(t_queue_mutex);
-		t_queue.push(
-		    [full_name_package, m, pkg_folder, is_enabled, has_enabled_entry]
-		    {
-			    auto find_installed_pkg_from_available_packages = [&](bool is_local)
-			    {
-				    std::unique_lock packages_lock(packages_mutex);
-				    for (auto& package : packages)
-				    {
-					    if (package->full_name == full_name_package)
-					    {
-						    size_t i = 0;
-						    for (auto& pkg_ver : package->versions)
-						    {
-							    if (pkg_ver.version_number == m.version_number)
-							    {
-								    std::unique_lock installed_packages_lock(installed_packages_mutex);
-								    installed_packages.push_back({.pkg = package.get(), .pkg_version_index = i, .is_enabled = is_enabled, .is_local = is_local, .folder = pkg_folder});
+// Mods added or removed by hand or by other tools show up without a restart or a full rescan.
+// Those tools write config and plugins_data along with plugins, any of the three changing triggers the refresh.
+static void watch_mod_folders(const std::filesystem::path& rom_folder)
+{
+	static std::mutex watcher_mutex;
+	static std::unique_ptr<imm::platform::directory_watcher> watcher;
 
-								    if (!has_enabled_entry)
-								    {
-									    s_app_cache.active_profile->package_enabled_states.push_back({.is_enabled = is_enabled, .full_name = full_name_package, .version = m.version_number});
-								    }
+	std::vector<std::filesystem::path> roots{rom_folder / "plugins", rom_folder / "config", rom_folder / "plugins_data"};
 
-								    package->is_installed             = true;
-								    package->installed_version_number = pkg_ver.version_number;
+	std::unique_lock lock(watcher_mutex);
+	if (watcher && watcher->roots() == roots)
+	{
+		return;
+	}
 
-								    return true;
-							    }
+	watcher = std::make_unique<imm::platform::directory_watcher>(std::move(roots),
+	                                                             mod_folders_watch_debounce,
+	                                                             [](const std::vector<std::filesystem::path>&)
+	                                                             {
+		                                                             refresh_installed_packages();
+	                                                             });
+}
 
-							    i++;
-						    }
-					    }
-				    }
+static void on_game_folder_found()
+{
+	// Before anything looks at the plugin folders, an install interrupted last run is finished or undone here.
+	static std::once_flag recovered;
+	std::call_once(recovered,
+	               []
+	               {
+		               imm::install::recover(get_install_journal_folder());
+	               });
 
-				    return false;
-			    };
+	const auto rom_folder = std::filesystem::path(s_app_cache.game_folder_path) / "ReturnOfModding";
 
-			    if (find_installed_pkg_from_available_packages(false))
-			    {
-				    return;
-			    }
+	std::unordered_set<std::string> in_use_versions;
+	{
+		std::unique_lock refresh_lock(installed_packages_refresh_mutex);
 
-			    // Reaching here means it's just a local package
+		{
+			std::unique_lock packages_lock(packages_mutex);
+			std::unique_lock installed_packages_lock(installed_packages_mutex);
+			if (installed_packages.size())
+			{
+				installed_packages.clear();
+				reset_available_packages();
+			}
+		}
 
-			    auto local_pkg                      = std::make_unique<ts::v1::package>();
-			    local_pkg->name                     = m.name;
-			    local_pkg->full_name                = full_name_package;
-			    local_pkg->full_name_lower          = imm::string::to_lower(full_name_package);
-			    local_pkg->owner                    = m.author_name;
-			    local_pkg->is_local                 = true;
-			    local_pkg->is_installed             = true;
-			    local_pkg->installed_version_number = m.version_number;
+		{
+			std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+			if (!s_app_cache.active_profile)
+			{
+				if (!s_app_cache.profiles.size())
+				{
+					s_app_cache.profiles.push_back(std::make_shared<profile>());
+				}
 
-			    auto full_name_version = full_name_package + '-' + m.version_number;
-			    local_pkg->versions.push_back({.name = m.name, .full_name = full_name_version, .description = m.description, .version_number = m.version_number, .dependencies = m.dependencies, .is_installed = true, .full_name_lower = imm::string::to_lower(full_name_version)});
-			    packages.push_back(std::move(local_pkg));
+				for (const auto& prof : s_app_cache.profiles)
+				{
+					if (prof->name == s_app_cache.active_profile_name)
+					{
+						s_app_cache.active_profile = prof.get();
+						break;
+					}
+				}
+			}
+		}
 
-			    find_installed_pkg_from_available_packages(true);
-		    });
+		const auto config_folder = rom_folder / "config";
+		if (!std::filesystem::exists(config_folder))
+		{
+			std::filesystem::create_directories(config_folder);
+		}
+
+		const auto plugins_data_folder = rom_folder / "plugins_data";
+		if (!std::filesystem::exists(plugins_data_folder))
+		{
+			std::filesystem::create_directories(plugins_data_folder);
+		}
+
+		const auto plugins_folder = rom_folder / "plugins";
+		if (!std::filesystem::exists(plugins_folder))
+		{
+			std::filesystem::create_directories(plugins_folder);
+		}
+		for (const auto& scanned : scan_installed_manifests(plugins_folder))
+		{
+			const auto m = read_installed_manifest(scanned);
+			in_use_versions.insert(m.author_name + '-' + m.name + '-' + m.version_number);
+
+			queue_installed_manifest(scanned);
+		}
 	}
 
+	// Outside the refresh lock: replacing the watcher waits for its callback, which may be waiting on that lock.
+	watch_mod_folders(rom_folder);
+
+	// Once per run, before an install can be filling the store. What no profile and no installed package refers to goes.
+	static std::once_flag extracted_store_pruned;
+	std::call_once(extracted_store_pruned,
+	               [&]
+	               {
+		               std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+		               for (const auto& prof : s_app_cache.profiles)
+		               {
+			               for (const auto& enabled_state : prof->package_enabled_states)
+			               {
+				               in_use_versions.insert(enabled_state.full_name + '-' + enabled_state.version);
+			               }
+		               }
+
+		               get_extracted_store().prune(
+		                   [&](std::string_view name)
+		                   {
+			                   return in_use_versions.contains(std::string(name));
+		                   });
+	               });
+
 	auto rom_path = std::filesystem::path(s_app_cache.game_folder_path) / "version.dll";
 	if (std::filesystem::exists(rom_path))
 	{
@@ -471,45 +824,41 @@ static void on_game_folder_found()
 							    [full_name_package, version_number]()
 							    {
 								    std::unique_lock packages_lock(packages_mutex);
-								    for (auto& package : packages)
+								    const auto found = package_lookup.find_version(full_name_package, version_number);
+								    if (!found)
+								    {
+									    return;
+								    }
+
+								    auto package = found->pkg;
+								    {
+									    std::unique_lock installed_packages_lock(installed_packages_mutex);
+									    installed_packages.push_back({.pkg               = package,
+									                                  .pkg_version_index = found->version_index,
+									                                  .is_enabled        = true,
+									                                  .is_local          = false,
+									                                  .folder            = s_app_cache.game_folder_path,
+									                                  .full_name         = package->versions[found->version_index].full_name});
+								    }
+
+								    std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+								    bool has_enabled_entry = false;
+								    for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
 								    {
-									    if (package->full_name == full_name_package)
+									    if (enabled_state.full_name == full_name_package)
 									    {
-										    size_t i = 0;
-										    for (auto& pkg_ver : package->versions)
-										    {
-											    if (pkg_ver.version_number == version_number)
-											    {
-												    std::unique_lock installed_packages_lock(installed_packages_mutex);
-												    installed_packages.push_back({.pkg               = package.get(),
-												                                  .pkg_version_index = i,
-												                                  .is_enabled        = true,
-												                                  .is_local          = false,
-												                                  .folder = s_app_cache.game_folder_path});
-
-												    bool has_enabled_entry = false;
-												    for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
-												    {
-													    if (enabled_state.full_name == full_name_package)
-													    {
-														    has_enabled_entry = true;
-														    break;
-													    }
-												    }
-
-												    if (!has_enabled_entry)
-												    {
-													    s_app_cache.active_profile->package_enabled_states.push_back({.is_enabled = true, .full_name = full_name_package, .version = version_number});
-												    }
-
-												    package->is_installed             = true;
-												    package->installed_version_number = version_number;
-											    }
-
-											    i++;
-										    }
+										    has_enabled_entry = true;
+										    break;
 									    }
 								    }
+
+								    if (!has_enabled_entry)
+								    {
+									    s_app_cache.active_profile->package_enabled_states.push_back({.is_enabled = true, .full_name = full_name_package, .version = version_number});
+								    }
+
+								    package->is_installed             = true;
+								    package->installed_version_number = version_number;
 							    });
 						}
 					}
@@ -521,16 +870,22 @@ static void on_game_folder_found()
 	s_app_cache.save();
 }
 
-static void uninstall(ts::v1::package* package)
+static void uninstall(const std::string& package_full_name)
 {
-	const auto rom_plugins_plugin_folder = std::filesystem::path(s_app_cache.rom_folder_path_utf8) / "plugins" / package->full_name;
+	const auto rom_plugins_plugin_folder = std::filesystem::path(s_app_cache.rom_folder_path_utf8) / "plugins" / package_full_name;
 
-	SPDLOG_LOGGER_INFO(logger, "uninstalling {}", package->full_name);
+	SPDLOG_LOGGER_INFO(logger, "uninstalling {}", package_full_name);
 	SPDLOG_LOGGER_INFO(logger, L"with path {}", rom_plugins_plugin_folder.wstring());
 
 	if (std::filesystem::exists(rom_plugins_plugin_folder))
 	{
-		std::filesystem::remove_all(rom_plugins_plugin_folder);
+		// Moved aside in one rename, then deleted, a locked file can't leave half a mod behind.
+		imm::install::transaction tx(get_install_journal_folder());
+		tx.remove(rom_plugins_plugin_folder);
+		if (!tx.commit())
+		{
+			SPDLOG_LOGGER_INFO(logger, "uninstall of {} couldn't be committed, is the game running?", package_full_name);
+		}
 	}
 	else
 	{
@@ -540,82 +895,408 @@ static void uninstall(ts::v1::package* package)
 	std::thread(
 	    []()
 	    {
-		    on_game_folder_found();
+		    refresh_installed_packages();
 	    })
 	    .detach();
 }
 
-void gui::render_available_mods_panel()
+static constexpr auto thunderstore_package_index_url = "https://thunderstore.io/c/risk-of-rain-returns/api/v1/package/";
+// static constexpr auto thunderstore_package_index_url = "https://thunderstore.io/c/riskofrain2/api/v1/package/";
+
+// Applies a package from a refreshed index on top of the same package loaded from the snapshot,
+// keeping its category mask, search document and packages_generation in step.
+// Returns true if its versions changed. Caller must hold packages_mutex.
+static bool merge_available_package(ts::v1::package& existing, ts::v1::package&& package)
 {
-	ImGui::Begin(available_mods_title);
+	const bool categories_changed = existing.categories != package.categories;
+	const bool deprecated_changed = existing.is_deprecated != package.is_deprecated;
+	const bool versions_changed   = existing.date_updated != package.date_updated || existing.versions.size() != package.versions.size();
+
+	existing.rating_score     = package.rating_score;
+	existing.is_pinned        = package.is_pinned;
+	existing.is_deprecated    = package.is_deprecated;
+	existing.has_nsfw_content = package.has_nsfw_content;
+	existing.categories       = std::move(package.categories);
+	existing.donation_link    = std::move(package.donation_link);
+
+	if (versions_changed)
+	{
+		existing.date_updated = std::move(package.date_updated);
+		package_lookup.remove_versions(&existing);
+		existing.versions = std::move(package.versions);
+		package_lookup.add_versions(&existing);
+	}
 
-	static auto need_to_init = true;
-	if (need_to_init)
+	// New versions may come with a new description.
+	if (categories_changed || versions_changed)
 	{
-		need_to_init = false;
+		update_category_mask(&existing);
+		package_search_index.update(existing.search_document, existing.full_name, existing.owner, existing.categories, get_search_description(&existing));
+	}
 
-		std::thread(
-		    []
-		    {
-			    const auto r = cpr::Get(cpr::Url{"https://thunderstore.io/c/risk-of-rain-returns/api/v1/package/"}, cpr::Header{{"accept", "application/json"}});
-			    // const auto r = cpr::Get(cpr::Url{"https://thunderstore.io/c/riskofrain2/api/v1/package/"}, cpr::Header{{"accept", "application/json"}});
-			    auto session = cpr::Session();
-			    if (r.status_code == 200)
-			    {
-				    packages_json = nlohmann::json::parse(r.text, nullptr, false, true);
-				    init_available_packages();
+	if (categories_changed || deprecated_changed || versions_changed)
+	{
+		packages_generation++;
+	}
 
-				    std::unique_lock packages_lock(packages_mutex);
-				    for (auto& el : packages)
-				    {
-					    std::filesystem::path icon_path  = get_root_cache_folder();
-					    icon_path                       /= "icons";
+	return versions_changed;
+}
 
-					    if (!std::filesystem::exists(icon_path))
-					    {
-						    std::filesystem::create_directories(icon_path);
-					    }
+// Warm start: the snapshot populates the catalog right away, then a conditional request
+// brings it up to date. Cold start: the index streams straight into the catalog.
+static void load_available_packages()
+{
+	ts::v1::catalog_cache catalog(get_root_cache_folder() / "catalog");
 
-					    icon_path /= el->versions[0].full_name;
-					    icon_path += ".png";
+	const auto loaded_snapshot = catalog.load_snapshot(
+	    [](const ts::v1::package_view& package)
+	    {
+		    add_available_package(package);
+	    });
+	if (loaded_snapshot)
+	{
+		SPDLOG_LOGGER_INFO(logger, "loaded {} packages from catalog snapshot", get_available_packages_count());
+		available_packages_ready = true;
+	}
+	else
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		packages.clear();
+		rebuild_available_packages_index();
+	}
 
-					    if (!std::filesystem::exists(icon_path))
-					    {
-						    auto ofstream = std::ofstream(icon_path, std::ios::app | std::ios::binary);
-						    session.SetUrl(cpr::Url{el->versions[0].icon});
-						    auto response = session.Download(ofstream);
-					    }
+	// Local packages stay out, a catalog package with the same full name is its own entry and goes through the stale removal below.
+	std::unordered_map<std::string, ts::v1::package*> snapshot_packages;
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		for (const auto& pkg : packages)
+		{
+			if (!pkg->is_local)
+			{
+				snapshot_packages[pkg->full_name] = pkg.get();
+			}
+		}
+	}
 
-					    HANDLE file_handle = CreateFileW(icon_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-					    if (file_handle == INVALID_HANDLE_VALUE)
-					    {
-						    continue;
-					    }
-					    int nHandle = _open_osfhandle((intptr_t)file_handle, _O_RDONLY);
-					    if (nHandle == -1)
-					    {
-						    ::CloseHandle(file_handle);
-						    continue;
-					    }
-					    FILE* f = _fdopen(nHandle, "rb");
-					    if (!f)
-					    {
-						    ::CloseHandle(file_handle);
-						    continue;
-					    }
+	std::unordered_set<std::string> seen_full_names;
+	bool catalog_changed = false;
+
+	const auto result = catalog.refresh(thunderstore_package_index_url,
+	                                    [&](ts::v1::package&& package)
+	                                    {
+		                                    seen_full_names.insert(package.full_name);
+
+		                                    const auto it = snapshot_packages.find(package.full_name);
+		                                    if (it == snapshot_packages.end())
+		                                    {
+			                                    catalog_changed |= add_available_package(std::move(package));
+			                                    return;
+		                                    }
+
+		                                    std::unique_lock packages_lock(packages_mutex);
+		                                    catalog_changed |= merge_available_package(*it->second, std::move(package));
+	                                    });
+
+	if (result == ts::v1::catalog_cache::refresh_result::updated && loaded_snapshot)
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		std::unique_lock installed_packages_lock(installed_packages_mutex);
+
+		const auto removed_count = std::erase_if(packages,
+		                                         [&](const std::unique_ptr<ts::v1::package>& pkg)
+		                                         {
+			                                         return !pkg->is_local && !seen_full_names.contains(pkg->full_name);
+		                                         });
+
+		if (removed_count || catalog_changed)
+		{
+			// Installed packages may point to removed packages or to shifted version indices, match them again.
+			installed_packages.clear();
+			reset_available_packages();
+		}
+		else
+		{
+			catalog_changed = false;
+		}
+	}
+	else
+	{
+		catalog_changed = false;
+	}
+
+	const auto available_packages_count = get_available_packages_count();
+	SPDLOG_LOGGER_INFO(logger, "catalog refresh: {}, {} packages", (int)result, available_packages_count);
+	SPDLOG_LOGGER_INFO(logger, "interned {} strings, {} bytes", imm::string::intern_pool::global().count(), imm::string::intern_pool::global().bytes());
+
+	if (available_packages_count)
+	{
+		available_packages_ready = true;
+	}
+
+	if (catalog_changed && has_valid_game_folder_path)
+	{
+		on_game_folder_found();
+	}
+}
+
+static std::filesystem::path get_icon_path(const std::string& version_full_name)
+{
+	auto icon_path  = get_root_cache_folder() / "icons" / version_full_name;
+	icon_path      += ".png";
+	return icon_path;
+}
+
+static constexpr size_t icon_download_max_in_flight = 8;
+
+static imm::net::download_pool& get_icon_download_pool()
+{
+	static imm::net::download_pool pool(icon_download_max_in_flight);
+	return pool;
+}
+
+static constexpr size_t package_download_max_in_flight = 4;
+
+static imm::net::download_pool& get_package_download_pool()
+{
+	static imm::net::download_pool pool(package_download_max_in_flight);
+	return pool;
+}
+
+struct package_download_progress
+{
+	uint64_t downloaded = 0;
+	uint64_t total      = 0;
+};
+
+// Transfers in flight, keyed by "Owner-Name" so the row of a package shows its download whatever the version.
+static std::mutex package_downloads_mutex;
+static std::unordered_map<std::string, package_download_progress> package_downloads;
+
+static constexpr uint64_t zip_store_budget_bytes = 2ull * 1024 * 1024 * 1024;
+
+static imm::store::zip_store& get_zip_store()
+{
+	static imm::store::zip_store store(get_root_cache_folder() / "zip_store", zip_store_budget_bytes);
+	return store;
+}
+
+// Blocks until the zip of pkg_version is in the zip store, returns an empty path if the download failed.
+static std::filesystem::path download_package_zip(const ts::v1::package_version& pkg_version)
+{
+	auto& store = get_zip_store();
+	if (auto stored = store.find(pkg_version.full_name))
+	{
+		return *stored;
+	}
+
+	// Downloads land here, as did the whole cache of older versions.
+	auto zip_path = get_root_cache_folder() / "zips";
+	if (!std::filesystem::exists(zip_path))
+	{
+		std::filesystem::create_directories(zip_path);
+	}
+
+	zip_path /= pkg_version.full_name;
+	zip_path += ".zip";
+
+	// Only ever renamed into place once complete.
+	if (std::filesystem::exists(zip_path))
+	{
+		return store.add(pkg_version.full_name, zip_path).value_or(std::filesystem::path{});
+	}
+
+	const auto parsed = imm::install::parse_dependency(pkg_version.full_name);
+	const std::string package_full_name(parsed ? parsed->package_full_name : std::string_view(pkg_version.full_name));
+	{
+		std::unique_lock lock(package_downloads_mutex);
+		package_downloads[package_full_name] = {};
+	}
+
+	std::promise<bool> done;
+	get_package_download_pool().enqueue({.url         = pkg_version.download_url,
+	                                     .path        = zip_path,
+	                                     .on_progress = [package_full_name](uint64_t downloaded, uint64_t total)
+	                                     {
+		                                     std::unique_lock lock(package_downloads_mutex);
+		                                     package_downloads[package_full_name] = {.downloaded = downloaded, .total = total};
+	                                     },
+	                                     .on_done = [&done](bool success)
+	                                     {
+		                                     done.set_value(success);
+	                                     }});
+	const bool success = done.get_future().get();
+
+	{
+		std::unique_lock lock(package_downloads_mutex);
+		package_downloads.erase(package_full_name);
+	}
+
+	if (!success)
+	{
+		return {};
+	}
+
+	return store.add(pkg_version.full_name, zip_path).value_or(std::filesystem::path{});
+}
+
+static void render_zip_store_stats()
+{
+	const auto stats = get_zip_store().stats();
+	ImGui::TextDisabled("Zip cache: %zu archives, %.1f / %.0f MB, %llu hits, %llu misses, %llu deduplicated, %llu evicted",
+	                    stats.object_count,
+	                    stats.total_bytes / (1024.0 * 1024.0),
+	                    stats.budget_bytes / (1024.0 * 1024.0),
+	                    (unsigned long long)stats.hits,
+	                    (unsigned long long)stats.misses,
+	                    (unsigned long long)stats.deduplicated,
+	                    (unsigned long long)stats.evicted_objects);
+}
+
+static void render_package_download_progress(const ts::v1::package& package)
+{
+	package_download_progress progress;
+	{
+		std::unique_lock lock(package_downloads_mutex);
+		const auto it = package_downloads.find(package.full_name);
+		if (it == package_downloads.end())
+		{
+			return;
+		}
+		progress = it->second;
+	}
+
+	const float fraction = progress.total ? (float)((double)progress.downloaded / progress.total) : 0.0f;
+	const auto overlay   = std::format("{:.1f} / {:.1f} MB", progress.downloaded / (1024.0 * 1024.0), progress.total / (1024.0 * 1024.0));
+	ImGui::ProgressBar(fraction, ImVec2(200, 0), overlay.c_str());
+}
+
+// Missing icons are queued on the download pool and show up in the panel as each transfer lands.
+// Decoding and upload only happen once a row is on screen, see render_package_icon.
+static void load_available_package_icons()
+{
+	const auto icons_folder = get_root_cache_folder() / "icons";
+	if (!std::filesystem::exists(icons_folder))
+	{
+		std::filesystem::create_directories(icons_folder);
+	}
+
+	// has_icon_file is read while drawing with packages_mutex held, so it is only ever written with it held too,
+	// through the version index since versions may have been replaced by then.
+	const auto set_has_icon_file = [](const std::string& full_name, bool has_icon_file)
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		if (const auto found = package_lookup.find_version(full_name))
+		{
+			found->pkg->versions[found->version_index].has_icon_file = has_icon_file;
+		}
+	};
+
+	// Packages are already visible in the panel, don't hold packages_mutex while checking icons.
+	std::vector<ts::v1::package_version> missing_icons;
+	{
+		std::unique_lock packages_lock(packages_mutex);
+		for (const auto& pkg : packages)
+		{
+			if (pkg->is_local || pkg->versions.empty() || pkg->versions[0].has_icon_file || pkg->versions[0].icon.empty())
+			{
+				continue;
+			}
+
+			missing_icons.push_back({.full_name = pkg->versions[0].full_name, .icon = pkg->versions[0].icon});
+		}
+	}
+
+	for (const auto& pkg_version : missing_icons)
+	{
+		const auto icon_path = get_icon_path(pkg_version.full_name);
+		if (std::filesystem::exists(icon_path))
+		{
+			set_has_icon_file(pkg_version.full_name, true);
+			continue;
+		}
+
+		get_icon_download_pool().enqueue({.url     = pkg_version.icon,
+		                                  .path    = icon_path,
+		                                  .on_done = [set_has_icon_file, full_name = pkg_version.full_name](bool success)
+		                                  {
+			                                  set_has_icon_file(full_name, success);
+		                                  }});
+	}
+}
+
+static constexpr size_t icon_cache_budget_bytes = 64 * 1024 * 1024;
+
+static imm::icons::icon_cache& get_icon_cache()
+{
+	static imm::icons::icon_cache cache(g_pd3dDevice, icon_cache_budget_bytes, get_root_cache_folder() / "icon_thumbnails");
+	return cache;
+}
+
+// The icon is the one of the latest version, version_full_name names it.
+static void render_package_icon(bool has_icon_file, const std::string& version_full_name)
+{
+	const auto icon_size = ImVec2(256 / 2, 256 / 2);
+
+	imm::icons::icon_handle icon;
+	if (has_icon_file && ImGui::IsRectVisible(icon_size))
+	{
+		icon = get_icon_cache().get(get_icon_path(version_full_name));
+	}
+
+	if (icon)
+	{
+		ImGui::Image(icon.texture, icon_size, icon.uv0, icon.uv1);
+	}
+	else
+	{
+		ImGui::Dummy(icon_size);
+	}
+}
+
+// Caller must hold packages_mutex.
+static void render_package_icon(const ts::v1::package& package)
+{
+	static const std::string no_icon;
+	if (package.versions.size())
+	{
+		render_package_icon(package.versions[0].has_icon_file, package.versions[0].full_name);
+	}
+	else
+	{
+		render_package_icon(false, no_icon);
+	}
+}
+
+// Icon, wrapped description and install button, only used for rows that were never drawn yet.
+static constexpr float available_mods_row_estimated_height = 200.0f;
+
+// Independent branches of an install plan are downloaded and extracted at the same time.
+static constexpr size_t install_max_parallel_steps = 4;
 
-					    int my_image_width;
-					    int my_image_height;
-					    LoadTextureFromFile(f, &el->versions[0].icon_texture, &my_image_width, &my_image_height);
-				    }
+void gui::render_available_mods_panel()
+{
+	ImGui::Begin(available_mods_title);
+
+	static auto need_to_init = true;
+	if (need_to_init)
+	{
+		need_to_init = false;
+
+		std::thread(
+		    []
+		    {
+			    load_available_packages();
 
-				    available_packages_ready = true;
+			    if (available_packages_ready)
+			    {
+				    load_available_package_icons();
 			    }
 		    })
 		    .detach();
 	}
 
-	if (available_packages_ready)
+	const auto available_packages_count = get_available_packages_count();
+	if (available_packages_count)
 	{
 		ImGui::SeparatorText("Search & Sort");
 
@@ -625,34 +1306,20 @@ void gui::render_available_mods_panel()
 			search_text_input = imm::string::to_lower(search_text_input);
 		}
 
+		static auto sort_order = available_packages_sort::catalog;
 		if (ImGui::Button("A to Z"))
 		{
-			std::sort(packages.begin(),
-			          packages.end(),
-			          [](std::unique_ptr<ts::v1::package>& a, std::unique_ptr<ts::v1::package>& b)
-			          {
-				          return a->full_name < b->full_name;
-			          });
+			sort_order = available_packages_sort::name_ascending;
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Z to A"))
 		{
-			std::sort(packages.begin(),
-			          packages.end(),
-			          [](std::unique_ptr<ts::v1::package>& a, std::unique_ptr<ts::v1::package>& b)
-			          {
-				          return a->full_name > b->full_name;
-			          });
+			sort_order = available_packages_sort::name_descending;
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Last Updated"))
 		{
-			std::sort(packages.begin(),
-			          packages.end(),
-			          [](std::unique_ptr<ts::v1::package>& a, std::unique_ptr<ts::v1::package>& b)
-			          {
-				          return a->date_updated > b->date_updated;
-			          });
+			sort_order = available_packages_sort::last_updated;
 		}
 
 		static bool show_modpacks      = false;
@@ -666,327 +1333,330 @@ void gui::render_available_mods_panel()
 			ImGui::Checkbox("Show Only Modpacks", &show_only_modpacks);
 		}
 
-		ImGui::SeparatorText(std::format("Available Mods ({})", packages.size()).c_str());
+		render_zip_store_stats();
+
+		ImGui::SeparatorText(std::format("Available Mods ({})", available_packages_count).c_str());
 
 		// ImGui::BeginChild("Available Mods", ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
 		ImGui::BeginChild("Available Mods");
 		std::unique_lock packages_lock(packages_mutex);
-		for (const auto& package : packages)
+
+		// Ranked results only change with the query or the catalog, not per frame.
+		static std::string last_search_text;
+		static uint64_t last_search_generation = 0;
+		static std::vector<ts::v1::package*> search_results;
+		if (search_text_input != last_search_text || package_search_index.generation() != last_search_generation)
 		{
-			bool is_modpack = false;
-			for (const auto& categ : package->categories)
+			last_search_text       = search_text_input;
+			last_search_generation = package_search_index.generation();
+
+			search_results.clear();
+			for (const auto doc_id : package_search_index.query(search_text_input))
 			{
-				if (categ == "Modpacks")
-				{
-					is_modpack = true;
-					break;
-				}
+				search_results.push_back(package_search_documents[doc_id]);
 			}
+		}
+
+		// Filtered and sorted view over packages, only rebuilt when one of its inputs changes.
+		// packages itself is never reordered, the loader thread may be appending to it.
+		static std::vector<ts::v1::package*> visible_packages;
+		static imm::ui::virtual_list available_mods_list(available_mods_row_estimated_height);
+		static available_packages_view_state last_view_state;
+		const available_packages_view_state view_state{.packages_generation = packages_generation,
+		                                               .search_generation   = last_search_generation,
+		                                               .search_text         = search_text_input,
+		                                               .sort_order          = sort_order,
+		                                               .show_modpacks       = show_modpacks,
+		                                               .show_only_modpacks  = show_only_modpacks,
+		                                               .show_deprecated     = show_deprecated};
+		if (view_state != last_view_state)
+		{
+			last_view_state = view_state;
 
-			if (!show_modpacks)
+			const auto modpacks_mask = get_category_mask("Modpacks");
+
+			const auto add_if_visible = [modpacks_mask](ts::v1::package* package)
 			{
-				if (is_modpack)
+				const bool is_modpack = package->category_mask & modpacks_mask;
+				if (!show_modpacks)
 				{
-					continue;
+					if (is_modpack)
+					{
+						return;
+					}
 				}
-			}
-			else if (show_only_modpacks && !is_modpack)
-			{
-				continue;
-			}
-
-			if (!show_deprecated)
-			{
-				if (package->is_deprecated)
+				else if (show_only_modpacks && !is_modpack)
 				{
-					continue;
+					return;
 				}
-			}
 
-			if (strlen(search_text_input.data()))
-			{
-				if (!package->full_name_lower.contains(search_text_input))
+				if (!show_deprecated)
 				{
-					continue;
+					if (package->is_deprecated)
+					{
+						return;
+					}
 				}
-			}
-
-			bool pushed_color_this_frame = false;
-			if (package->is_deprecated)
-			{
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, DEPRECATED_COLOR_BG);
-				pushed_color_this_frame = true;
-			}
-			else if (package->is_installed)
-			{
-				// ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.25f));
-				// pushed_color_this_frame = true;
-			}
-
-			ImGui::BeginChild(package->name.c_str(), ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
 
-			ImGui::Image((void*)package->versions[0].icon_texture, ImVec2(256 / 2, 256 / 2));
-			ImGui::SameLine();
-			if (package->is_local)
-			{
-				ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nVersion: %s",
-				                   package->owner.c_str(),
-				                   package->name.c_str(),
-				                   package->versions[0].description.c_str(),
-				                   package->versions[0].version_number.c_str());
-			}
-			else
-			{
-				ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nLatest Version: %s",
-				                   package->owner.c_str(),
-				                   package->name.c_str(),
-				                   package->versions[0].description.c_str(),
-				                   package->versions[0].version_number.c_str());
-			}
-			if (package->is_deprecated)
-			{
-				ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(DEPRECATED_COLOR), "Deprecated");
-			}
+				visible_packages.push_back(package);
+			};
 
-			if (package->is_installed)
+			visible_packages.clear();
+			if (search_text_input.size())
 			{
-				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 0.0f, 0.0f, 0.75f));
+				for (const auto package : search_results)
+				{
+					add_if_visible(package);
+				}
 			}
 			else
 			{
-				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 1.0f, 0.0f, 0.75f));
-			}
-
-			if (ImGui::Button(package->is_installed ? std::format("Uninstall {}", package->installed_version_number).c_str() :
-			                                          std::format("Install {}", package->versions[0].version_number).c_str(),
-			                  ImVec2(200, 0)))
-			{
-				package->is_installed = !package->is_installed;
-
-				if (package->is_installed)
+				for (const auto& package : packages)
 				{
-					std::thread(
-					    [&]
-					    {
-						    auto session = cpr::Session();
-
-						    auto download_package_version = [&](const ts::v1::package_version& pkg_version) -> std::filesystem::path
-						    {
-							    std::filesystem::path zip_path  = get_root_cache_folder();
-							    zip_path                       /= "zips";
-
-							    if (!std::filesystem::exists(zip_path))
-							    {
-								    std::filesystem::create_directories(zip_path);
-							    }
-
-							    zip_path /= pkg_version.full_name;
-							    zip_path += ".zip";
-
-							    if (!std::filesystem::exists(zip_path))
-							    {
-								    auto ofstream = std::ofstream(zip_path, std::ios::app | std::ios::binary);
-								    session.SetUrl(cpr::Url{pkg_version.download_url});
-								    auto response = session.Download(ofstream);
-							    }
+					add_if_visible(package.get());
+				}
+			}
 
-							    return zip_path;
-						    };
+			sort_available_packages(visible_packages, sort_order);
 
-						    auto download_dep = [&](std::string dep) -> std::filesystem::path
-						    {
-							    std::unique_lock packages_lock(packages_mutex);
-							    for (const auto& other_pkg : packages)
-							    {
-								    /*for (const auto& other_pkg_version : other_pkg->versions)
-								    {
-									    if (other_pkg_version.full_name == dep)
-									    {
-										    return download_package_version(other_pkg_version);
-									    }
-								    }*/
+			available_mods_list.set_items(visible_packages);
+		}
 
-								    for (const auto& other_pkg_version : other_pkg->versions)
-								    {
-									    if (other_pkg_version.full_name == dep)
-									    {
-										    // Download latest.
-										    return download_package_version(other_pkg->versions[0]);
-									    }
-								    }
-							    }
+		available_mods_list.render(
+		    [](size_t row)
+		    {
+			    const auto package = visible_packages[row];
 
-							    return "";
-						    };
+			    bool pushed_color_this_frame = false;
+			    if (package->is_deprecated)
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_FrameBg, DEPRECATED_COLOR_BG);
+				    pushed_color_this_frame = true;
+			    }
+			    else if (package->is_installed)
+			    {
+				    // ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.25f));
+				    // pushed_color_this_frame = true;
+			    }
 
-						    auto handle_zip = [](std::filesystem::path zip_path)
-						    {
-							    const auto extracted_zip_folder_path = zip_path.parent_path() / zip_path.stem();
-							    if (std::filesystem::exists(zip_path))
-							    {
-								    if (zip_extract((char*)zip_path.u8string().c_str(),
-								                    (char*)extracted_zip_folder_path.u8string().c_str(),
-								                    nullptr,
-								                    nullptr)
-								        == 0)
-								    {
-									    const auto output_package_folder_name_splitted =
-									        imm::string::split((char*)zip_path.stem().u8string().c_str(), '-');
-									    const auto output_package_folder_name = output_package_folder_name_splitted[0] + '-' + output_package_folder_name_splitted[1];
+			    ImGui::BeginChild(package->name.c_str(), ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
 
-									    if (output_package_folder_name == "ReturnOfModding-ReturnOfModding")
-									    {
-										    for (const auto& entry : std::filesystem::recursive_directory_iterator(extracted_zip_folder_path, std::filesystem::directory_options::skip_permission_denied))
-										    {
-											    if (entry.path().filename() == "version.dll")
-											    {
-												    std::filesystem::copy(entry, std::filesystem::path(s_app_cache.game_folder_path) / "version.dll", std::filesystem::copy_options::overwrite_existing);
-											    }
-										    }
-									    }
-									    else
-									    {
-										    const auto rom_plugins_plugin_folder = std::filesystem::path(s_app_cache.rom_folder_path_utf8) / "plugins" / output_package_folder_name;
-										    if (!std::filesystem::exists(rom_plugins_plugin_folder))
-										    {
-											    std::filesystem::create_directories(rom_plugins_plugin_folder);
-										    }
-
-										    const auto rom_plugins_data_plugin_folder =
-										        std::filesystem::path(s_app_cache.rom_folder_path_utf8) / "plugins_data" / output_package_folder_name;
-										    if (!std::filesystem::exists(rom_plugins_data_plugin_folder))
-										    {
-											    std::filesystem::create_directories(rom_plugins_data_plugin_folder);
-										    }
-
-										    const auto rom_config_plugin_folder = std::filesystem::path(s_app_cache.rom_folder_path_utf8) / "config" / output_package_folder_name;
-										    if (!std::filesystem::exists(rom_config_plugin_folder))
-										    {
-											    std::filesystem::create_directories(rom_config_plugin_folder);
-										    }
-
-										    std::vector<std::filesystem::path> already_copied_directories;
-										    for (const auto& entry : std::filesystem::recursive_directory_iterator(extracted_zip_folder_path, std::filesystem::directory_options::skip_permission_denied))
-										    {
-											    SPDLOG_LOGGER_INFO(logger, entry.path().wstring());
-
-											    if (entry.path().parent_path() == extracted_zip_folder_path && !entry.is_directory())
-											    {
-												    std::filesystem::copy(entry.path(),
-												                          rom_plugins_plugin_folder / entry.path().filename(),
-												                          std::filesystem::copy_options::overwrite_existing);
-											    }
-											    else if (entry.is_directory())
-											    {
-												    auto is_subpath = [](const std::filesystem::path& path, const std::filesystem::path& base) -> bool
-												    {
-													    auto rel = std::filesystem::relative(path, base);
-													    return !rel.empty() && rel.native()[0] != '.';
-												    };
-
-												    bool is_already_copied = false;
-												    for (const auto& already_copied_dir : already_copied_directories)
-												    {
-													    if (is_subpath(entry.path(), already_copied_dir))
-													    {
-														    is_already_copied = true;
-													    }
-												    }
-												    if (is_already_copied)
-												    {
-													    continue;
-												    }
-												    already_copied_directories.push_back(entry.path());
-
-												    if (entry.path().filename() == "plugins")
-												    {
-													    std::filesystem::copy(entry.path(),
-													                          rom_plugins_plugin_folder / entry.path().filename(),
-													                          std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
-												    }
-												    else if (entry.path().filename() == "plugins_data")
-												    {
-													    std::filesystem::copy(entry.path(),
-													                          rom_plugins_data_plugin_folder
-													                              / entry.path().filename(),
-													                          std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
-												    }
-												    else if (entry.path().filename() == "config")
-												    {
-													    std::filesystem::copy(entry.path(),
-													                          rom_config_plugin_folder / entry.path().filename(),
-													                          std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
-												    }
-												    else
-												    {
-													    std::filesystem::copy(entry.path(),
-													                          rom_plugins_plugin_folder / entry.path().filename(),
-													                          std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing);
-												    }
-											    }
-										    }
-									    }
-								    }
-							    }
-						    };
+			    render_package_icon(*package);
+			    ImGui::SameLine();
+			    if (package->is_local)
+			    {
+				    ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nVersion: %s",
+				                       package->owner.c_str(),
+				                       package->name.c_str(),
+				                       package->versions[0].description.c_str(),
+				                       package->versions[0].version_number.c_str());
+			    }
+			    else
+			    {
+				    ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nLatest Version: %s",
+				                       package->owner.c_str(),
+				                       package->name.c_str(),
+				                       package->versions[0].description.c_str(),
+				                       package->versions[0].version_number.c_str());
+			    }
+			    if (package->is_deprecated)
+			    {
+				    ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(DEPRECATED_COLOR), "Deprecated");
+			    }
 
-						    for (const auto& dep : package->versions[0].dependencies)
-						    {
-							    const auto zip_path = download_dep(dep);
+			    if (package->is_installed)
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 0.0f, 0.0f, 0.75f));
+			    }
+			    else
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 1.0f, 0.0f, 0.75f));
+			    }
 
-							    std::unique_lock installed_packages_lock(installed_packages_mutex);
-							    for (const auto& installed_package : installed_packages)
-							    {
-								    const auto dep_split   = imm::string::split(dep, '-');
-								    const auto dep_version = dep_split[2];
-								    semver::version installed_vers(
-								        installed_package.pkg->versions[installed_package.pkg_version_index].version_number);
-								    if (installed_vers < semver::version(dep_version))
-								    {
-									    handle_zip(zip_path);
-								    }
-							    }
-						    }
+			    if (ImGui::Button(package->is_installed ? std::format("Uninstall {}", package->installed_version_number).c_str() :
+			                                              std::format("Install {}", package->versions[0].version_number).c_str(),
+			                      ImVec2(200, 0)))
+			    {
+				    package->is_installed = !package->is_installed;
 
-						    const auto zip_path = download_package_version(package->versions[0]);
-						    handle_zip(zip_path);
+				    if (package->is_installed)
+				    {
+					    // By value, a catalog refresh or a rescan can free package while the install runs.
+					    std::thread(
+					        [package_full_name = package->full_name, version_number = package->versions[0].version_number]
+					        {
+						        auto install_package_version = [](const ts::v1::package_version& version, imm::install::transaction& tx)
+						        {
+							        const auto& version_full_name                  = version.full_name;
+							        const auto output_package_folder_name_splitted = imm::string::split(version_full_name, '-');
+							        const auto output_package_folder_name          = output_package_folder_name_splitted[0] + '-' + output_package_folder_name_splitted[1];
+
+							        // Older versions extracted every zip next to it before copying the files, those copies are never read.
+							        std::error_code ec;
+							        std::filesystem::remove_all(get_root_cache_folder() / "zips" / version_full_name, ec);
+
+							        if (output_package_folder_name == "ReturnOfModding-ReturnOfModding")
+							        {
+								        const auto zip_path = download_package_zip(version);
+								        return !zip_path.empty()
+								            && imm::install::extract_zip(zip_path,
+								                                         [&tx](std::string_view entry_name) -> std::optional<std::filesystem::path>
+								                                         {
+									                                         if (entry_name == "version.dll" || entry_name.ends_with("/version.dll"))
+									                                         {
+										                                         return tx.stage_file(std::filesystem::path(s_app_cache.game_folder_path) / "version.dll");
+									                                         }
+									                                         return std::nullopt;
+								                                         });
+							        }
+
+							        // Extracted once, every later install of this version links the same files, no download needed.
+							        const auto extracted = get_extracted_store().get_or_create(version_full_name,
+							                                                                   [&version](const std::filesystem::path& folder)
+							                                                                   {
+								                                                                   const auto zip_path = download_package_zip(version);
+								                                                                   if (zip_path.empty())
+								                                                                   {
+									                                                                   return false;
+								                                                                   }
+
+								                                                                   const auto store_folders = imm::install::extracted_plugin_folders(folder);
+								                                                                   return imm::install::extract_zip(zip_path,
+								                                                                                                    [&store_folders](std::string_view entry_name)
+								                                                                                                    {
+									                                                                                                    return imm::install::route_plugin_zip_entry(entry_name, store_folders);
+								                                                                                                    });
+							                                                                   });
+							        if (!extracted)
+							        {
+								        return false;
+							        }
+
+							        // Written next to the live folders, swapped in when the whole plan is done. plugins is replaced
+							        // by the new version as a whole, config and plugins_data keep what the user and the mod wrote.
+							        const auto rom_folder = std::filesystem::path(s_app_cache.rom_folder_path_utf8);
+							        const imm::install::plugin_folders folders{
+							            .plugins      = tx.stage_directory(rom_folder / "plugins" / output_package_folder_name, false),
+							            .plugins_data = tx.stage_directory(rom_folder / "plugins_data" / output_package_folder_name, true),
+							            .config       = tx.stage_directory(rom_folder / "config" / output_package_folder_name, true),
+							        };
+
+							        const auto stats = imm::install::install_extracted(*extracted, folders);
+							        SPDLOG_LOGGER_INFO(logger, "{}: {} files reflinked, {} hard linked, {} copied, {} failed", version_full_name, stats.reflinked, stats.hard_linked, stats.copied, stats.failed);
+							        return stats.failed == 0;
+						        };
+
+						        imm::install::install_plan plan;
+						        // Copied under the lock, a catalog refresh can replace the versions while the plan runs.
+						        std::vector<ts::v1::package_version> step_versions;
+						        {
+							        std::unique_lock packages_lock(packages_mutex);
+
+							        std::unordered_map<std::string, std::string> installed_versions;
+							        {
+								        std::unique_lock installed_packages_lock(installed_packages_mutex);
+								        for (const auto& installed_package : installed_packages)
+								        {
+									        installed_versions.emplace(installed_package.pkg->full_name, installed_package.pkg->versions[installed_package.pkg_version_index].version_number);
+								        }
+							        }
+
+							        imm::install::resolver_catalog catalog;
+							        catalog.find_package = [](std::string_view package_full_name) -> const ts::v1::package*
+							        {
+								        return package_lookup.find_package(package_full_name);
+							        };
+							        catalog.installed_version = [&](std::string_view package_full_name) -> std::optional<std::string>
+							        {
+								        const auto it = installed_versions.find(std::string(package_full_name));
+								        if (it == installed_versions.end())
+								        {
+									        return std::nullopt;
+								        }
+								        return it->second;
+							        };
+
+							        // Looked up again, only what the lookup returns under this lock is used.
+							        const auto found = package_lookup.find_version(package_full_name, version_number);
+							        if (!found)
+							        {
+								        SPDLOG_LOGGER_INFO(logger, "Can't install {}: {} is no longer in the catalog", package_full_name, version_number);
+								        return;
+							        }
+
+							        plan = imm::install::resolve_install_plan(*found->pkg, found->version_index, catalog);
+							        for (const auto& step : plan.steps)
+							        {
+								        step_versions.push_back(step.pkg->versions[step.version_index]);
+							        }
+						        }
+
+						        if (!plan.ok())
+						        {
+							        for (const auto& conflict : plan.conflicts)
+							        {
+								        SPDLOG_LOGGER_INFO(logger, "Can't install {}: {}", package_full_name, conflict);
+							        }
+						        }
+						        else
+						        {
+							        // The whole plan lands at once or not at all.
+							        imm::install::transaction tx(get_install_journal_folder());
+							        const bool staged = imm::install::run_install_plan(plan,
+							                                                           install_max_parallel_steps,
+							                                                           [&](size_t step_index)
+							                                                           {
+								                                                           return install_package_version(step_versions[step_index], tx);
+							                                                           });
+							        if (!staged)
+							        {
+								        SPDLOG_LOGGER_INFO(logger, "install of {} failed, nothing was changed", package_full_name);
+								        tx.rollback();
+							        }
+							        else if (!tx.commit())
+							        {
+								        SPDLOG_LOGGER_INFO(logger, "install of {} couldn't be committed, is the game running?", package_full_name);
+							        }
+						        }
+
+						        on_game_folder_found();
+					        })
+					        .detach();
+				    }
+				    else
+				    {
+					    uninstall(package->full_name);
+				    }
+			    }
 
-						    on_game_folder_found();
-					    })
-					    .detach();
-				}
-				else
-				{
-					uninstall(package.get());
-				}
-			}
+			    render_package_download_progress(*package);
 
-			if (package->versions[0].dependencies.size())
-			{
-				if (ImGui::CollapsingHeader("Dependencies"))
-				{
-					for (const auto& dep : package->versions[0].dependencies)
-					{
-						ImGui::BulletText(dep.c_str());
-					}
-				}
-			}
-			else
-			{
-				ImGui::Text("No Dependencies");
-			}
+			    if (package->versions[0].dependencies.size())
+			    {
+				    if (ImGui::CollapsingHeader("Dependencies"))
+				    {
+					    for (const auto& dep : package->versions[0].dependencies)
+					    {
+						    ImGui::BulletText(dep.c_str());
+					    }
+				    }
+			    }
+			    else
+			    {
+				    ImGui::Text("No Dependencies");
+			    }
 
-			ImGui::PopStyleColor();
+			    ImGui::PopStyleColor();
 
-			ImGui::Separator();
+			    ImGui::Separator();
 
-			ImGui::EndChild();
+			    ImGui::EndChild();
 
-			if (pushed_color_this_frame)
-			{
-				ImGui::PopStyleColor();
-			}
-		}
+			    if (pushed_color_this_frame)
+			    {
+				    ImGui::PopStyleColor();
+			    }
+		    });
 		ImGui::EndChild();
 	}
 
@@ -1053,6 +1723,61 @@ static process_running_info is_process_running(const std::wstring& process_name)
 	return {};
 }
 
+// What a row of Installed Mods draws. Copied out while the locks are held, so drawing never dereferences a package
+// that a catalog refresh or a rescan may free in the meantime.
+struct installed_package_row
+{
+	std::string package_full_name;
+	std::string name;
+	std::string owner;
+	std::string description;
+	std::string version_number;
+	std::string installed_version_number;
+	std::string icon_version_full_name;
+	bool has_icon_file = false;
+	bool is_deprecated = false;
+	bool is_installed  = false;
+	bool is_enabled    = false;
+	bool is_local      = false;
+	std::filesystem::path folder;
+};
+
+// Caller must hold packages_mutex and installed_packages_mutex.
+static installed_package_row make_installed_package_row(const installed_package& installed)
+{
+	const auto& pkg         = *installed.pkg;
+	const auto& pkg_version = pkg.versions[installed.pkg_version_index];
+	return {.package_full_name        = pkg.full_name,
+	        .name                     = pkg.name,
+	        .owner                    = pkg.owner.str(),
+	        .description              = pkg_version.description,
+	        .version_number           = pkg_version.version_number,
+	        .installed_version_number = pkg.installed_version_number,
+	        .icon_version_full_name   = pkg.versions[0].full_name,
+	        .has_icon_file            = pkg.versions[0].has_icon_file,
+	        .is_deprecated            = pkg.is_deprecated,
+	        .is_installed             = pkg.is_installed,
+	        .is_enabled               = installed.is_enabled,
+	        .is_local                 = installed.is_local,
+	        .folder                   = installed.folder};
+}
+
+// Rows are drawn from copies, toggles are written back to the shared list by folder.
+static void set_installed_package_enabled(const std::filesystem::path& folder, bool is_enabled)
+{
+	std::unique_lock installed_packages_lock(installed_packages_mutex);
+	for (auto& installed_package : installed_packages)
+	{
+		if (installed_package.folder == folder)
+		{
+			installed_package.is_enabled = is_enabled;
+			break;
+		}
+	}
+}
+
+static constexpr float installed_mods_row_estimated_height = 200.0f;
+
 void gui::render_installed_mods_panel()
 {
 	ImGui::Begin(installed_mods_title);
@@ -1278,125 +2003,193 @@ void gui::render_installed_mods_panel()
 
 		ImGui::SeparatorText(std::format("Installed Mods ({})", installed_packages.size()).c_str());
 
-		int i = 0;
-		std::unique_lock installed_packages_lock(installed_packages_mutex);
-		for (auto& installed_package : installed_packages)
+		static imm::ui::virtual_list installed_mods_list(installed_mods_row_estimated_height);
+		// Copies of what the rows on screen draw, the locks are only held while taking them.
+		static std::vector<installed_package_row> visible_rows;
+		size_t first_visible_row = 0;
 		{
-			if (strlen(search_text_input.data()))
+			static std::vector<ts::v1::package*> filtered_packages;
+			static std::vector<size_t> filtered_indices;
+			filtered_packages.clear();
+			filtered_indices.clear();
+
+			std::unique_lock packages_lock(packages_mutex);
+			std::unique_lock installed_packages_lock(installed_packages_mutex);
+			if (search_text_input.size())
 			{
-				if (!installed_package.pkg->versions[installed_package.pkg_version_index].full_name_lower.contains(search_text_input))
+				// Best fuzzy match first, so typos still find the mod.
+				const imm::search::fuzzy_pattern pattern(search_text_input);
+				std::vector<std::pair<int, size_t>> scored;
+				for (size_t i = 0; i < installed_packages.size(); i++)
 				{
-					continue;
+					const auto& installed_package = installed_packages[i];
+					if (const auto score = pattern.score(installed_package.full_name.folded()))
+					{
+						scored.emplace_back(*score, i);
+					}
+				}
+				std::stable_sort(scored.begin(),
+				                 scored.end(),
+				                 [](const auto& a, const auto& b)
+				                 {
+					                 return a.first > b.first;
+				                 });
+
+				for (const auto& [score, i] : scored)
+				{
+					if (score < imm::search::min_fuzzy_score(scored[0].first))
+					{
+						break;
+					}
+					filtered_packages.push_back(installed_packages[i].pkg);
+					filtered_indices.push_back(i);
 				}
-			}
-
-
-			if (installed_package.is_enabled)
-			{
-				// ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.25f));
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, ImGui::GetStyle().Colors[ImGuiCol_FrameBg]);
-			}
-			else if (installed_package.pkg->is_deprecated)
-			{
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, DEPRECATED_COLOR_BG);
 			}
 			else
 			{
-				// ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.1f));
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, ImGui::GetStyle().Colors[ImGuiCol_FrameBg]);
+				for (size_t i = 0; i < installed_packages.size(); i++)
+				{
+					filtered_packages.push_back(installed_packages[i].pkg);
+					filtered_indices.push_back(i);
+				}
 			}
 
-			ImGui::BeginChild(installed_package.pkg->name.c_str(), ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
+			installed_mods_list.set_items(filtered_packages);
 
-			ImGui::Image((void*)installed_package.pkg->versions[installed_package.pkg_version_index].icon_texture, ImVec2(256 / 2, 256 / 2));
-			ImGui::SameLine();
-			if (installed_package.is_local)
+			const auto [first, last] = installed_mods_list.visible_range();
+			first_visible_row        = first;
+			visible_rows.clear();
+			for (size_t row = first; row < last; row++)
 			{
-				ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nVersion: %s%s",
-				                   installed_package.pkg->owner.c_str(),
-				                   installed_package.pkg->name.c_str(),
-				                   installed_package.pkg->versions[installed_package.pkg_version_index].description.c_str(),
-				                   installed_package.pkg->versions[installed_package.pkg_version_index].version_number.c_str(),
-				                   installed_package.is_local ? "\n\n(Local Package)" : "");
-			}
-			else
-			{
-				ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nLatest Version: %s%s",
-				                   installed_package.pkg->owner.c_str(),
-				                   installed_package.pkg->name.c_str(),
-				                   installed_package.pkg->versions[installed_package.pkg_version_index].description.c_str(),
-				                   installed_package.pkg->versions[installed_package.pkg_version_index].version_number.c_str(),
-				                   installed_package.is_local ? "\n\n(Local Package)" : "");
+				visible_rows.push_back(make_installed_package_row(installed_packages[filtered_indices[row]]));
 			}
+		}
 
-			if (installed_package.is_local)
-			{
-				if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
-				{
-					ImGui::SetTooltip("Local package. Could not find it on the thunderstore website.");
-				}
-			}
+		installed_mods_list.render(
+		    [first_visible_row](size_t row)
+		    {
+			    if (row - first_visible_row >= visible_rows.size())
+			    {
+				    return false;
+			    }
+			    auto& installed_package = visible_rows[row - first_visible_row];
+
+			    if (installed_package.is_enabled)
+			    {
+				    // ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.25f));
+				    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImGui::GetStyle().Colors[ImGuiCol_FrameBg]);
+			    }
+			    else if (installed_package.is_deprecated)
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_FrameBg, DEPRECATED_COLOR_BG);
+			    }
+			    else
+			    {
+				    // ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 1.0f, 0.0f, 0.1f));
+				    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImGui::GetStyle().Colors[ImGuiCol_FrameBg]);
+			    }
 
-			ImGui::PushID(i);
+			    ImGui::BeginChild(installed_package.name.c_str(), ImVec2(0, 0), ImGuiChildFlags_AutoResizeY | ImGuiChildFlags_FrameStyle);
 
-			if (installed_package.is_enabled)
-			{
-				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 1.0f, 0.0f, 0.5f));
-			}
-			else
-			{
-				ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(1.0f, 0.0f, 0.0f, 0.5f));
-			}
-			if (ImGui::Toggle(installed_package.is_enabled ? "Enabled" : "Disabled", &installed_package.is_enabled, ImGuiToggleFlags_Animated))
-			{
-				for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
-				{
-					if (installed_package.pkg->full_name == enabled_state.full_name)
-					{
-						const auto manifest_file_path          = installed_package.folder / "manifest.json";
-						const auto manifest_disabled_file_path = installed_package.folder / "manifest_disabled.json";
-						if (std::filesystem::exists(manifest_file_path) && !std::filesystem::exists(manifest_disabled_file_path))
-						{
-							std::filesystem::rename(manifest_file_path, manifest_disabled_file_path);
-						}
-						else if (std::filesystem::exists(manifest_disabled_file_path) && !std::filesystem::exists(manifest_file_path))
-						{
-							std::filesystem::rename(manifest_disabled_file_path, manifest_file_path);
-						}
+			    render_package_icon(installed_package.has_icon_file, installed_package.icon_version_full_name);
+			    ImGui::SameLine();
+			    if (installed_package.is_local)
+			    {
+				    ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nVersion: %s%s",
+				                       installed_package.owner.c_str(),
+				                       installed_package.name.c_str(),
+				                       installed_package.description.c_str(),
+				                       installed_package.version_number.c_str(),
+				                       installed_package.is_local ? "\n\n(Local Package)" : "");
+			    }
+			    else
+			    {
+				    ImGui::TextWrapped("Author: %s\n\nName: %s\n\nDescription: %s\n\nLatest Version: %s%s",
+				                       installed_package.owner.c_str(),
+				                       installed_package.name.c_str(),
+				                       installed_package.description.c_str(),
+				                       installed_package.version_number.c_str(),
+				                       installed_package.is_local ? "\n\n(Local Package)" : "");
+			    }
 
-						enabled_state.is_enabled = installed_package.is_enabled;
-						s_app_cache.save();
+			    if (installed_package.is_local)
+			    {
+				    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+				    {
+					    ImGui::SetTooltip("Local package. Could not find it on the thunderstore website.");
+				    }
+			    }
 
-						break;
-					}
-				}
-			}
-			ImGui::PopStyleColor();
+			    ImGui::PushID((int)row);
 
-			if (ImGui::Button("Open Folder"))
-			{
-				ShellExecuteW(NULL, NULL, L"explorer.exe", installed_package.folder.c_str(), NULL, SW_NORMAL);
-			}
-			if (installed_package.pkg->is_installed)
-			{
-				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 0.0f, 0.0f, 0.75f));
-				if (ImGui::Button(std::format("Uninstall {}", installed_package.pkg->installed_version_number).c_str(), ImVec2(200, 0)))
-				{
-					uninstall(installed_package.pkg);
-				}
-				ImGui::PopStyleColor();
-			}
+			    if (installed_package.is_enabled)
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 1.0f, 0.0f, 0.5f));
+			    }
+			    else
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(1.0f, 0.0f, 0.0f, 0.5f));
+			    }
+			    if (ImGui::Toggle(installed_package.is_enabled ? "Enabled" : "Disabled", &installed_package.is_enabled, ImGuiToggleFlags_Animated))
+			    {
+				    bool has_enabled_entry = false;
+				    {
+					    std::unique_lock enabled_states_lock(package_enabled_states_mutex);
+					    for (auto& enabled_state : s_app_cache.active_profile->package_enabled_states)
+					    {
+						    if (installed_package.package_full_name == enabled_state.full_name)
+						    {
+							    enabled_state.is_enabled = installed_package.is_enabled;
+							    has_enabled_entry        = true;
+							    break;
+						    }
+					    }
+				    }
+
+				    if (has_enabled_entry)
+				    {
+					    const auto manifest_file_path          = installed_package.folder / "manifest.json";
+					    const auto manifest_disabled_file_path = installed_package.folder / "manifest_disabled.json";
+					    if (std::filesystem::exists(manifest_file_path) && !std::filesystem::exists(manifest_disabled_file_path))
+					    {
+						    std::filesystem::rename(manifest_file_path, manifest_disabled_file_path);
+					    }
+					    else if (std::filesystem::exists(manifest_disabled_file_path) && !std::filesystem::exists(manifest_file_path))
+					    {
+						    std::filesystem::rename(manifest_disabled_file_path, manifest_file_path);
+					    }
+
+					    s_app_cache.save();
+
+					    set_installed_package_enabled(installed_package.folder, installed_package.is_enabled);
+				    }
+			    }
+			    ImGui::PopStyleColor();
+
+			    if (ImGui::Button("Open Folder"))
+			    {
+				    ShellExecuteW(NULL, NULL, L"explorer.exe", installed_package.folder.c_str(), NULL, SW_NORMAL);
+			    }
+			    if (installed_package.is_installed)
+			    {
+				    ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(1.0f, 0.0f, 0.0f, 0.75f));
+				    if (ImGui::Button(std::format("Uninstall {}", installed_package.installed_version_number).c_str(), ImVec2(200, 0)))
+				    {
+					    uninstall(installed_package.package_full_name);
+				    }
+				    ImGui::PopStyleColor();
+			    }
 
-			ImGui::PopID();
+			    ImGui::PopID();
 
-			ImGui::Separator();
+			    ImGui::Separator();
 
-			ImGui::EndChild();
+			    ImGui::EndChild();
 
-			ImGui::PopStyleColor();
+			    ImGui::PopStyleColor();
 
-			i++;
-		}
+			    return true;
+		    });
 	}
 	else
 	{
@@ -1501,6 +2294,8 @@ void gui::render()
 	// 	ImGui::ShowDemoWindow(&m_show_demo_window);
 	// }
 
+	get_icon_cache().begin_frame();
+
 	render_docking_layout();
 
 	render_main_menu_bar();
@@ -0,0 +1,67 @@
+#include "virtual_list.hpp"
+
+#include <algorithm>
+
+namespace imm::ui
+{
+	virtual_list::virtual_list(float estimated_height) :
+	    m_estimated_height(estimated_height)
+	{
+		m_offsets.push_back(0.0f);
+	}
+
+	void virtual_list::rebuild_heights()
+	{
+		m_heights.resize(m_keys.size());
+		for (size_t i = 0; i < m_keys.size(); i++)
+		{
+			const auto it = m_measured_heights.find(m_keys[i]);
+			m_heights[i]  = it != m_measured_heights.end() ? it->second : m_estimated_height;
+		}
+
+		m_offsets.resize(m_keys.size() + 1);
+		m_dirty_from = 0;
+	}
+
+	void virtual_list::update_offsets()
+	{
+		for (size_t i = m_dirty_from; i < m_heights.size(); i++)
+		{
+			m_offsets[i + 1] = m_offsets[i] + m_heights[i];
+		}
+		m_dirty_from = m_heights.size();
+	}
+
+	std::pair<size_t, size_t> virtual_list::visible_range()
+	{
+		const float width = ImGui::GetContentRegionAvail().x;
+		if (width != m_layout_width)
+		{
+			// Wrapped text changes height with the width, start measuring again.
+			m_layout_width = width;
+			m_measured_heights.clear();
+			rebuild_heights();
+		}
+
+		update_offsets();
+
+		const float visible_top = ImGui::GetScrollY() - ImGui::GetCursorPosY();
+		const float visible_end = visible_top + ImGui::GetWindowHeight();
+
+		const size_t first = first_row_at(visible_top);
+		size_t last        = first;
+		while (last < m_keys.size() && m_offsets[last] < visible_end)
+		{
+			last++;
+		}
+
+		return {first, last};
+	}
+
+	size_t virtual_list::first_row_at(float y) const
+	{
+		// Last row whose top is at or above y.
+		const auto it = std::upper_bound(m_offsets.begin(), m_offsets.end() - 1, y);
+		return it == m_offsets.begin() ? 0 : (size_t)(it - m_offsets.begin()) - 1;
+	}
+} // namespace imm::ui
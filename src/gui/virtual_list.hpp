@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <imgui.h>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace imm::ui
+{
+	// Vertical list that only lays out the rows intersecting the current window's visible region.
+	// ImGuiListClipper assumes every row has the same height, ours wrap text and expand so instead
+	// each row height is measured the last time it was drawn, keyed by the item so it survives
+	// filtering and sorting, and the row positions are prefix sums of those heights.
+	// Rows never drawn yet use the estimate.
+	class virtual_list
+	{
+		float m_estimated_height;
+		float m_layout_width = -1.0f;
+
+		std::vector<const void*> m_keys;
+		std::unordered_map<const void*, float> m_measured_heights;
+		std::vector<float> m_heights;
+		// m_offsets[i] is the top of row i relative to the list start, m_offsets.back() the total height.
+		std::vector<float> m_offsets;
+		size_t m_dirty_from = 0;
+
+		void rebuild_heights();
+		void update_offsets();
+		size_t first_row_at(float y) const;
+
+	public:
+		explicit virtual_list(float estimated_height);
+
+		// Cheap when the items didn't change since the last call.
+		template<typename T>
+		void set_items(const std::vector<T*>& items)
+		{
+			if (std::equal(items.begin(), items.end(), m_keys.begin(), m_keys.end()))
+			{
+				return;
+			}
+
+			m_keys.assign(items.begin(), items.end());
+			rebuild_heights();
+		}
+
+		// Rows [first, last) render() is going to draw if called at the current cursor position,
+		// for callers that have to copy the row data out of a lock first.
+		std::pair<size_t, size_t> visible_range();
+
+		// Draws the visible rows at the current cursor position, render_row(i) has to submit row i.
+		// render_row may return false to stop early, the remaining rows keep their previous height.
+		template<typename F>
+		void render(F&& render_row)
+		{
+			const float list_top = ImGui::GetCursorPosY();
+			const size_t first   = visible_range().first;
+
+			// Rows are placed from the measured heights as they are drawn, a row taller or shorter
+			// than its estimate moves the following ones in the same frame.
+			const float visible_end = ImGui::GetScrollY() - list_top + ImGui::GetWindowHeight();
+			const auto row_count    = m_keys.size();
+			size_t row              = first;
+			float row_offset        = m_offsets[row];
+			for (; row < row_count && row_offset < visible_end; row++)
+			{
+				const float row_top = list_top + row_offset;
+				ImGui::SetCursorPosY(row_top);
+
+				if constexpr (std::is_same_v<decltype(render_row(row)), bool>)
+				{
+					if (!render_row(row))
+					{
+						break;
+					}
+				}
+				else
+				{
+					render_row(row);
+				}
+
+				const float height = ImGui::GetCursorPosY() - row_top;
+				if (height != m_heights[row])
+				{
+					m_heights[row]                  = height;
+					m_measured_heights[m_keys[row]] = height;
+					m_dirty_from                    = std::min(m_dirty_from, row);
+				}
+				row_offset += height;
+			}
+
+			// Reserve the space of the rows below so the scrollbar covers the whole list.
+			update_offsets();
+			const float remaining = list_top + m_offsets.back() - ImGui::GetCursorPosY();
+			if (remaining > 0.0f)
+			{
+				ImGui::Dummy(ImVec2(1.0f, remaining));
+			}
+		}
+	};
+} // namespace imm::ui
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace imm::hash
+{
+	inline constexpr uint64_t fnv1a_64_offset_basis = 0xcbf29ce484222325ull;
+	inline constexpr uint64_t fnv1a_64_prime        = 0x100000001b3ull;
+
+	// Not cryptographic, only used to key caches by content.
+	inline uint64_t fnv1a_64(const void* data, size_t size, uint64_t hash = fnv1a_64_offset_basis)
+	{
+		const auto* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= fnv1a_64_prime;
+		}
+		return hash;
+	}
+
+	inline uint64_t fnv1a_64(std::string_view str, uint64_t hash = fnv1a_64_offset_basis)
+	{
+		return fnv1a_64(str.data(), str.size(), hash);
+	}
+
+	inline std::string to_hex(uint64_t hash)
+	{
+		static constexpr char digits[] = "0123456789abcdef";
+
+		std::string result(16, '0');
+		for (int i = 15; i >= 0; i--, hash >>= 4)
+		{
+			result[i] = digits[hash & 0xf];
+		}
+		return result;
+	}
+} // namespace imm::hash
@@ -0,0 +1,168 @@
+#include "atlas_packer.hpp"
+
+namespace imm::icons
+{
+	atlas_packer::atlas_packer(uint32_t page_size, uint32_t cell_size, uint32_t max_pages) :
+	    m_page_size(page_size),
+	    m_cell_size(cell_size),
+	    m_cells_per_row(page_size / cell_size),
+	    m_cells_per_page(m_cells_per_row * m_cells_per_row),
+	    m_max_pages(max_pages ? max_pages : 1)
+	{
+	}
+
+	atlas_slot atlas_packer::slot_of(uint32_t cell_index) const
+	{
+		const auto in_page = cell_index % m_cells_per_page;
+		return {.page = cell_index / m_cells_per_page, .x = (in_page % m_cells_per_row) * m_cell_size, .y = (in_page / m_cells_per_row) * m_cell_size};
+	}
+
+	void atlas_packer::add_page()
+	{
+		const auto first = (uint32_t)m_cells.size();
+		m_cells.resize(m_cells.size() + m_cells_per_page);
+		for (uint32_t i = first; i < m_cells.size(); i++)
+		{
+			m_free_cells.insert(i);
+		}
+	}
+
+	std::optional<atlas_slot> atlas_packer::find(uint64_t id) const
+	{
+		const auto it = m_id_to_cell.find(id);
+		if (it == m_id_to_cell.end())
+		{
+			return std::nullopt;
+		}
+
+		return slot_of(it->second);
+	}
+
+	void atlas_packer::touch(uint64_t id, uint64_t frame)
+	{
+		const auto it = m_id_to_cell.find(id);
+		if (it != m_id_to_cell.end())
+		{
+			m_cells[it->second].last_used_frame = frame;
+		}
+	}
+
+	std::optional<atlas_slot> atlas_packer::allocate(uint64_t id, uint64_t frame, uint64_t min_protected_frame, std::optional<uint64_t>& evicted_id)
+	{
+		evicted_id.reset();
+
+		if (const auto existing = find(id))
+		{
+			touch(id, frame);
+			return existing;
+		}
+
+		if (m_free_cells.empty() && page_count() < m_max_pages)
+		{
+			add_page();
+		}
+
+		uint32_t cell_index = 0;
+		if (m_free_cells.size())
+		{
+			cell_index = *m_free_cells.begin();
+			m_free_cells.erase(m_free_cells.begin());
+		}
+		else
+		{
+			std::optional<uint32_t> lru_cell;
+			for (uint32_t i = 0; i < m_cells.size(); i++)
+			{
+				const auto& c = m_cells[i];
+				if (c.used && c.last_used_frame < min_protected_frame && (!lru_cell || c.last_used_frame < m_cells[*lru_cell].last_used_frame))
+				{
+					lru_cell = i;
+				}
+			}
+
+			if (!lru_cell)
+			{
+				return std::nullopt;
+			}
+
+			cell_index = *lru_cell;
+			evicted_id = m_cells[cell_index].id;
+			m_id_to_cell.erase(m_cells[cell_index].id);
+		}
+
+		m_cells[cell_index] = {.id = id, .last_used_frame = frame, .used = true};
+		m_id_to_cell[id]    = cell_index;
+		return slot_of(cell_index);
+	}
+
+	void atlas_packer::release(uint64_t id)
+	{
+		const auto it = m_id_to_cell.find(id);
+		if (it == m_id_to_cell.end())
+		{
+			return;
+		}
+
+		m_cells[it->second] = {};
+		m_free_cells.insert(it->second);
+		m_id_to_cell.erase(it);
+	}
+
+	std::vector<uint64_t> atlas_packer::release_unused(uint64_t min_used_frame)
+	{
+		std::vector<uint64_t> released;
+		for (uint32_t i = 0; i < m_cells.size(); i++)
+		{
+			auto& c = m_cells[i];
+			if (c.used && c.last_used_frame < min_used_frame)
+			{
+				released.push_back(c.id);
+				m_id_to_cell.erase(c.id);
+				m_free_cells.insert(i);
+				c = {};
+			}
+		}
+		return released;
+	}
+
+	std::vector<atlas_move> atlas_packer::repack()
+	{
+		std::vector<atlas_move> moves;
+
+		auto highest_used = (int64_t)m_cells.size() - 1;
+		while (m_free_cells.size())
+		{
+			while (highest_used >= 0 && !m_cells[highest_used].used)
+			{
+				highest_used--;
+			}
+
+			const auto lowest_free = *m_free_cells.begin();
+			if (highest_used < 0 || lowest_free > highest_used)
+			{
+				break;
+			}
+
+			auto& from = m_cells[highest_used];
+			moves.push_back({.id = from.id, .from = slot_of((uint32_t)highest_used), .to = slot_of(lowest_free)});
+
+			m_cells[lowest_free]  = from;
+			m_id_to_cell[from.id] = lowest_free;
+			m_free_cells.erase(m_free_cells.begin());
+
+			from = {};
+			m_free_cells.insert((uint32_t)highest_used);
+		}
+
+		// Drop trailing pages that ended up empty.
+		const auto used_cells   = (uint32_t)m_id_to_cell.size();
+		const auto pages_needed = (used_cells + m_cells_per_page - 1) / m_cells_per_page;
+		if (pages_needed < page_count())
+		{
+			m_cells.resize((size_t)pages_needed * m_cells_per_page);
+			m_free_cells.erase(m_free_cells.lower_bound((uint32_t)m_cells.size()), m_free_cells.end());
+		}
+
+		return moves;
+	}
+} // namespace imm::icons
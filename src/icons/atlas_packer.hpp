@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace imm::icons
+{
+	struct atlas_slot
+	{
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	struct atlas_move
+	{
+		uint64_t id;
+		atlas_slot from;
+		atlas_slot to;
+	};
+
+	// Bytes of a square RGBA8 page along with its mip chain, which is what a page costs against a budget.
+	constexpr uint64_t atlas_page_bytes(uint32_t page_size, uint32_t mip_levels)
+	{
+		uint64_t bytes = 0;
+		for (uint32_t level = 0; level < mip_levels && (page_size >> level); level++)
+		{
+			bytes += (uint64_t)(page_size >> level) * (page_size >> level) * 4;
+		}
+		return bytes;
+	}
+
+	// Book-keeping for a set of square atlas pages split into fixed size cells.
+	// Knows nothing about textures, so the allocation / eviction / repacking policy can be driven headless.
+	class atlas_packer
+	{
+		struct cell
+		{
+			uint64_t id              = 0;
+			uint64_t last_used_frame = 0;
+			bool used                = false;
+		};
+
+		uint32_t m_page_size;
+		uint32_t m_cell_size;
+		uint32_t m_cells_per_row;
+		uint32_t m_cells_per_page;
+		uint32_t m_max_pages;
+
+		std::vector<cell> m_cells;
+		// Lowest index first, so new icons fill the first pages and the last ones can be released.
+		std::set<uint32_t> m_free_cells;
+		std::unordered_map<uint64_t, uint32_t> m_id_to_cell;
+
+		atlas_slot slot_of(uint32_t cell_index) const;
+		void add_page();
+
+	public:
+		atlas_packer(uint32_t page_size, uint32_t cell_size, uint32_t max_pages);
+
+		uint32_t page_size() const
+		{
+			return m_page_size;
+		}
+
+		uint32_t cell_size() const
+		{
+			return m_cell_size;
+		}
+
+		uint32_t page_count() const
+		{
+			return (uint32_t)(m_cells.size() / m_cells_per_page);
+		}
+
+		size_t used_cell_count() const
+		{
+			return m_id_to_cell.size();
+		}
+
+		std::optional<atlas_slot> find(uint64_t id) const;
+
+		void touch(uint64_t id, uint64_t frame);
+
+		// Finds room for id, growing up to max_pages and then evicting the least recently used cell
+		// that was not used at or after min_protected_frame. evicted_id is set when something had to go.
+		std::optional<atlas_slot> allocate(uint64_t id, uint64_t frame, uint64_t min_protected_frame, std::optional<uint64_t>& evicted_id);
+
+		void release(uint64_t id);
+
+		// Releases every cell last used before min_used_frame and returns their ids.
+		// Eviction in allocate reuses the cell in place, this is what leaves the holes repack() fills.
+		std::vector<uint64_t> release_unused(uint64_t min_used_frame);
+
+		// Moves cells from the last pages into holes of the first ones and drops the pages left empty.
+		// The caller has to copy the pixels for every returned move, in order.
+		std::vector<atlas_move> repack();
+	};
+} // namespace imm::icons
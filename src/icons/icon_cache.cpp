@@ -0,0 +1,330 @@
+#include "icon_cache.hpp"
+
+#include "hash/fnv1a.hpp"
+
+#include <fstream>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace imm::icons
+{
+	namespace
+	{
+		ID3D11Texture2D* create_texture(ID3D11Device* device, uint32_t width, uint32_t height, uint32_t mip_levels)
+		{
+			D3D11_TEXTURE2D_DESC desc;
+			ZeroMemory(&desc, sizeof(desc));
+			desc.Width            = width;
+			desc.Height           = height;
+			desc.MipLevels        = mip_levels;
+			desc.ArraySize        = 1;
+			desc.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
+			desc.SampleDesc.Count = 1;
+			desc.Usage            = D3D11_USAGE_DEFAULT;
+			desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+			desc.CPUAccessFlags   = 0;
+
+			ID3D11Texture2D* texture = nullptr;
+			if (FAILED(device->CreateTexture2D(&desc, nullptr, &texture)))
+			{
+				return nullptr;
+			}
+
+			return texture;
+		}
+	} // namespace
+
+	icon_cache::icon_cache(ID3D11Device* device, size_t budget_bytes, const std::filesystem::path& thumbnails_folder) :
+	    m_thumbnails(thumbnails_folder),
+	    m_device(device),
+	    m_packer(page_size, cell_size, (uint32_t)(budget_bytes / atlas_page_bytes(page_size, mip_levels)))
+	{
+		m_device->GetImmediateContext(&m_device_context);
+		m_scratch_cell = create_texture(m_device, cell_size, cell_size, mip_levels);
+
+		m_worker = std::thread(&icon_cache::worker_loop, this);
+	}
+
+	icon_cache::~icon_cache()
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_stopping = true;
+		}
+		m_cv.notify_all();
+		m_worker.join();
+
+		for (auto& p : m_pages)
+		{
+			p.srv->Release();
+			p.texture->Release();
+		}
+		if (m_scratch_cell)
+		{
+			m_scratch_cell->Release();
+		}
+		m_device_context->Release();
+	}
+
+	bool icon_cache::create_page()
+	{
+		page p{};
+		p.texture = create_texture(m_device, page_size, page_size, mip_levels);
+		if (!p.texture)
+		{
+			return false;
+		}
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+		ZeroMemory(&srvDesc, sizeof(srvDesc));
+		srvDesc.Format                    = DXGI_FORMAT_R8G8B8A8_UNORM;
+		srvDesc.ViewDimension             = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels       = mip_levels;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		if (FAILED(m_device->CreateShaderResourceView(p.texture, &srvDesc, &p.srv)))
+		{
+			p.texture->Release();
+			return false;
+		}
+
+		m_pages.push_back(p);
+		return true;
+	}
+
+	void icon_cache::erase_entry(uint64_t id)
+	{
+		const auto it = m_id_to_key.find(id);
+		if (it != m_id_to_key.end())
+		{
+			m_entries.erase(it->second);
+			m_id_to_key.erase(it);
+		}
+	}
+
+	void icon_cache::begin_frame()
+	{
+		std::unique_lock lock(m_mutex);
+		m_frame++;
+
+		upload_pending();
+		release_idle();
+		repack_if_sparse();
+	}
+
+	void icon_cache::release_idle()
+	{
+		if (m_frame <= idle_frames_before_release)
+		{
+			return;
+		}
+
+		// Dropped entirely, drawing it again requests a new decode (from the thumbnail cache).
+		for (const auto id : m_packer.release_unused(m_frame - idle_frames_before_release))
+		{
+			erase_entry(id);
+		}
+	}
+
+	void icon_cache::upload_pending()
+	{
+		size_t uploaded = 0;
+		while (m_pending_uploads.size() && uploaded < max_uploads_per_frame)
+		{
+			auto it = m_entries.find(m_pending_uploads.back());
+			if (it == m_entries.end() || it->second.state != entry_state::decoded)
+			{
+				m_pending_uploads.pop_back();
+				continue;
+			}
+
+			auto& e = it->second;
+
+			// Icons drawn in the previous frame are very likely still on screen, keep them.
+			std::optional<uint64_t> evicted_id;
+			const auto slot = m_packer.allocate(e.id, e.last_used_frame, m_frame - 1, evicted_id);
+			if (!slot)
+			{
+				break;
+			}
+			if (evicted_id)
+			{
+				erase_entry(*evicted_id);
+			}
+
+			while (slot->page >= m_pages.size())
+			{
+				if (!create_page())
+				{
+					m_packer.release(e.id);
+					return;
+				}
+			}
+
+			// Cells are aligned on cell_size, so every mip of a cell is the cell shifted down.
+			for (uint32_t level = 0; level < e.mips.size(); level++)
+			{
+				const D3D11_BOX box{slot->x >> level, slot->y >> level, 0, (slot->x + cell_size) >> level, (slot->y + cell_size) >> level, 1};
+				m_device_context->UpdateSubresource(m_pages[slot->page].texture, level, &box, e.mips[level].pixels.data(), (cell_size >> level) * 4, 0);
+			}
+
+			e.state = entry_state::resident;
+			e.mips  = {};
+			m_pending_uploads.pop_back();
+			uploaded++;
+		}
+	}
+
+	void icon_cache::repack_if_sparse()
+	{
+		const size_t cells_per_page = (size_t)(page_size / cell_size) * (page_size / cell_size);
+		if (m_pages.size() < 2 || m_packer.used_cell_count() > (m_pages.size() - 1) * cells_per_page)
+		{
+			return;
+		}
+
+		// Same page moves would overlap source and destination resources, go through a scratch cell.
+		for (const auto& move : m_packer.repack())
+		{
+			for (uint32_t level = 0; level < mip_levels; level++)
+			{
+				const D3D11_BOX src_box{move.from.x >> level, move.from.y >> level, 0, (move.from.x + cell_size) >> level, (move.from.y + cell_size) >> level, 1};
+				m_device_context->CopySubresourceRegion(m_scratch_cell, level, 0, 0, 0, m_pages[move.from.page].texture, level, &src_box);
+				m_device_context->CopySubresourceRegion(m_pages[move.to.page].texture, level, move.to.x >> level, move.to.y >> level, 0, m_scratch_cell, level, nullptr);
+			}
+		}
+
+		while (m_pages.size() > m_packer.page_count())
+		{
+			m_pages.back().srv->Release();
+			m_pages.back().texture->Release();
+			m_pages.pop_back();
+		}
+	}
+
+	icon_handle icon_cache::get(const std::filesystem::path& path)
+	{
+		std::unique_lock lock(m_mutex);
+
+		auto [it, inserted] = m_entries.try_emplace(path.native());
+		auto& e             = it->second;
+		e.last_used_frame   = m_frame;
+		if (inserted)
+		{
+			e.id              = m_next_id++;
+			m_id_to_key[e.id] = path.native();
+			m_requests.push_back(path.native());
+			m_cv.notify_one();
+		}
+
+		if (e.state != entry_state::resident)
+		{
+			return {};
+		}
+
+		m_packer.touch(e.id, m_frame);
+		const auto slot = m_packer.find(e.id);
+		if (!slot || slot->page >= m_pages.size())
+		{
+			return {};
+		}
+
+		const float inv_page_size = 1.0f / page_size;
+		return {.texture = (ImTextureID)m_pages[slot->page].srv,
+		        .uv0     = ImVec2(slot->x * inv_page_size, slot->y * inv_page_size),
+		        .uv1     = ImVec2((slot->x + cell_size) * inv_page_size, (slot->y + cell_size) * inv_page_size)};
+	}
+
+	rgba_image icon_cache::load_icon(const std::filesystem::path& path) const
+	{
+		std::ifstream f(path, std::ios::binary);
+		const std::vector<char> file_data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+		if (file_data.empty())
+		{
+			return {};
+		}
+
+		// Hashing the PNG bytes is far cheaper than inflating them.
+		const auto source_hash = imm::hash::fnv1a_64(file_data.data(), file_data.size());
+		if (auto thumbnail = m_thumbnails.load(source_hash, cell_size, cell_size))
+		{
+			return std::move(*thumbnail);
+		}
+
+		int image_width           = 0;
+		int image_height          = 0;
+		unsigned char* image_data = stbi_load_from_memory((const stbi_uc*)file_data.data(), (int)file_data.size(), &image_width, &image_height, NULL, 4);
+		if (!image_data)
+		{
+			return {};
+		}
+
+		rgba_image decoded{.width = image_width, .height = image_height};
+		decoded.pixels.assign(image_data, image_data + (size_t)image_width * image_height * 4);
+		stbi_image_free(image_data);
+
+		auto image = resize_icon(std::move(decoded), cell_size, cell_size);
+
+		m_thumbnails.store(source_hash, image);
+		return image;
+	}
+
+	void icon_cache::worker_loop()
+	{
+		while (true)
+		{
+			key_type key;
+			{
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock,
+				          [this]
+				          {
+					          return m_stopping || m_requests.size();
+				          });
+
+				if (m_stopping)
+				{
+					return;
+				}
+
+				key = std::move(m_requests.back());
+				m_requests.pop_back();
+
+				auto it = m_entries.find(key);
+				if (it == m_entries.end() || it->second.state != entry_state::queued)
+				{
+					continue;
+				}
+
+				// Scrolled out of view before we got to it, it will be requested again if it comes back.
+				if (it->second.last_used_frame + 2 < m_frame)
+				{
+					m_id_to_key.erase(it->second.id);
+					m_entries.erase(it);
+					continue;
+				}
+
+				it->second.state = entry_state::decoding;
+			}
+
+			auto mips = build_mip_chain(load_icon(key), mip_levels);
+
+			std::unique_lock lock(m_mutex);
+			auto it = m_entries.find(key);
+			if (it == m_entries.end())
+			{
+				continue;
+			}
+
+			if (mips[0].pixels.size())
+			{
+				it->second.state = entry_state::decoded;
+				it->second.mips  = std::move(mips);
+				m_pending_uploads.push_back(key);
+			}
+			else
+			{
+				it->second.state = entry_state::failed;
+			}
+		}
+	}
+} // namespace imm::icons
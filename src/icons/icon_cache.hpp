@@ -0,0 +1,113 @@
+#pragma once
+
+#include "atlas_packer.hpp"
+#include "image.hpp"
+#include "thumbnail_cache.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <d3d11.h>
+#include <filesystem>
+#include <imgui.h>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace imm::icons
+{
+	struct icon_handle
+	{
+		ImTextureID texture = nullptr;
+		ImVec2 uv0{0.0f, 0.0f};
+		ImVec2 uv1{1.0f, 1.0f};
+
+		explicit operator bool() const
+		{
+			return texture != nullptr;
+		}
+	};
+
+	// Decodes icons on demand, only for rows that are actually on screen, and packs them into a few
+	// large atlas pages so a page of mods binds one texture instead of one per icon.
+	// The number of pages is bounded by a byte budget that counts their mip chains, the least recently drawn icons are evicted first.
+	class icon_cache
+	{
+		using key_type = std::filesystem::path::string_type;
+
+		static constexpr uint32_t page_size           = 2048;
+		static constexpr uint32_t cell_size           = 128;
+		static constexpr size_t max_uploads_per_frame = 16;
+		// 128 down to 16, so icons drawn smaller than a cell are minified with filtering.
+		static constexpr uint32_t mip_levels = 4;
+		// About 10 s at 60 fps. Icons not drawn for that long give their cell back, so pages can be repacked and freed.
+		static constexpr uint64_t idle_frames_before_release = 600;
+
+		enum class entry_state
+		{
+			queued,
+			decoding,
+			decoded,
+			resident,
+			failed,
+		};
+
+		struct entry
+		{
+			uint64_t id              = 0;
+			entry_state state        = entry_state::queued;
+			uint64_t last_used_frame = 0;
+			std::vector<rgba_image> mips;
+		};
+
+		struct page
+		{
+			ID3D11Texture2D* texture      = nullptr;
+			ID3D11ShaderResourceView* srv = nullptr;
+		};
+
+		thumbnail_cache m_thumbnails;
+
+		ID3D11Device* m_device;
+		ID3D11DeviceContext* m_device_context = nullptr;
+		ID3D11Texture2D* m_scratch_cell       = nullptr;
+		std::vector<page> m_pages;
+		atlas_packer m_packer;
+
+		uint64_t m_frame   = 1;
+		uint64_t m_next_id = 1;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::unordered_map<key_type, entry> m_entries;
+		std::unordered_map<uint64_t, key_type> m_id_to_key;
+		// Most recent request is served first, so whatever is on screen now wins over rows scrolled past.
+		std::vector<key_type> m_requests;
+		std::vector<key_type> m_pending_uploads;
+		bool m_stopping = false;
+		std::thread m_worker;
+
+		void worker_loop();
+		bool create_page();
+		void upload_pending();
+		void release_idle();
+		void repack_if_sparse();
+		void erase_entry(uint64_t id);
+		rgba_image load_icon(const std::filesystem::path& path) const;
+
+	public:
+		// Downscaled copies of the icons are kept in thumbnails_folder so warm starts skip PNG decoding.
+		icon_cache(ID3D11Device* device, size_t budget_bytes, const std::filesystem::path& thumbnails_folder);
+		~icon_cache();
+
+		icon_cache(const icon_cache&)            = delete;
+		icon_cache& operator=(const icon_cache&) = delete;
+
+		// Call once per frame, before any get(). Uploads decoded icons, releases idle ones and repacks atlas cells,
+		// everything touched here was last drawn in a frame that is already presented.
+		void begin_frame();
+
+		// Empty handle until the icon is decoded and in the atlas, the request is queued on first call.
+		icon_handle get(const std::filesystem::path& path);
+	};
+} // namespace imm::icons
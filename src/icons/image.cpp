@@ -0,0 +1,225 @@
+#include "image.hpp"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace imm::icons
+{
+	rgba_image resize_rgba(const uint8_t* src, int src_width, int src_height, int dst_width, int dst_height)
+	{
+		rgba_image dst{.width = dst_width, .height = dst_height};
+		dst.pixels.resize((size_t)dst_width * dst_height * 4);
+
+		for (int y = 0; y < dst_height; y++)
+		{
+			const int src_y0 = (int)((int64_t)y * src_height / dst_height);
+			const int src_y1 = std::max(src_y0 + 1, (int)((int64_t)(y + 1) * src_height / dst_height));
+
+			for (int x = 0; x < dst_width; x++)
+			{
+				const int src_x0 = (int)((int64_t)x * src_width / dst_width);
+				const int src_x1 = std::max(src_x0 + 1, (int)((int64_t)(x + 1) * src_width / dst_width));
+
+				uint32_t sum[4] = {};
+				for (int sy = src_y0; sy < src_y1; sy++)
+				{
+					const uint8_t* row = src + ((size_t)sy * src_width + src_x0) * 4;
+					for (int sx = src_x0; sx < src_x1; sx++, row += 4)
+					{
+						sum[0] += row[0];
+						sum[1] += row[1];
+						sum[2] += row[2];
+						sum[3] += row[3];
+					}
+				}
+
+				const uint32_t count = (uint32_t)((src_y1 - src_y0) * (src_x1 - src_x0));
+				uint8_t* out         = dst.pixels.data() + ((size_t)y * dst_width + x) * 4;
+				for (int c = 0; c < 4; c++)
+				{
+					out[c] = (uint8_t)((sum[c] + count / 2) / count);
+				}
+			}
+		}
+
+		return dst;
+	}
+
+	namespace reference
+	{
+		void premultiply_alpha(rgba_image& image)
+		{
+			uint8_t* p = image.pixels.data();
+			for (size_t i = 0; i < image.pixels.size(); i += 4)
+			{
+				const uint32_t a = p[i + 3];
+				p[i + 0]         = (uint8_t)((p[i + 0] * a + 127) / 255);
+				p[i + 1]         = (uint8_t)((p[i + 1] * a + 127) / 255);
+				p[i + 2]         = (uint8_t)((p[i + 2] * a + 127) / 255);
+			}
+		}
+
+		rgba_image downsample_2x(const rgba_image& image)
+		{
+			rgba_image dst{.width = image.width / 2, .height = image.height / 2};
+			dst.pixels.resize((size_t)dst.width * dst.height * 4);
+
+			const size_t src_stride = (size_t)image.width * 4;
+			for (int y = 0; y < dst.height; y++)
+			{
+				const uint8_t* row0 = image.pixels.data() + (size_t)y * 2 * src_stride;
+				const uint8_t* row1 = row0 + src_stride;
+				uint8_t* out        = dst.pixels.data() + (size_t)y * dst.width * 4;
+				for (int x = 0; x < dst.width * 4; x++)
+				{
+					const int src_x = (x / 4) * 8 + x % 4;
+					out[x]          = (uint8_t)((row0[src_x] + row0[src_x + 4] + row1[src_x] + row1[src_x + 4] + 2) / 4);
+				}
+			}
+
+			return dst;
+		}
+	} // namespace reference
+
+	void premultiply_alpha(rgba_image& image)
+	{
+		uint8_t* p         = image.pixels.data();
+		const size_t size  = image.pixels.size();
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		// Keeps alpha as is: its lanes are multiplied by 255 instead of a, which divides back exactly.
+		const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+		const __m128i alpha_one   = _mm_and_si128(alpha_lanes, _mm_set1_epi16(255));
+
+		size_t i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i px = _mm_loadu_si128((const __m128i*)(p + i));
+
+			__m128i halves[2] = {_mm_unpacklo_epi8(px, zero), _mm_unpackhi_epi8(px, zero)};
+			for (auto& h : halves)
+			{
+				// Broadcast each pixel's alpha to its 4 lanes.
+				__m128i a = _mm_shufflelo_epi16(h, _MM_SHUFFLE(3, 3, 3, 3));
+				a         = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+				a         = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), alpha_one);
+
+				// (x + 128 + ((x + 128) >> 8)) >> 8 == (x + 127) / 255 for x in [0, 255 * 255].
+				__m128i x = _mm_add_epi16(_mm_mullo_epi16(h, a), bias);
+				h         = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+			}
+
+			_mm_storeu_si128((__m128i*)(p + i), _mm_packus_epi16(halves[0], halves[1]));
+		}
+
+		for (; i < size; i += 4)
+		{
+			const uint32_t a = p[i + 3];
+			p[i + 0]         = (uint8_t)((p[i + 0] * a + 127) / 255);
+			p[i + 1]         = (uint8_t)((p[i + 1] * a + 127) / 255);
+			p[i + 2]         = (uint8_t)((p[i + 2] * a + 127) / 255);
+		}
+	}
+
+	void unpremultiply_alpha(rgba_image& image)
+	{
+		uint8_t* p = image.pixels.data();
+		for (size_t i = 0; i < image.pixels.size(); i += 4)
+		{
+			const uint32_t a = p[i + 3];
+			if (a == 0)
+			{
+				p[i + 0] = p[i + 1] = p[i + 2] = 0;
+				continue;
+			}
+
+			p[i + 0] = (uint8_t)std::min<uint32_t>(255, (p[i + 0] * 255 + a / 2) / a);
+			p[i + 1] = (uint8_t)std::min<uint32_t>(255, (p[i + 1] * 255 + a / 2) / a);
+			p[i + 2] = (uint8_t)std::min<uint32_t>(255, (p[i + 2] * 255 + a / 2) / a);
+		}
+	}
+
+	rgba_image downsample_2x(const rgba_image& image)
+	{
+		rgba_image dst{.width = image.width / 2, .height = image.height / 2};
+		dst.pixels.resize((size_t)dst.width * dst.height * 4);
+
+		const size_t src_stride = (size_t)image.width * 4;
+		const size_t dst_size   = (size_t)dst.width * 4;
+		const __m128i zero      = _mm_setzero_si128();
+		const __m128i two       = _mm_set1_epi16(2);
+
+		for (int y = 0; y < dst.height; y++)
+		{
+			const uint8_t* row0 = image.pixels.data() + (size_t)y * 2 * src_stride;
+			const uint8_t* row1 = row0 + src_stride;
+			uint8_t* out        = dst.pixels.data() + (size_t)y * dst_size;
+
+			// 4 source pixels of each row per iteration, giving 2 destination pixels.
+			size_t x = 0;
+			for (; x + 8 <= dst_size; x += 8)
+			{
+				const __m128i a = _mm_loadu_si128((const __m128i*)(row0 + x * 2));
+				const __m128i b = _mm_loadu_si128((const __m128i*)(row1 + x * 2));
+
+				const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+				// Add horizontally adjacent pixels: lanes 0-3 with 4-7 of each half.
+				const __m128i sum_lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+				const __m128i sum_hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+				__m128i sum          = _mm_unpacklo_epi64(sum_lo, sum_hi);
+				sum                  = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+
+				_mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(sum, zero));
+			}
+
+			for (; x < dst_size; x++)
+			{
+				const size_t src_x = (x / 4) * 8 + x % 4;
+				out[x]             = (uint8_t)((row0[src_x] + row0[src_x + 4] + row1[src_x] + row1[src_x + 4] + 2) / 4);
+			}
+		}
+
+		return dst;
+	}
+
+	rgba_image resize_icon(rgba_image image, int dst_width, int dst_height)
+	{
+		premultiply_alpha(image);
+
+		while (image.width >= dst_width * 2 && image.height >= dst_height * 2)
+		{
+			image = downsample_2x(image);
+		}
+
+		if (image.width != dst_width || image.height != dst_height)
+		{
+			image = resize_rgba(image.pixels.data(), image.width, image.height, dst_width, dst_height);
+		}
+
+		unpremultiply_alpha(image);
+		return image;
+	}
+
+	std::vector<rgba_image> build_mip_chain(rgba_image image, int level_count)
+	{
+		std::vector<rgba_image> levels;
+		levels.reserve(level_count);
+
+		rgba_image premultiplied = image;
+		premultiply_alpha(premultiplied);
+		levels.push_back(std::move(image));
+
+		for (int i = 1; i < level_count && premultiplied.width > 1 && premultiplied.height > 1; i++)
+		{
+			premultiplied = downsample_2x(premultiplied);
+
+			rgba_image level = premultiplied;
+			unpremultiply_alpha(level);
+			levels.push_back(std::move(level));
+		}
+
+		return levels;
+	}
+} // namespace imm::icons
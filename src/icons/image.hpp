@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace imm::icons
+{
+	struct rgba_image
+	{
+		int width  = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	// Box filter resample of a tightly packed RGBA8 image, every destination pixel averages
+	// the source pixels it covers (at least one, so upscaling degrades to nearest).
+	rgba_image resize_rgba(const uint8_t* src, int src_width, int src_height, int dst_width, int dst_height);
+
+	// c = round(c * a / 255), SSE2.
+	void premultiply_alpha(rgba_image& image);
+
+	// Inverse of premultiply_alpha, fully transparent pixels end up black.
+	void unpremultiply_alpha(rgba_image& image);
+
+	// Averages 2x2 blocks with rounding, SSE2. Odd trailing rows / columns are dropped.
+	rgba_image downsample_2x(const rgba_image& image);
+
+	// Scales a straight alpha image to dst_width x dst_height. Filtering happens on premultiplied
+	// pixels so the color of transparent pixels doesn't bleed into the edges, halving with
+	// downsample_2x while possible and finishing with resize_rgba.
+	rgba_image resize_icon(rgba_image image, int dst_width, int dst_height);
+
+	// Level 0 is image itself, every following level is half the size of the previous one.
+	std::vector<rgba_image> build_mip_chain(rgba_image image, int level_count);
+
+	// Plain scalar versions of the SIMD kernels, the SIMD ones have to match them bit for bit.
+	namespace reference
+	{
+		void premultiply_alpha(rgba_image& image);
+
+		rgba_image downsample_2x(const rgba_image& image);
+	} // namespace reference
+} // namespace imm::icons
@@ -0,0 +1,72 @@
+#include "thumbnail_cache.hpp"
+
+#include "hash/fnv1a.hpp"
+
+#include <fstream>
+
+namespace imm::icons
+{
+	thumbnail_cache::thumbnail_cache(std::filesystem::path folder) :
+	    m_folder(std::move(folder))
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_folder, ec);
+	}
+
+	std::filesystem::path thumbnail_cache::get_path(uint64_t source_hash, int width, int height) const
+	{
+		return m_folder / (imm::hash::to_hex(source_hash) + "_" + std::to_string(width) + "x" + std::to_string(height) + ".rgba");
+	}
+
+	std::optional<rgba_image> thumbnail_cache::load(uint64_t source_hash, int width, int height) const
+	{
+		std::ifstream f(get_path(source_hash, width, height), std::ios::binary);
+		if (!f)
+		{
+			return std::nullopt;
+		}
+
+		header hdr{};
+		if (!f.read((char*)&hdr, sizeof(hdr)) || hdr.magic != magic || hdr.version != version || hdr.source_hash != source_hash
+		    || hdr.width != (uint32_t)width || hdr.height != (uint32_t)height)
+		{
+			return std::nullopt;
+		}
+
+		rgba_image image{.width = width, .height = height};
+		image.pixels.resize((size_t)width * height * 4);
+		if (!f.read((char*)image.pixels.data(), image.pixels.size()))
+		{
+			return std::nullopt;
+		}
+
+		return image;
+	}
+
+	bool thumbnail_cache::store(uint64_t source_hash, const rgba_image& image) const
+	{
+		const header hdr{.magic = magic, .version = version, .width = (uint32_t)image.width, .height = (uint32_t)image.height, .source_hash = source_hash};
+
+		const auto path     = get_path(source_hash, image.width, image.height);
+		const auto tmp_path = std::filesystem::path(path).concat(".tmp");
+		{
+			std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+			f.write((const char*)&hdr, sizeof(hdr));
+			f.write((const char*)image.pixels.data(), image.pixels.size());
+			if (!f.flush())
+			{
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmp_path, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(tmp_path, ec);
+			return false;
+		}
+
+		return true;
+	}
+} // namespace imm::icons
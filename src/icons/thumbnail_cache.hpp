@@ -0,0 +1,41 @@
+#pragma once
+
+#include "image.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+namespace imm::icons
+{
+	// Icons already downscaled to display size, stored as raw RGBA next to the original PNGs.
+	// Files are named after the hash of the source PNG bytes, so an updated icon never hits a stale thumbnail.
+	//
+	// [magic "IMMT"][version][width][height][source hash][RGBA8 pixels]
+	class thumbnail_cache
+	{
+		static constexpr uint32_t magic   = 0x54'4D'4D'49; // "IMMT"
+		static constexpr uint32_t version = 2;
+
+		struct header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t width;
+			uint32_t height;
+			uint64_t source_hash;
+		};
+
+		std::filesystem::path m_folder;
+
+		std::filesystem::path get_path(uint64_t source_hash, int width, int height) const;
+
+	public:
+		explicit thumbnail_cache(std::filesystem::path folder);
+
+		// Only returns a thumbnail of exactly width x height made from a source with that hash.
+		std::optional<rgba_image> load(uint64_t source_hash, int width, int height) const;
+
+		bool store(uint64_t source_hash, const rgba_image& image) const;
+	};
+} // namespace imm::icons
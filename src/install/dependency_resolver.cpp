@@ -0,0 +1,228 @@
+#include "dependency_resolver.hpp"
+
+#include <unordered_map>
+
+namespace imm::install
+{
+	std::optional<dependency_string> parse_dependency(std::string_view dependency)
+	{
+		const auto version_separator = dependency.rfind('-');
+		if (version_separator == std::string_view::npos || version_separator == 0 || version_separator + 1 == dependency.size())
+		{
+			return std::nullopt;
+		}
+
+		return dependency_string{.package_full_name = dependency.substr(0, version_separator), .version_number = dependency.substr(version_separator + 1)};
+	}
+
+	namespace
+	{
+		struct requirement
+		{
+			semver::version minimum;
+			std::string required_by;
+		};
+
+		enum class node_state
+		{
+			visiting,
+			planned,
+			installed,
+			failed,
+		};
+
+		struct node
+		{
+			node_state state  = node_state::visiting;
+			size_t step_index = 0;
+			std::optional<semver::version> version;
+		};
+
+		class resolver
+		{
+			const resolver_catalog& m_catalog;
+			// Persists across rounds, minimums only ever go up so resolving reaches a fixed point.
+			std::unordered_map<std::string, requirement> m_requirements;
+			std::unordered_map<std::string, node> m_nodes;
+			install_plan m_plan;
+			bool m_restart = false;
+
+			static bool satisfies(const semver::version& version, const requirement& req)
+			{
+				return version.major == req.minimum.major && !(version < req.minimum);
+			}
+
+			// Newest version of pkg meeting req, versions are listed newest first in the catalog but that is not relied on.
+			static std::optional<size_t> select_version(const ts::v1::package& pkg, const requirement& req)
+			{
+				std::optional<size_t> best;
+				std::optional<semver::version> best_version;
+				for (size_t i = 0; i < pkg.versions.size(); i++)
+				{
+					const auto version = semver::from_string_noexcept(pkg.versions[i].version_number);
+					if (version && satisfies(*version, req) && (!best_version || *best_version < *version))
+					{
+						best         = i;
+						best_version = version;
+					}
+				}
+
+				return best;
+			}
+
+			void add_conflict(std::string text)
+			{
+				m_plan.conflicts.push_back(std::move(text));
+			}
+
+			// Returns false when the requirement can't be tightened without a conflict.
+			bool require(const std::string& package_full_name, const semver::version& minimum, const std::string& required_by)
+			{
+				auto [it, inserted] = m_requirements.try_emplace(package_full_name, requirement{.minimum = minimum, .required_by = required_by});
+				auto& req           = it->second;
+				if (!inserted)
+				{
+					if (req.minimum.major != minimum.major)
+					{
+						add_conflict(package_full_name + ": " + required_by + " needs " + minimum.to_string() + " but " + req.required_by + " needs "
+						             + req.minimum.to_string());
+						return false;
+					}
+
+					if (!(req.minimum < minimum))
+					{
+						return true;
+					}
+
+					req = {.minimum = minimum, .required_by = required_by};
+				}
+
+				// Already resolved this round with a version that may now be too old.
+				const auto node_it = m_nodes.find(package_full_name);
+				if (node_it != m_nodes.end() && node_it->second.version && !satisfies(*node_it->second.version, req))
+				{
+					if (node_it->second.state == node_state::installed)
+					{
+						m_restart = true;
+					}
+					else
+					{
+						add_conflict(package_full_name + ": " + required_by + " needs " + minimum.to_string() + " or newer, nothing compatible is available");
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			// Plans pkg->versions[version_index] after its dependencies and returns its step index.
+			std::optional<size_t> visit(const ts::v1::package& pkg, size_t version_index)
+			{
+				auto& n   = m_nodes[pkg.full_name];
+				n.state   = node_state::visiting;
+				n.version = semver::from_string_noexcept(pkg.versions[version_index].version_number);
+
+				std::vector<size_t> depends_on;
+				for (const auto& dependency : pkg.versions[version_index].dependencies)
+				{
+					if (const auto step_index = visit_dependency(pkg.versions[version_index].full_name, dependency))
+					{
+						depends_on.push_back(*step_index);
+					}
+				}
+
+				n.state      = node_state::planned;
+				n.step_index = m_plan.steps.size();
+				m_plan.steps.push_back({.pkg = &pkg, .version_index = version_index, .depends_on = std::move(depends_on)});
+				return n.step_index;
+			}
+
+			std::optional<size_t> visit_dependency(const std::string& dependent, std::string_view dependency)
+			{
+				const auto parsed  = parse_dependency(dependency);
+				const auto minimum = parsed ? semver::from_string_noexcept(parsed->version_number) : std::nullopt;
+				if (!minimum)
+				{
+					add_conflict(dependent + ": malformed dependency " + std::string(dependency));
+					return std::nullopt;
+				}
+
+				const std::string package_full_name(parsed->package_full_name);
+				if (!require(package_full_name, *minimum, dependent))
+				{
+					return std::nullopt;
+				}
+
+				if (const auto it = m_nodes.find(package_full_name); it != m_nodes.end())
+				{
+					// Planned already, or a cycle when still visiting, or failed and reported already.
+					if (it->second.state == node_state::planned)
+					{
+						return it->second.step_index;
+					}
+					return std::nullopt;
+				}
+
+				const auto& req = m_requirements.at(package_full_name);
+
+				if (const auto installed = m_catalog.installed_version(package_full_name))
+				{
+					const auto installed_version = semver::from_string_noexcept(*installed);
+					if (installed_version && satisfies(*installed_version, req))
+					{
+						m_nodes[package_full_name] = {.state = node_state::installed, .version = installed_version};
+						return std::nullopt;
+					}
+				}
+
+				const auto pkg = m_catalog.find_package(package_full_name);
+				if (!pkg)
+				{
+					m_nodes[package_full_name].state = node_state::failed;
+					add_conflict(package_full_name + ", needed by " + dependent + ", is not in the catalog");
+					return std::nullopt;
+				}
+
+				const auto version_index = select_version(*pkg, req);
+				if (!version_index)
+				{
+					m_nodes[package_full_name].state = node_state::failed;
+					add_conflict(package_full_name + ": no version compatible with " + req.minimum.to_string() + " needed by " + req.required_by);
+					return std::nullopt;
+				}
+
+				return visit(*pkg, *version_index);
+			}
+
+		public:
+			explicit resolver(const resolver_catalog& catalog) :
+			    m_catalog(catalog)
+			{
+			}
+
+			install_plan resolve(const ts::v1::package& root, size_t root_version_index)
+			{
+				do
+				{
+					m_restart = false;
+					m_nodes.clear();
+					m_plan = {};
+
+					visit(root, root_version_index);
+				} while (m_restart && m_plan.ok());
+
+				return std::move(m_plan);
+			}
+		};
+	} // namespace
+
+	install_plan resolve_install_plan(const ts::v1::package& root, size_t root_version_index, const resolver_catalog& catalog)
+	{
+		if (root_version_index >= root.versions.size())
+		{
+			return {.conflicts = {root.full_name + ": no such version"}};
+		}
+
+		return resolver(catalog).resolve(root, root_version_index);
+	}
+} // namespace imm::install
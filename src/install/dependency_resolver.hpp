@@ -0,0 +1,59 @@
+#pragma once
+
+#include "thunderstore/v1/package.hpp"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace imm::install
+{
+	// "Owner-Name-1.2.3" split at the last dash.
+	struct dependency_string
+	{
+		std::string_view package_full_name;
+		std::string_view version_number;
+	};
+
+	std::optional<dependency_string> parse_dependency(std::string_view dependency);
+
+	struct install_step
+	{
+		const ts::v1::package* pkg;
+		size_t version_index;
+		// Indices into install_plan::steps, always lower than the index of this step.
+		std::vector<size_t> depends_on;
+	};
+
+	struct install_plan
+	{
+		// Dependencies come before their dependents, the requested package is last.
+		std::vector<install_step> steps;
+		// Human readable, the plan should not be run when there is any.
+		std::vector<std::string> conflicts;
+
+		bool ok() const
+		{
+			return conflicts.empty();
+		}
+	};
+
+	// Where the resolver reads packages from, so it can run against a synthetic catalog.
+	struct resolver_catalog
+	{
+		// Package with the given "Owner-Name", nullptr when unknown.
+		std::function<const ts::v1::package*(std::string_view package_full_name)> find_package;
+		// Version number installed for the given "Owner-Name", if any.
+		std::function<std::optional<std::string>(std::string_view package_full_name)> installed_version;
+	};
+
+	// Walks the transitive dependencies of root->versions[root_version_index].
+	// A dependency on X-1.2.3 is read as X >= 1.2.3 with the same major version, the tightest requirement over
+	// all dependents wins and the newest catalog version meeting it is picked, unless the installed one already does.
+	// Requirements on different major versions, unknown packages and missing versions are reported as conflicts.
+	// Installed packages that satisfy their requirement are left out of the plan along with their own dependencies.
+	// Dependency cycles are broken at the edge that closes them.
+	install_plan resolve_install_plan(const ts::v1::package& root, size_t root_version_index, const resolver_catalog& catalog);
+} // namespace imm::install
@@ -0,0 +1,88 @@
+#include "linked_install.hpp"
+
+#include "platform/file_clone.hpp"
+
+namespace imm::install
+{
+	namespace
+	{
+		void add(clone_stats& total, const clone_stats& stats)
+		{
+			total.reflinked   += stats.reflinked;
+			total.hard_linked += stats.hard_linked;
+			total.copied      += stats.copied;
+			total.failed      += stats.failed;
+		}
+	} // namespace
+
+	clone_stats clone_tree(const std::filesystem::path& from, const std::filesystem::path& to, bool allow_hard_link)
+	{
+		clone_stats stats;
+
+		std::error_code ec;
+		std::filesystem::create_directories(to, ec);
+		for (auto it = std::filesystem::recursive_directory_iterator(from, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+		{
+			const auto destination = to / it->path().lexically_relative(from);
+			if (it->is_directory(ec))
+			{
+				std::filesystem::create_directories(destination, ec);
+				continue;
+			}
+
+			const auto method = imm::platform::clone_file(it->path(), destination, allow_hard_link);
+			if (!method)
+			{
+				stats.failed++;
+			}
+			else if (*method == imm::platform::clone_method::reflink)
+			{
+				stats.reflinked++;
+			}
+			else if (*method == imm::platform::clone_method::hard_link)
+			{
+				stats.hard_linked++;
+			}
+			else
+			{
+				stats.copied++;
+			}
+		}
+
+		if (ec)
+		{
+			stats.failed++;
+		}
+		return stats;
+	}
+
+	plugin_folders extracted_plugin_folders(const std::filesystem::path& extracted)
+	{
+		return {
+		    .plugins      = extracted / "plugins",
+		    .plugins_data = extracted / "plugins_data",
+		    .config       = extracted / "config",
+		};
+	}
+
+	clone_stats install_extracted(const std::filesystem::path& extracted, const plugin_folders& folders)
+	{
+		const auto source = extracted_plugin_folders(extracted);
+
+		clone_stats stats;
+		std::error_code ec;
+		if (std::filesystem::exists(source.plugins, ec))
+		{
+			add(stats, clone_tree(source.plugins, folders.plugins, true));
+		}
+		if (std::filesystem::exists(source.plugins_data, ec))
+		{
+			add(stats, clone_tree(source.plugins_data, folders.plugins_data, false));
+		}
+		if (std::filesystem::exists(source.config, ec))
+		{
+			add(stats, clone_tree(source.config, folders.config, false));
+		}
+		return stats;
+	}
+} // namespace imm::install
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "zip_install.hpp"
+
+#include <cstddef>
+#include <filesystem>
+
+namespace imm::install
+{
+	struct clone_stats
+	{
+		size_t reflinked{};
+		size_t hard_linked{};
+		size_t copied{};
+		size_t failed{};
+	};
+
+	// Recreates the tree under from below to, files being reflinks or hard links of the originals where possible.
+	// Files already in to are replaced, never written into.
+	clone_stats clone_tree(const std::filesystem::path& from, const std::filesystem::path& to, bool allow_hard_link);
+
+	// Layout of a package version extracted once for every install, one subfolder per plugin folder.
+	plugin_folders extracted_plugin_folders(const std::filesystem::path& extracted);
+
+	// Places a package version extracted with extracted_plugin_folders into folders.
+	// Only plugins may be hard linked. Mods write to their plugins_data files at runtime and the game and users edit config,
+	// those are reflinked or copied so the extracted copy never changes.
+	clone_stats install_extracted(const std::filesystem::path& extracted, const plugin_folders& folders);
+} // namespace imm::install
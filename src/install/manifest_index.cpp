@@ -0,0 +1,235 @@
+#include "manifest_index.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+
+namespace imm::install
+{
+	namespace
+	{
+		std::filesystem::path from_utf8(const std::string& text)
+		{
+			return std::filesystem::path(std::u8string_view((const char8_t*)text.data(), text.size()));
+		}
+
+		std::string to_utf8(const std::filesystem::path& path)
+		{
+			const auto text = path.generic_u8string();
+			return std::string((const char*)text.data(), text.size());
+		}
+
+		bool is_manifest_filename(const std::filesystem::path& filename)
+		{
+			return filename == "manifest.json" || filename == "manifest_disabled.json";
+		}
+
+		// Reuses previous when the file didn't change since it was parsed.
+		std::optional<indexed_manifest> read_manifest(const std::filesystem::path& path, const std::string& filename, const indexed_manifest* previous, manifest_scan_stats& stats)
+		{
+			std::error_code ec;
+			const auto mtime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+			if (ec)
+			{
+				return std::nullopt;
+			}
+			const auto size = std::filesystem::file_size(path, ec);
+			if (ec)
+			{
+				return std::nullopt;
+			}
+
+			if (previous && previous->mtime == mtime && previous->size == size)
+			{
+				stats.reused_manifests++;
+				return *previous;
+			}
+
+			stats.parsed_manifests++;
+			indexed_manifest result{.filename = filename, .mtime = mtime, .size = size};
+
+			std::ifstream f(path);
+			const auto j = nlohmann::json::parse(f, nullptr, false, true);
+			if (j.is_object())
+			{
+				try
+				{
+					result.manifest = j.get<ts::v1::manifest>();
+					result.is_valid = true;
+				}
+				catch (const nlohmann::json::exception&)
+				{
+				}
+			}
+			return result;
+		}
+	} // namespace
+
+	manifest_index::manifest_index(std::filesystem::path index_path) :
+	    m_index_path(std::move(index_path))
+	{
+		std::ifstream f(m_index_path);
+		if (f)
+		{
+			const auto j = nlohmann::json::parse(f, nullptr, false, true);
+			if (j.is_object())
+			{
+				try
+				{
+					m_data = j.get<manifest_index_data>();
+				}
+				catch (const nlohmann::json::exception&)
+				{
+					m_data = {};
+				}
+			}
+		}
+	}
+
+	void manifest_index::save() const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_index_path.parent_path(), ec);
+
+		const auto tmp_path = std::filesystem::path(m_index_path).concat(".tmp");
+		{
+			std::ofstream f(tmp_path, std::ios::trunc);
+			nlohmann::json j = m_data;
+			f << j << std::endl;
+			if (!f)
+			{
+				return;
+			}
+		}
+
+		std::filesystem::rename(tmp_path, m_index_path, ec);
+	}
+
+	std::vector<scanned_manifest> manifest_index::scan(const std::filesystem::path& plugins_folder, const std::function<bool(const std::filesystem::path& directory)>& skip_directory)
+	{
+		std::unique_lock lock(m_mutex);
+
+		auto previous = std::move(m_data);
+		m_data        = {.plugins_folder = to_utf8(plugins_folder)};
+		if (previous.plugins_folder != m_data.plugins_folder)
+		{
+			previous.directories.clear();
+		}
+
+		manifest_scan_stats stats;
+		bool changed = false;
+		std::vector<scanned_manifest> result;
+
+		std::vector<std::string> pending{""};
+		while (pending.size())
+		{
+			const auto relative = std::move(pending.back());
+			pending.pop_back();
+
+			const auto directory_path = relative.empty() ? plugins_folder : plugins_folder / from_utf8(relative);
+
+			std::error_code ec;
+			const auto mtime = std::filesystem::last_write_time(directory_path, ec).time_since_epoch().count();
+			if (ec)
+			{
+				changed = true;
+				continue;
+			}
+
+			const auto previous_it                     = previous.directories.find(relative);
+			const indexed_directory* previous_directory = previous_it != previous.directories.end() ? &previous_it->second : nullptr;
+			const auto find_previous_manifest          = [&](const std::string& filename) -> const indexed_manifest*
+			{
+				if (!previous_directory)
+				{
+					return nullptr;
+				}
+				for (const auto& manifest : previous_directory->manifests)
+				{
+					if (manifest.filename == filename)
+					{
+						return &manifest;
+					}
+				}
+				return nullptr;
+			};
+
+			indexed_directory directory{.mtime = mtime};
+			std::vector<std::string> manifest_filenames;
+			if (previous_directory && previous_directory->mtime == mtime)
+			{
+				stats.reused_directories++;
+				directory.subdirectories = previous_directory->subdirectories;
+				for (const auto& manifest : previous_directory->manifests)
+				{
+					manifest_filenames.push_back(manifest.filename);
+				}
+			}
+			else
+			{
+				stats.listed_directories++;
+				changed = true;
+				for (const auto& entry : std::filesystem::directory_iterator(directory_path, std::filesystem::directory_options::skip_permission_denied, ec))
+				{
+					std::error_code entry_ec;
+					if (entry.is_directory(entry_ec) && !entry.is_symlink(entry_ec))
+					{
+						if (!skip_directory || !skip_directory(entry.path()))
+						{
+							directory.subdirectories.push_back(to_utf8(entry.path().filename()));
+						}
+					}
+					else if (is_manifest_filename(entry.path().filename()))
+					{
+						manifest_filenames.push_back(to_utf8(entry.path().filename()));
+					}
+				}
+				std::sort(directory.subdirectories.begin(), directory.subdirectories.end());
+				std::sort(manifest_filenames.begin(), manifest_filenames.end());
+			}
+
+			for (const auto& filename : manifest_filenames)
+			{
+				const auto path          = directory_path / from_utf8(filename);
+				const auto previous_file = find_previous_manifest(filename);
+				auto manifest            = read_manifest(path, filename, previous_file, stats);
+				if (!manifest)
+				{
+					changed = true;
+					continue;
+				}
+				changed = changed || !previous_file || previous_file->mtime != manifest->mtime || previous_file->size != manifest->size;
+
+				if (manifest->is_valid)
+				{
+					result.push_back({.path = path, .manifest = manifest->manifest});
+				}
+				directory.manifests.push_back(std::move(*manifest));
+			}
+
+			// Reverse so the stack hands them out in name order.
+			for (auto it = directory.subdirectories.rbegin(); it != directory.subdirectories.rend(); ++it)
+			{
+				pending.push_back(relative.empty() ? *it : relative + '/' + *it);
+			}
+
+			m_data.directories.emplace(relative, std::move(directory));
+		}
+
+		// Directories gone since the last scan.
+		changed = changed || m_data.directories.size() != previous.directories.size();
+
+		m_last_stats = stats;
+		if (changed)
+		{
+			save();
+		}
+		return result;
+	}
+
+	manifest_scan_stats manifest_index::last_stats()
+	{
+		std::unique_lock lock(m_mutex);
+		return m_last_stats;
+	}
+} // namespace imm::install
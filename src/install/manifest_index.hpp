@@ -0,0 +1,84 @@
+#pragma once
+
+#include "thunderstore/v1/manifest.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace imm::install
+{
+	struct indexed_manifest
+	{
+		// "manifest.json" or "manifest_disabled.json".
+		std::string filename{};
+		int64_t mtime{};
+		uint64_t size{};
+		bool is_valid{};
+		ts::v1::manifest manifest{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(indexed_manifest, filename, mtime, size, is_valid, manifest)
+	};
+
+	struct indexed_directory
+	{
+		// Changes when an entry is added, removed or renamed right in the directory, not below it.
+		int64_t mtime{};
+		// UTF-8 names.
+		std::vector<std::string> subdirectories{};
+		std::vector<indexed_manifest> manifests{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(indexed_directory, mtime, subdirectories, manifests)
+	};
+
+	struct manifest_index_data
+	{
+		// UTF-8, the whole index is dropped when the plugins folder isn't this one.
+		std::string plugins_folder{};
+		// Keyed by the UTF-8 path relative to plugins_folder, "" for plugins_folder itself.
+		std::map<std::string, indexed_directory> directories{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(manifest_index_data, plugins_folder, directories)
+	};
+
+	struct scanned_manifest
+	{
+		std::filesystem::path path;
+		ts::v1::manifest manifest;
+	};
+
+	struct manifest_scan_stats
+	{
+		size_t listed_directories{};
+		size_t reused_directories{};
+		size_t parsed_manifests{};
+		size_t reused_manifests{};
+	};
+
+	// Installed manifests below the plugins folder, persisted between runs so a rescan only lists the directories whose
+	// mtime changed and only parses the manifests whose mtime or size changed. Unchanged directories cost one stat each.
+	class manifest_index
+	{
+		std::filesystem::path m_index_path;
+
+		std::mutex m_mutex;
+		manifest_index_data m_data;
+		manifest_scan_stats m_last_stats;
+
+		void save() const;
+
+	public:
+		explicit manifest_index(std::filesystem::path index_path);
+
+		// Every manifest.json and manifest_disabled.json below plugins_folder, directories skip_directory returns true for
+		// are left out along with everything below them. Manifests that don't parse are left out too.
+		std::vector<scanned_manifest> scan(const std::filesystem::path& plugins_folder, const std::function<bool(const std::filesystem::path& directory)>& skip_directory);
+
+		manifest_scan_stats last_stats();
+	};
+} // namespace imm::install
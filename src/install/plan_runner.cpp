@@ -0,0 +1,116 @@
+#include "plan_runner.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace imm::install
+{
+	bool run_install_plan(const install_plan& plan, size_t max_parallel, const std::function<bool(size_t step_index)>& run_step)
+	{
+		const auto step_count = plan.steps.size();
+
+		std::vector<size_t> remaining_dependencies(step_count);
+		std::vector<std::vector<size_t>> dependents(step_count);
+		std::vector<size_t> ready;
+		for (size_t i = 0; i < step_count; i++)
+		{
+			remaining_dependencies[i] = plan.steps[i].depends_on.size();
+			for (const auto dependency : plan.steps[i].depends_on)
+			{
+				dependents[dependency].push_back(i);
+			}
+
+			if (remaining_dependencies[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::vector<bool> skipped(step_count, false);
+		size_t finished    = 0;
+		bool all_succeeded = true;
+
+		// Caller holds mutex.
+		auto skip_dependents = [&](size_t failed_step)
+		{
+			std::vector<size_t> to_skip = dependents[failed_step];
+			while (to_skip.size())
+			{
+				const auto step = to_skip.back();
+				to_skip.pop_back();
+				if (skipped[step])
+				{
+					continue;
+				}
+
+				skipped[step] = true;
+				finished++;
+				to_skip.insert(to_skip.end(), dependents[step].begin(), dependents[step].end());
+			}
+		};
+
+		auto worker = [&]
+		{
+			std::unique_lock lock(mutex);
+			while (true)
+			{
+				cv.wait(lock,
+				        [&]
+				        {
+					        return ready.size() || finished == step_count;
+				        });
+
+				if (ready.empty())
+				{
+					return;
+				}
+
+				const auto step = ready.back();
+				ready.pop_back();
+
+				lock.unlock();
+				const bool success = run_step(step);
+				lock.lock();
+
+				finished++;
+				if (success)
+				{
+					for (const auto dependent : dependents[step])
+					{
+						if (--remaining_dependencies[dependent] == 0 && !skipped[dependent])
+						{
+							ready.push_back(dependent);
+						}
+					}
+				}
+				else
+				{
+					all_succeeded = false;
+					skip_dependents(step);
+				}
+
+				cv.notify_all();
+			}
+		};
+
+		const auto thread_count = std::max<size_t>(1, std::min(max_parallel, step_count));
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < thread_count; i++)
+		{
+			threads.emplace_back(worker);
+		}
+		worker();
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		return all_succeeded;
+	}
+} // namespace imm::install
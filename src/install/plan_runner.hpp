@@ -0,0 +1,13 @@
+#pragma once
+
+#include "dependency_resolver.hpp"
+
+#include <functional>
+
+namespace imm::install
+{
+	// Runs run_step with the index of every step of plan on up to max_parallel threads, independent branches of the plan overlap.
+	// A step starts once every step it depends on succeeded, steps depending on a failed one are skipped.
+	// Blocks until done, returns false if any step failed or was skipped.
+	bool run_install_plan(const install_plan& plan, size_t max_parallel, const std::function<bool(size_t step_index)>& run_step);
+} // namespace imm::install
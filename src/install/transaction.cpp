@@ -0,0 +1,390 @@
+#include "transaction.hpp"
+
+#include "linked_install.hpp"
+#include "logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+namespace imm::install
+{
+	namespace
+	{
+		constexpr std::string_view staging_marker = ".imm_staging.";
+		constexpr std::string_view backup_marker  = ".imm_backup.";
+
+		std::filesystem::path from_utf8(const std::string& text)
+		{
+			return std::filesystem::path(std::u8string_view((const char8_t*)text.data(), text.size()));
+		}
+
+		std::string to_utf8(const std::filesystem::path& path)
+		{
+			const auto text = path.u8string();
+			return std::string((const char*)text.data(), text.size());
+		}
+
+		bool exists(const std::string& path)
+		{
+			std::error_code ec;
+			return std::filesystem::exists(from_utf8(path), ec);
+		}
+
+		bool rename(const std::string& from, const std::string& to)
+		{
+			std::error_code ec;
+			std::filesystem::rename(from_utf8(from), from_utf8(to), ec);
+			if (ec)
+			{
+				SPDLOG_LOGGER_INFO(logger, "can't move {} to {}: {}", from, to, ec.message());
+				return false;
+			}
+			return true;
+		}
+
+		bool remove_all(const std::string& path)
+		{
+			std::error_code ec;
+			std::filesystem::remove_all(from_utf8(path), ec);
+			return !ec && !exists(path);
+		}
+
+		void write_journal_file(const std::filesystem::path& path, const journal& j)
+		{
+			const auto tmp_path = std::filesystem::path(path).concat(".tmp");
+			{
+				std::ofstream f(tmp_path, std::ios::trunc);
+				nlohmann::json json = j;
+				f << json << std::endl;
+				if (!f.flush())
+				{
+					return;
+				}
+			}
+
+			std::error_code ec;
+			std::filesystem::rename(tmp_path, path, ec);
+		}
+
+		// Idempotent, so recovery can run it again from any point. Backups are kept until finish_commit.
+		bool roll_forward(const journal& j, const fault_injector& fault)
+		{
+			const auto at = [&](std::string_view point)
+			{
+				if (fault)
+				{
+					fault(point);
+				}
+			};
+
+			for (const auto& op : j.operations)
+			{
+				const bool removal = op.staging.empty();
+
+				// Swapped already, or a staged file that was never written.
+				if (!removal && !exists(op.staging))
+				{
+					continue;
+				}
+
+				if (exists(op.live) && !exists(op.backup))
+				{
+					if (!rename(op.live, op.backup))
+					{
+						return false;
+					}
+					at("backed_up");
+				}
+
+				if (!removal)
+				{
+					if (!rename(op.staging, op.live))
+					{
+						return false;
+					}
+					at("swapped");
+				}
+			}
+
+			return true;
+		}
+
+		// Puts back what roll_forward moved so far, in reverse.
+		bool roll_back_commit(const journal& j)
+		{
+			bool success = true;
+			for (auto it = j.operations.rbegin(); it != j.operations.rend(); ++it)
+			{
+				const auto& op = *it;
+				if (!op.created && !exists(op.backup))
+				{
+					continue;
+				}
+
+				// Swapped in, back to staging where it is dropped with the rest.
+				if (!op.staging.empty() && exists(op.live) && !exists(op.staging))
+				{
+					success = rename(op.live, op.staging) && success;
+				}
+				if (!op.created && !exists(op.live))
+				{
+					success = rename(op.backup, op.live) && success;
+				}
+			}
+
+			for (const auto& op : j.operations)
+			{
+				if (!op.staging.empty())
+				{
+					success = remove_all(op.staging) && success;
+				}
+			}
+
+			return success;
+		}
+
+		bool finish_commit(const journal& j)
+		{
+			bool success = true;
+			for (const auto& op : j.operations)
+			{
+				success = remove_all(op.backup) && success;
+			}
+			return success;
+		}
+
+		void drop_staging(const journal& j)
+		{
+			for (const auto& op : j.operations)
+			{
+				if (!op.staging.empty())
+				{
+					remove_all(op.staging);
+				}
+			}
+		}
+
+		std::string new_suffix()
+		{
+			static std::atomic<uint64_t> counter = 0;
+			return std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" + std::to_string(counter++);
+		}
+	} // namespace
+
+	transaction::transaction(const std::filesystem::path& journal_folder, fault_injector fault) :
+	    m_suffix(new_suffix()),
+	    m_fault(std::move(fault))
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(journal_folder, ec);
+		m_journal_path = journal_folder / (m_suffix + ".json");
+
+		m_journal.state = "staging";
+	}
+
+	transaction::~transaction()
+	{
+		if (!m_finished)
+		{
+			rollback();
+		}
+	}
+
+	void transaction::fault(std::string_view point) const
+	{
+		if (m_fault)
+		{
+			m_fault(point);
+		}
+	}
+
+	void transaction::write_journal()
+	{
+		write_journal_file(m_journal_path, m_journal);
+	}
+
+	journal_operation& transaction::add_operation(const std::filesystem::path& live, bool staged)
+	{
+		const auto live_utf8 = to_utf8(live);
+		for (auto& op : m_journal.operations)
+		{
+			if (op.live == live_utf8)
+			{
+				return op;
+			}
+		}
+
+		auto& op  = m_journal.operations.emplace_back();
+		op.live   = live_utf8;
+		op.backup = live_utf8 + std::string(backup_marker) + m_suffix;
+		if (staged)
+		{
+			op.staging = live_utf8 + std::string(staging_marker) + m_suffix;
+		}
+
+		// Ahead of creating anything, so a crash while staging leaves nothing recover() doesn't know about.
+		write_journal();
+		return op;
+	}
+
+	std::filesystem::path transaction::stage_directory(const std::filesystem::path& live, bool keep_live_files)
+	{
+		std::string staging;
+		{
+			std::unique_lock lock(m_mutex);
+			const auto count = m_journal.operations.size();
+			staging          = add_operation(live, true).staging;
+			if (count == m_journal.operations.size())
+			{
+				return from_utf8(staging);
+			}
+		}
+
+		const auto staging_path = from_utf8(staging);
+		std::error_code ec;
+		if (keep_live_files && std::filesystem::exists(live, ec))
+		{
+			// Reflinks where the file system has them, copies otherwise. Never hard links: anything writing into a staged
+			// file in place would change the live one before the commit, and a rollback couldn't undo it.
+			clone_tree(live, staging_path, false);
+		}
+		std::filesystem::create_directories(staging_path, ec);
+		return staging_path;
+	}
+
+	std::filesystem::path transaction::stage_file(const std::filesystem::path& live)
+	{
+		std::unique_lock lock(m_mutex);
+		return from_utf8(add_operation(live, true).staging);
+	}
+
+	void transaction::remove(const std::filesystem::path& live)
+	{
+		std::unique_lock lock(m_mutex);
+		add_operation(live, false);
+	}
+
+	bool transaction::commit()
+	{
+		std::unique_lock lock(m_mutex);
+		if (m_finished)
+		{
+			return false;
+		}
+
+		// A simulated crash leaves everything as is for recover().
+		const auto crash_aware_fault = [this](std::string_view point)
+		{
+			try
+			{
+				fault(point);
+			}
+			catch (...)
+			{
+				m_finished = true;
+				throw;
+			}
+		};
+
+		crash_aware_fault("staged");
+		for (auto& op : m_journal.operations)
+		{
+			op.created = !op.staging.empty() && exists(op.staging) && !exists(op.live);
+		}
+		m_journal.state = "committing";
+		write_journal();
+		crash_aware_fault("committing");
+
+		if (!roll_forward(m_journal, crash_aware_fault))
+		{
+			m_finished = true;
+			if (roll_back_commit(m_journal))
+			{
+				std::error_code ec;
+				std::filesystem::remove(m_journal_path, ec);
+			}
+			// Otherwise the journal still says committing and the next start finishes the commit.
+			return false;
+		}
+
+		m_journal.state = "committed";
+		write_journal();
+		crash_aware_fault("committed");
+
+		m_finished = true;
+		if (finish_commit(m_journal))
+		{
+			std::error_code ec;
+			std::filesystem::remove(m_journal_path, ec);
+		}
+		return true;
+	}
+
+	void transaction::rollback()
+	{
+		std::unique_lock lock(m_mutex);
+		m_finished = true;
+
+		drop_staging(m_journal);
+		std::error_code ec;
+		std::filesystem::remove(m_journal_path, ec);
+	}
+
+	bool is_transaction_path(const std::filesystem::path& path)
+	{
+		const auto name = to_utf8(path.filename());
+		return name.find(staging_marker) != std::string::npos || name.find(backup_marker) != std::string::npos;
+	}
+
+	void recover(const std::filesystem::path& journal_folder)
+	{
+		std::error_code ec;
+		std::vector<std::filesystem::path> journal_paths;
+		for (const auto& entry : std::filesystem::directory_iterator(journal_folder, ec))
+		{
+			journal_paths.push_back(entry.path());
+		}
+
+		for (const auto& path : journal_paths)
+		{
+			if (path.extension() == ".tmp")
+			{
+				std::filesystem::remove(path, ec);
+				continue;
+			}
+			if (path.extension() != ".json")
+			{
+				continue;
+			}
+
+			std::ifstream f(path);
+			const auto json = nlohmann::json::parse(f, nullptr, false, true);
+			f.close();
+			if (json.is_discarded())
+			{
+				std::filesystem::remove(path, ec);
+				continue;
+			}
+
+			const auto j = json.get<journal>();
+			bool done    = true;
+			if (j.state == "staging")
+			{
+				SPDLOG_LOGGER_INFO(logger, "dropping unfinished install {}", to_utf8(path.filename()));
+				drop_staging(j);
+			}
+			else
+			{
+				SPDLOG_LOGGER_INFO(logger, "finishing interrupted install {}", to_utf8(path.filename()));
+				done = (j.state == "committed" || roll_forward(j, {})) && finish_commit(j);
+			}
+
+			if (done)
+			{
+				std::filesystem::remove(path, ec);
+			}
+		}
+	}
+} // namespace imm::install
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace imm::install
+{
+	struct journal_operation
+	{
+		// UTF-8 paths, staging is empty when live is only removed.
+		std::string live{};
+		std::string staging{};
+		std::string backup{};
+		// Live didn't exist when the commit started, undoing it means moving live away rather than restoring a backup.
+		bool created{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(journal_operation, live, staging, backup, created)
+	};
+
+	struct journal
+	{
+		// "staging" until every staging folder is complete, then "committing".
+		std::string state{};
+		std::vector<journal_operation> operations{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(journal, state, operations)
+	};
+
+	// Called at each step of a commit with the step name, throwing from it simulates a crash right there.
+	using fault_injector = std::function<void(std::string_view point)>;
+
+	// Changes to live folders and files, prepared next to them and swapped in with renames.
+	// The journal is written ahead of every step, so recover() can finish a commit or drop a half-built stage after a crash.
+	// Staging and backup names get a per-transaction suffix, see is_transaction_path.
+	class transaction
+	{
+		std::filesystem::path m_journal_path;
+		std::string m_suffix;
+		fault_injector m_fault;
+
+		std::mutex m_mutex;
+		journal m_journal;
+		bool m_finished = false;
+
+		journal_operation& add_operation(const std::filesystem::path& live, bool staged);
+		void write_journal();
+		void fault(std::string_view point) const;
+
+	public:
+		// Journals go to journal_folder, one file per transaction.
+		explicit transaction(const std::filesystem::path& journal_folder, fault_injector fault = {});
+		// Rolls back when neither commit nor rollback was called.
+		~transaction();
+
+		transaction(const transaction&)            = delete;
+		transaction& operator=(const transaction&) = delete;
+
+		// Folder to write the new content of live to. With keep_live_files it starts as a copy of live, for folders whose
+		// files the change doesn't touch must survive (config, plugins_data); files are reflinked where the file system can,
+		// copied otherwise, writing into them never touches live. Without it the folder starts empty and costs nothing.
+		// Staging the same live folder again returns the same staging folder. Thread safe.
+		std::filesystem::path stage_directory(const std::filesystem::path& live, bool keep_live_files);
+
+		// Where to write the new content of the file live, nothing changes if nothing is written there. Thread safe.
+		std::filesystem::path stage_file(const std::filesystem::path& live);
+
+		// Removes live on commit. Thread safe.
+		void remove(const std::filesystem::path& live);
+
+		// Swaps every staged path in and removes the replaced ones. Returns false and leaves the live paths as they were
+		// if one couldn't be moved, usually because the game holds a file open.
+		bool commit();
+
+		// Drops every staged path, live paths are untouched.
+		void rollback();
+	};
+
+	// Staging / backup folder of a transaction, never a package of its own.
+	bool is_transaction_path(const std::filesystem::path& path);
+
+	// Finishes or undoes the transactions whose journal is still in journal_folder, call once at startup.
+	void recover(const std::filesystem::path& journal_folder);
+} // namespace imm::install
@@ -0,0 +1,286 @@
+#include "zip_install.hpp"
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cwctype>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <zip/zip.h>
+
+namespace imm::install
+{
+	namespace
+	{
+		// Below this the zip is extracted on the calling thread alone.
+		constexpr uint64_t parallel_extraction_min_bytes = 8 * 1024 * 1024;
+
+		// Backslashes show up in zips made on Windows, "./" in zips made by some tools.
+		// Nullopt for absolute names and names with a ".." component.
+		std::optional<std::string> normalize_entry_name(std::string_view entry_name)
+		{
+			std::string name(entry_name);
+			for (auto& c : name)
+			{
+				if (c == '\\')
+				{
+					c = '/';
+				}
+			}
+
+			while (name.starts_with("./"))
+			{
+				name.erase(0, 2);
+			}
+
+			if (name.starts_with('/') || name.find(':') != std::string::npos)
+			{
+				return std::nullopt;
+			}
+
+			size_t start = 0;
+			while (start <= name.size())
+			{
+				auto end = name.find('/', start);
+				if (end == std::string::npos)
+				{
+					end = name.size();
+				}
+				if (std::string_view(name).substr(start, end - start) == "..")
+				{
+					return std::nullopt;
+				}
+				start = end + 1;
+			}
+
+			return name;
+		}
+
+		std::filesystem::path utf8_path(std::string_view text)
+		{
+			return std::filesystem::path(std::u8string_view((const char8_t*)text.data(), text.size()));
+		}
+
+		size_t write_to_stream(void* arg, uint64_t, const void* data, size_t size)
+		{
+			auto& out = *(std::ofstream*)arg;
+			out.write((const char*)data, size);
+			return out.good() ? size : 0;
+		}
+
+		struct routed_entry
+		{
+			size_t index;
+			std::filesystem::path destination;
+			uint64_t size;
+		};
+
+		struct zip_reader
+		{
+			struct zip_t* zip;
+
+			explicit zip_reader(const std::filesystem::path& zip_path) :
+			    zip(zip_open((const char*)zip_path.u8string().c_str(), 0, 'r'))
+			{
+			}
+
+			~zip_reader()
+			{
+				if (zip)
+				{
+					zip_close(zip);
+				}
+			}
+
+			zip_reader(const zip_reader&)            = delete;
+			zip_reader& operator=(const zip_reader&) = delete;
+		};
+
+		// Key a destination is deduplicated on, the file system is case insensitive on Windows.
+		std::filesystem::path::string_type destination_key(const std::filesystem::path& destination)
+		{
+			auto key = destination.lexically_normal().native();
+#ifdef _WIN32
+			for (auto& c : key)
+			{
+				c = (wchar_t)std::towlower(c);
+			}
+#endif
+			return key;
+		}
+
+		// Routes every entry and creates the directories, returns the files to write, each destination once.
+		// When several entries land on the same file the last one wins, like it does when extracting in order.
+		std::optional<std::vector<routed_entry>> route_entries(struct zip_t* zip, const std::filesystem::path& zip_path, const zip_entry_router& route)
+		{
+			std::vector<routed_entry> files;
+			std::unordered_map<std::filesystem::path::string_type, size_t> file_by_destination;
+
+			const auto total = zip_entries_total(zip);
+			for (ssize_t i = 0; i < total; i++)
+			{
+				if (zip_entry_openbyindex(zip, (size_t)i) < 0)
+				{
+					return std::nullopt;
+				}
+
+				const char* raw_name = zip_entry_name(zip);
+				const auto name      = normalize_entry_name(raw_name ? raw_name : "");
+				const bool is_dir    = name && (zip_entry_isdir(zip) > 0 || name->ends_with('/'));
+				const uint64_t size  = zip_entry_size(zip);
+				zip_entry_close(zip);
+
+				if (!name)
+				{
+					SPDLOG_LOGGER_INFO(logger, "skipped unsafe entry {} of {}", raw_name, (const char*)zip_path.u8string().c_str());
+					continue;
+				}
+
+				std::string_view route_name = *name;
+				if (route_name.ends_with('/'))
+				{
+					route_name.remove_suffix(1);
+				}
+
+				auto destination = route_name.empty() ? std::nullopt : route(route_name);
+				if (!destination)
+				{
+					continue;
+				}
+
+				std::error_code ec;
+				std::filesystem::create_directories(is_dir ? *destination : destination->parent_path(), ec);
+				if (is_dir)
+				{
+					continue;
+				}
+
+				const auto [it, inserted] = file_by_destination.try_emplace(destination_key(*destination), files.size());
+				if (inserted)
+				{
+					files.push_back({.index = (size_t)i, .destination = std::move(*destination), .size = size});
+				}
+				else
+				{
+					files[it->second].index = (size_t)i;
+					files[it->second].size  = size;
+				}
+			}
+
+			return files;
+		}
+
+		// Workers pull the next file off a shared counter, files is sorted biggest first so the tail of the work is small ones.
+		bool extract_entries(const std::filesystem::path& zip_path, const std::vector<routed_entry>& files, std::atomic<size_t>& next, std::atomic<bool>& failed)
+		{
+			zip_reader reader(zip_path);
+			if (!reader.zip)
+			{
+				failed = true;
+				return false;
+			}
+
+			for (auto i = next++; i < files.size() && !failed; i = next++)
+			{
+				const auto& file = files[i];
+				if (zip_entry_openbyindex(reader.zip, file.index) < 0)
+				{
+					failed = true;
+					break;
+				}
+
+				std::ofstream out(file.destination, std::ios::binary | std::ios::trunc);
+				const bool written = out && zip_entry_extract(reader.zip, write_to_stream, &out) >= 0 && out.flush().good();
+				zip_entry_close(reader.zip);
+
+				if (!written)
+				{
+					SPDLOG_LOGGER_INFO(logger, "can't extract {} from {}", (const char*)file.destination.u8string().c_str(), (const char*)zip_path.u8string().c_str());
+					failed = true;
+					break;
+				}
+			}
+
+			return !failed;
+		}
+	} // namespace
+
+	std::optional<std::filesystem::path> route_plugin_zip_entry(std::string_view entry_name, const plugin_folders& folders)
+	{
+		if (entry_name.empty())
+		{
+			return std::nullopt;
+		}
+
+		const auto top_level = entry_name.substr(0, entry_name.find('/'));
+		if (top_level == "plugins_data")
+		{
+			return folders.plugins_data / utf8_path(entry_name);
+		}
+		if (top_level == "config")
+		{
+			return folders.config / utf8_path(entry_name);
+		}
+
+		return folders.plugins / utf8_path(entry_name);
+	}
+
+	bool extract_zip(const std::filesystem::path& zip_path, const zip_entry_router& route, size_t worker_count)
+	{
+		zip_reader reader(zip_path);
+		if (!reader.zip)
+		{
+			SPDLOG_LOGGER_INFO(logger, "can't open {}", (const char*)zip_path.u8string().c_str());
+			return false;
+		}
+
+		auto files = route_entries(reader.zip, zip_path, route);
+		if (!files)
+		{
+			return false;
+		}
+
+		std::sort(files->begin(),
+		          files->end(),
+		          [](const routed_entry& a, const routed_entry& b)
+		          {
+			          return a.size > b.size;
+		          });
+
+		uint64_t total_bytes = 0;
+		for (const auto& file : *files)
+		{
+			total_bytes += file.size;
+		}
+
+		// Every worker opens the zip on its own, not worth it for the many tiny mods.
+		if (worker_count == 0)
+		{
+			worker_count = total_bytes >= parallel_extraction_min_bytes ? std::thread::hardware_concurrency() : 1;
+		}
+		worker_count = std::clamp<size_t>(worker_count, 1, std::max<size_t>(files->size(), 1));
+
+		std::atomic<size_t> next = 0;
+		std::atomic<bool> failed = false;
+		std::vector<std::thread> workers;
+		for (size_t i = 1; i < worker_count; i++)
+		{
+			workers.emplace_back(
+			    [&]
+			    {
+				    extract_entries(zip_path, *files, next, failed);
+			    });
+		}
+		extract_entries(zip_path, *files, next, failed);
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		return !failed;
+	}
+} // namespace imm::install
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace imm::install
+{
+	// Where the files of one plugin package go.
+	struct plugin_folders
+	{
+		std::filesystem::path plugins;
+		std::filesystem::path plugins_data;
+		std::filesystem::path config;
+	};
+
+	// Entries under a top level "plugins_data" or "config" directory go below that folder, everything else below plugins,
+	// the path inside the zip is kept as is. Nullopt for names that would escape the folder.
+	std::optional<std::filesystem::path> route_plugin_zip_entry(std::string_view entry_name, const plugin_folders& folders);
+
+	// Gets the entry name '/' separated and relative, returns where to write it or nullopt to skip it.
+	using zip_entry_router = std::function<std::optional<std::filesystem::path>(std::string_view entry_name)>;
+
+	// Streams every routed entry of the zip straight to its destination, nothing is extracted to an intermediate folder.
+	// Big zips are inflated on one thread per core, each with its own handle on the zip, the result is the same as
+	// extracting entries in order. worker_count 0 picks the thread count from the zip size.
+	// Returns false if the zip can't be read or an entry couldn't be written, files already written are left in place.
+	bool extract_zip(const std::filesystem::path& zip_path, const zip_entry_router& route, size_t worker_count = 0);
+} // namespace imm::install
@@ -0,0 +1,64 @@
+#include "chunk_stream.hpp"
+
+namespace imm::net
+{
+	chunk_streambuf::int_type chunk_streambuf::underflow()
+	{
+		if (gptr() < egptr())
+		{
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::unique_lock lock(m_mutex);
+		m_cv.wait(lock,
+		          [this]
+		          {
+			          return m_chunks.size() || m_finished;
+		          });
+
+		if (m_chunks.empty())
+		{
+			return traits_type::eof();
+		}
+
+		m_current = std::move(m_chunks.front());
+		m_chunks.pop_front();
+		m_pending_bytes -= m_current.size();
+		m_cv.notify_all();
+
+		setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+		return traits_type::to_int_type(*gptr());
+	}
+
+	bool chunk_streambuf::push(std::string_view data)
+	{
+		if (data.empty())
+		{
+			return true;
+		}
+
+		std::unique_lock lock(m_mutex);
+		m_cv.wait(lock,
+		          [this]
+		          {
+			          return m_pending_bytes < max_pending_bytes || m_finished;
+		          });
+
+		if (m_finished)
+		{
+			return false;
+		}
+
+		m_chunks.emplace_back(data);
+		m_pending_bytes += data.size();
+		m_cv.notify_all();
+		return true;
+	}
+
+	void chunk_streambuf::finish()
+	{
+		std::unique_lock lock(m_mutex);
+		m_finished = true;
+		m_cv.notify_all();
+	}
+} // namespace imm::net
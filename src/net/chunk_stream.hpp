@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace imm::net
+{
+	// Stream buffer fed chunk by chunk from another thread (typically an HTTP write callback).
+	// The reader blocks in underflow() until the next chunk arrives or the producer calls finish(),
+	// consumed chunks are released right away so only the in-flight bytes are ever resident.
+	class chunk_streambuf : public std::streambuf
+	{
+		static constexpr size_t max_pending_bytes = 4 * 1024 * 1024;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::deque<std::string> m_chunks;
+		std::string m_current;
+		size_t m_pending_bytes = 0;
+		bool m_finished        = false;
+
+	protected:
+		int_type underflow() override;
+
+	public:
+		// Blocks the producer while more than max_pending_bytes are waiting to be read.
+		// Returns false once the stream is finished, so the producer can abort its transfer.
+		bool push(std::string_view data);
+
+		// Called by the producer at end of data, or by the reader to give up early.
+		void finish();
+	};
+
+	class chunk_stream : public std::istream
+	{
+		chunk_streambuf m_buffer;
+
+	public:
+		chunk_stream() :
+		    std::istream(&m_buffer)
+		{
+		}
+
+		bool push(std::string_view data)
+		{
+			return m_buffer.push(data);
+		}
+
+		void finish()
+		{
+			m_buffer.finish();
+		}
+	};
+} // namespace imm::net
@@ -0,0 +1,250 @@
+#include "download_pool.hpp"
+
+#include "http_header.hpp"
+#include "logger.hpp"
+
+#include <cpr/cpr.h>
+#include <chrono>
+#include <fstream>
+
+namespace imm::net
+{
+	download_pool::download_pool(size_t max_in_flight)
+	{
+		if (max_in_flight == 0)
+		{
+			max_in_flight = 1;
+		}
+
+		for (size_t i = 0; i < max_in_flight; i++)
+		{
+			m_workers.emplace_back(&download_pool::worker_loop, this);
+		}
+	}
+
+	download_pool::~download_pool()
+	{
+		std::deque<download_job> cancelled_jobs;
+		{
+			std::unique_lock lock(m_mutex);
+			m_stopping = true;
+			cancelled_jobs.swap(m_jobs);
+		}
+		m_cv.notify_all();
+
+		// Outside the lock, on_done may well look at the pool.
+		for (const auto& job : cancelled_jobs)
+		{
+			if (job.on_done)
+			{
+				job.on_done(false);
+			}
+		}
+
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	void download_pool::enqueue(download_job job)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_cv.notify_one();
+	}
+
+	size_t download_pool::pending()
+	{
+		std::unique_lock lock(m_mutex);
+		return m_jobs.size() + m_active_jobs;
+	}
+
+	void download_pool::wait_idle()
+	{
+		std::unique_lock lock(m_mutex);
+		m_idle_cv.wait(lock,
+		               [this]
+		               {
+			               return m_jobs.empty() && m_active_jobs == 0;
+		               });
+	}
+
+	download_pool::transfer_result download_pool::transfer(cpr::Session& session, const download_job& job)
+	{
+		const auto part_path = std::filesystem::path(job.path).concat(".part");
+
+		std::error_code ec;
+		uint64_t resume_offset = std::filesystem::is_regular_file(part_path, ec) ? std::filesystem::file_size(part_path, ec) : 0;
+		if (ec)
+		{
+			resume_offset = 0;
+		}
+
+		cpr::Header request_header;
+		if (resume_offset)
+		{
+			request_header["Range"] = "bytes=" + std::to_string(resume_offset) + "-";
+		}
+
+		// Header lines are seen before any body byte, so the status is known by the time the write callback runs.
+		long status_code        = 0;
+		uint64_t content_length = 0;
+		// From "Content-Range: bytes */<size>" of a 416.
+		uint64_t range_size = 0;
+		uint64_t downloaded = 0;
+		std::ofstream ofstream;
+
+		auto on_header = [&](std::string_view line, intptr_t)
+		{
+			if (const auto code = status_code_of(line))
+			{
+				// A new status line starts a new response (redirects), nothing of the previous one applies.
+				status_code    = code;
+				content_length = 0;
+				range_size     = 0;
+			}
+			else if (header_name_equals(line, "content-length"))
+			{
+				content_length = std::strtoull(header_value(line, "content-length").c_str(), nullptr, 10);
+			}
+			else if (header_name_equals(line, "content-range"))
+			{
+				const auto value = header_value(line, "content-range");
+				const auto slash = value.find('/');
+				range_size       = slash == std::string::npos ? 0 : std::strtoull(value.c_str() + slash + 1, nullptr, 10);
+			}
+			return true;
+		};
+
+		auto open_part = [&]
+		{
+			// 206 continues the part, a 200 means the server ignored the range and sends everything again.
+			const bool resumed = status_code == 206;
+			downloaded         = resumed ? resume_offset : 0;
+			ofstream.open(part_path, std::ios::binary | (resumed ? std::ios::app : std::ios::trunc));
+		};
+
+		auto on_write = [&](std::string_view data, intptr_t)
+		{
+			// Error pages and 416 bodies are not part of the file.
+			if (status_code != 200 && status_code != 206)
+			{
+				return true;
+			}
+
+			if (!ofstream.is_open())
+			{
+				open_part();
+			}
+
+			ofstream.write(data.data(), data.size());
+			downloaded += data.size();
+
+			if (job.on_progress)
+			{
+				job.on_progress(downloaded, content_length ? (status_code == 206 ? resume_offset : 0) + content_length : 0);
+			}
+			return ofstream.good();
+		};
+
+		session.SetUrl(cpr::Url{job.url});
+		session.SetHeader(request_header);
+		session.SetHeaderCallback(cpr::HeaderCallback{on_header});
+		session.SetWriteCallback(cpr::WriteCallback{on_write});
+		const auto response = session.Get();
+
+		if ((status_code == 200 || status_code == 206) && !ofstream.is_open())
+		{
+			open_part();
+		}
+		const bool written = ofstream.is_open() && ofstream.flush().good();
+		ofstream.close();
+
+		if (status_code == 416 && range_size == resume_offset)
+		{
+			// Killed between the last byte and the rename.
+			std::filesystem::rename(part_path, job.path, ec);
+			return ec ? transfer_result::retry : transfer_result::done;
+		}
+		if (status_code == 416)
+		{
+			// The part is stale (the file changed on the server), start over next attempt.
+			std::filesystem::remove(part_path, ec);
+			return transfer_result::retry;
+		}
+		if (status_code >= 400 && status_code < 500)
+		{
+			// Gone or refused, asking again gets the same answer.
+			std::filesystem::remove(part_path, ec);
+			return transfer_result::failed;
+		}
+
+		// A dropped connection keeps its part for the next attempt.
+		const bool complete = !response.error && (status_code == 200 || status_code == 206) && written
+		                   && (content_length == 0 || downloaded == (status_code == 206 ? resume_offset : 0) + content_length);
+		if (!complete)
+		{
+			return transfer_result::retry;
+		}
+
+		std::filesystem::rename(part_path, job.path, ec);
+		return ec ? transfer_result::retry : transfer_result::done;
+	}
+
+	void download_pool::worker_loop()
+	{
+		cpr::Session session;
+
+		while (true)
+		{
+			download_job job;
+			{
+				std::unique_lock lock(m_mutex);
+				m_cv.wait(lock,
+				          [this]
+				          {
+					          return m_stopping || m_jobs.size();
+				          });
+
+				if (m_stopping)
+				{
+					return;
+				}
+
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				m_active_jobs++;
+			}
+
+			auto result = transfer_result::retry;
+			for (int attempt = 0; attempt < max_attempts && result == transfer_result::retry; attempt++)
+			{
+				if (attempt)
+				{
+					std::this_thread::sleep_for(std::chrono::seconds(attempt));
+				}
+				result = transfer(session, job);
+			}
+			const bool success = result == transfer_result::done;
+
+			if (!success)
+			{
+				SPDLOG_LOGGER_INFO(logger, "download of {} failed", job.url);
+			}
+
+			if (job.on_done)
+			{
+				job.on_done(success);
+			}
+
+			{
+				std::unique_lock lock(m_mutex);
+				m_active_jobs--;
+			}
+			m_idle_cv.notify_all();
+		}
+	}
+} // namespace imm::net
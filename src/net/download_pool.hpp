@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cpr
+{
+	class Session;
+}
+
+namespace imm::net
+{
+	struct download_job
+	{
+		std::string url;
+		std::filesystem::path path;
+
+		// Called from the worker thread as bytes arrive, downloaded counts the resumed part too, total is 0 while unknown.
+		std::function<void(uint64_t downloaded, uint64_t total)> on_progress;
+
+		// Called from the worker thread once the transfer is over.
+		std::function<void(bool success)> on_done;
+	};
+
+	// Fixed set of workers, each with its own cpr::Session, so at most max_in_flight transfers run at once.
+	// Files are downloaded to "<path>.part" and renamed on success, an interrupted transfer never leaves a partial file at path.
+	// A dropped transfer or a server error is retried a few times, an existing .part is resumed with a Range request,
+	// also on the next run. Client errors (a missing icon's 404) fail right away, retrying won't change them.
+	class download_pool
+	{
+		static constexpr int max_attempts = 3;
+
+		enum class transfer_result
+		{
+			done,
+			retry,
+			failed,
+		};
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::condition_variable m_idle_cv;
+		std::deque<download_job> m_jobs;
+		std::vector<std::thread> m_workers;
+		size_t m_active_jobs = 0;
+		bool m_stopping      = false;
+
+		void worker_loop();
+		transfer_result transfer(cpr::Session& session, const download_job& job);
+
+	public:
+		explicit download_pool(size_t max_in_flight);
+		// Waits for the running transfers, jobs still queued get on_done(false) from the calling thread.
+		~download_pool();
+
+		download_pool(const download_pool&)            = delete;
+		download_pool& operator=(const download_pool&) = delete;
+
+		void enqueue(download_job job);
+
+		size_t pending();
+
+		// Blocks until the queue is empty and no transfer is running.
+		void wait_idle();
+	};
+} // namespace imm::net
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+namespace imm::net
+{
+	// Header lines as handed to a cpr::HeaderCallback, name is expected lower case.
+	inline bool header_name_equals(std::string_view line, std::string_view name)
+	{
+		if (line.size() <= name.size() || line[name.size()] != ':')
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < name.size(); i++)
+		{
+			if (std::tolower((unsigned char)line[i]) != name[i])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	inline std::string header_value(std::string_view line, std::string_view name)
+	{
+		auto value = line.substr(name.size() + 1);
+		while (value.size() && (value.front() == ' ' || value.front() == '\t'))
+		{
+			value.remove_prefix(1);
+		}
+		while (value.size() && (value.back() == '\r' || value.back() == '\n' || value.back() == ' '))
+		{
+			value.remove_suffix(1);
+		}
+		return std::string(value);
+	}
+
+	// Status code of an "HTTP/1.1 200 OK" line, 0 if line isn't one. Each redirect hop starts with a new status line.
+	inline long status_code_of(std::string_view line)
+	{
+		if (!line.starts_with("HTTP/"))
+		{
+			return 0;
+		}
+
+		const auto space = line.find(' ');
+		return space == std::string_view::npos ? 0 : std::strtol(line.data() + space + 1, nullptr, 10);
+	}
+} // namespace imm::net
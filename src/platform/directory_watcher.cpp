@@ -0,0 +1,404 @@
+#include "directory_watcher.hpp"
+
+#include <algorithm>
+#include <future>
+#include <memory>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <unistd.h>
+	#ifdef __linux__
+		#include <sys/inotify.h>
+		#include <unordered_map>
+	#endif
+#endif
+
+namespace imm::platform
+{
+	namespace
+	{
+		// Lets the constructor return once the roots are watched, or can't be, so no change made right after is missed.
+		class ready_signal
+		{
+			std::promise<void>& m_promise;
+			bool m_sent = false;
+
+		public:
+			explicit ready_signal(std::promise<void>& promise) :
+			    m_promise(promise)
+			{
+			}
+
+			~ready_signal()
+			{
+				send();
+			}
+
+			void send()
+			{
+				if (!m_sent)
+				{
+					m_sent = true;
+					m_promise.set_value();
+				}
+			}
+		};
+
+		class debouncer
+		{
+			std::vector<bool> m_changed;
+			std::chrono::steady_clock::time_point m_last_event;
+			bool m_pending = false;
+			std::chrono::milliseconds m_delay;
+
+		public:
+			debouncer(size_t root_count, std::chrono::milliseconds delay) :
+			    m_changed(root_count),
+			    m_delay(delay)
+			{
+			}
+
+			void mark(size_t root_index)
+			{
+				m_changed[root_index] = true;
+				m_pending             = true;
+				m_last_event          = std::chrono::steady_clock::now();
+			}
+
+			void mark_all()
+			{
+				for (size_t i = 0; i < m_changed.size(); i++)
+				{
+					mark(i);
+				}
+			}
+
+			// Milliseconds to wait for the next event, -1 to wait for as long as it takes.
+			int64_t timeout_ms() const
+			{
+				if (!m_pending)
+				{
+					return -1;
+				}
+
+				const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_last_event);
+				return std::max<int64_t>(0, (m_delay - elapsed).count());
+			}
+
+			// Roots changed since the last take, once things settled down.
+			std::vector<size_t> take()
+			{
+				std::vector<size_t> root_indices;
+				if (timeout_ms() != 0)
+				{
+					return root_indices;
+				}
+
+				for (size_t i = 0; i < m_changed.size(); i++)
+				{
+					if (m_changed[i])
+					{
+						root_indices.push_back(i);
+						m_changed[i] = false;
+					}
+				}
+				m_pending = false;
+				return root_indices;
+			}
+		};
+	} // namespace
+
+	directory_watcher::directory_watcher(std::vector<std::filesystem::path> roots, std::chrono::milliseconds debounce, change_callback on_change) :
+	    m_roots(std::move(roots)),
+	    m_debounce(debounce),
+	    m_on_change(std::move(on_change))
+	{
+#ifdef _WIN32
+		m_stop_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+#else
+		if (::pipe(m_stop_pipe) != 0)
+		{
+			m_stop_pipe[0] = m_stop_pipe[1] = -1;
+		}
+#endif
+
+		auto watching = m_watching.get_future();
+
+		m_thread = std::thread(
+		    [this]
+		    {
+			    run();
+		    });
+		watching.wait();
+	}
+
+	directory_watcher::~directory_watcher()
+	{
+		m_stop = true;
+#ifdef _WIN32
+		if (m_stop_event)
+		{
+			SetEvent(m_stop_event);
+		}
+#else
+		if (m_stop_pipe[1] != -1)
+		{
+			const char byte = 0;
+			(void)::write(m_stop_pipe[1], &byte, 1);
+		}
+#endif
+
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+
+#ifdef _WIN32
+		if (m_stop_event)
+		{
+			CloseHandle(m_stop_event);
+		}
+#else
+		for (const int fd : m_stop_pipe)
+		{
+			if (fd != -1)
+			{
+				::close(fd);
+			}
+		}
+#endif
+	}
+
+	void directory_watcher::report(const std::vector<size_t>& root_indices)
+	{
+		if (root_indices.empty())
+		{
+			return;
+		}
+
+		std::vector<std::filesystem::path> changed_roots;
+		for (const auto root_index : root_indices)
+		{
+			changed_roots.push_back(m_roots[root_index]);
+		}
+		m_on_change(changed_roots);
+	}
+
+#ifdef _WIN32
+	void directory_watcher::run()
+	{
+		ready_signal ready(m_watching);
+		if (!m_stop_event)
+		{
+			return;
+		}
+
+		struct watch
+		{
+			size_t root_index;
+			HANDLE directory;
+			OVERLAPPED overlapped;
+			// Names aren't looked at, only which root they are under, it just has to be DWORD aligned.
+			std::vector<DWORD> buffer;
+		};
+
+		const auto read_changes = [](watch& w)
+		{
+			return ReadDirectoryChangesW(w.directory,
+			                             w.buffer.data(),
+			                             (DWORD)(w.buffer.size() * sizeof(DWORD)),
+			                             TRUE,
+			                             FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION,
+			                             NULL,
+			                             &w.overlapped,
+			                             NULL);
+		};
+
+		// Heap allocated, the OVERLAPPED of a pending read must not move.
+		std::vector<std::unique_ptr<watch>> watches;
+		std::vector<HANDLE> wait_handles{m_stop_event};
+		for (size_t i = 0; i < m_roots.size() && wait_handles.size() < MAXIMUM_WAIT_OBJECTS; i++)
+		{
+			auto w = std::make_unique<watch>(watch{.root_index = i, .overlapped = {}, .buffer = std::vector<DWORD>(16 * 1024)});
+
+			w->directory = CreateFileW(m_roots[i].c_str(),
+			                           FILE_LIST_DIRECTORY,
+			                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			                           NULL,
+			                           OPEN_EXISTING,
+			                           FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			                           NULL);
+			if (w->directory == INVALID_HANDLE_VALUE)
+			{
+				continue;
+			}
+
+			w->overlapped.hEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+			if (!w->overlapped.hEvent || !read_changes(*w))
+			{
+				if (w->overlapped.hEvent)
+				{
+					CloseHandle(w->overlapped.hEvent);
+				}
+				CloseHandle(w->directory);
+				continue;
+			}
+
+			wait_handles.push_back(w->overlapped.hEvent);
+			watches.push_back(std::move(w));
+		}
+
+		ready.send();
+
+		debouncer changes(m_roots.size(), m_debounce);
+		while (!m_stop)
+		{
+			const auto timeout = changes.timeout_ms();
+			const auto result  = WaitForMultipleObjects((DWORD)wait_handles.size(), wait_handles.data(), FALSE, timeout < 0 ? INFINITE : (DWORD)timeout);
+			if (result == WAIT_OBJECT_0)
+			{
+				break;
+			}
+
+			if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + wait_handles.size())
+			{
+				auto& w = *watches[result - WAIT_OBJECT_0 - 1];
+
+				// Zero bytes means the buffer overflowed, the root changed all the same.
+				DWORD bytes = 0;
+				GetOverlappedResult(w.directory, &w.overlapped, &bytes, FALSE);
+				changes.mark(w.root_index);
+
+				read_changes(w);
+			}
+
+			report(changes.take());
+		}
+
+		for (auto& w : watches)
+		{
+			DWORD bytes = 0;
+			CancelIoEx(w->directory, &w->overlapped);
+			GetOverlappedResult(w->directory, &w->overlapped, &bytes, TRUE);
+			CloseHandle(w->overlapped.hEvent);
+			CloseHandle(w->directory);
+		}
+	}
+#elif defined(__linux__)
+	void directory_watcher::run()
+	{
+		ready_signal ready(m_watching);
+		if (m_stop_pipe[0] == -1)
+		{
+			return;
+		}
+
+		const int inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (inotify_fd == -1)
+		{
+			return;
+		}
+
+		// inotify only watches single directories, every subdirectory gets its own watch.
+		constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+		struct watch
+		{
+			size_t root_index;
+			std::filesystem::path path;
+		};
+		std::unordered_map<int, watch> watches;
+
+		const auto watch_tree = [&](const std::filesystem::path& path, size_t root_index)
+		{
+			std::vector<std::filesystem::path> directories{path};
+			std::error_code ec;
+			for (auto it = std::filesystem::recursive_directory_iterator(path, std::filesystem::directory_options::skip_permission_denied, ec);
+			     !ec && it != std::filesystem::recursive_directory_iterator();
+			     it.increment(ec))
+			{
+				std::error_code entry_ec;
+				if (it->is_directory(entry_ec) && !it->is_symlink(entry_ec))
+				{
+					directories.push_back(it->path());
+				}
+			}
+
+			for (const auto& directory : directories)
+			{
+				const int wd = ::inotify_add_watch(inotify_fd, directory.c_str(), mask);
+				if (wd != -1)
+				{
+					watches[wd] = {.root_index = root_index, .path = directory};
+				}
+			}
+		};
+
+		for (size_t i = 0; i < m_roots.size(); i++)
+		{
+			watch_tree(m_roots[i], i);
+		}
+		ready.send();
+
+		debouncer changes(m_roots.size(), m_debounce);
+		alignas(inotify_event) char buffer[64 * 1024];
+		while (!m_stop)
+		{
+			pollfd fds[2] = {
+			    {.fd = inotify_fd, .events = POLLIN},
+			    {.fd = m_stop_pipe[0], .events = POLLIN},
+			};
+			const auto timeout = changes.timeout_ms();
+			if (::poll(fds, 2, (int)std::min<int64_t>(timeout, INT32_MAX)) < 0 || (fds[1].revents & POLLIN))
+			{
+				break;
+			}
+
+			ssize_t length = 0;
+			while ((length = ::read(inotify_fd, buffer, sizeof(buffer))) > 0)
+			{
+				for (char* p = buffer; p < buffer + length;)
+				{
+					const auto& event  = *(const inotify_event*)p;
+					p                 += sizeof(inotify_event) + event.len;
+
+					if (event.mask & IN_Q_OVERFLOW)
+					{
+						changes.mark_all();
+						continue;
+					}
+
+					const auto it = watches.find(event.wd);
+					if (it == watches.end())
+					{
+						continue;
+					}
+					changes.mark(it->second.root_index);
+
+					if (event.mask & IN_IGNORED)
+					{
+						watches.erase(it);
+					}
+					// Files may land in it before its watch is added, the root is reported as changed anyway.
+					else if ((event.mask & IN_ISDIR) && (event.mask & (IN_CREATE | IN_MOVED_TO)) && event.len)
+					{
+						watch_tree(it->second.path / event.name, it->second.root_index);
+					}
+				}
+			}
+
+			report(changes.take());
+		}
+
+		::close(inotify_fd);
+	}
+#else
+	void directory_watcher::run()
+	{
+		m_watching.set_value();
+	}
+#endif
+} // namespace imm::platform
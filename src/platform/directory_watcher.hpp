@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace imm::platform
+{
+	// Watches directory trees, subdirectories included, on a thread of its own.
+	// Events are debounced: on_change gets the roots that changed once none of them saw an event for the debounce delay,
+	// so an extraction writing thousands of files is reported once. Backed by ReadDirectoryChangesW on Windows and inotify on Linux.
+	class directory_watcher
+	{
+	public:
+		using change_callback = std::function<void(const std::vector<std::filesystem::path>& changed_roots)>;
+
+	private:
+		std::vector<std::filesystem::path> m_roots;
+		std::chrono::milliseconds m_debounce;
+		change_callback m_on_change;
+
+		std::atomic<bool> m_stop = false;
+		std::promise<void> m_watching;
+		std::thread m_thread;
+
+#ifdef _WIN32
+		void* m_stop_event = nullptr;
+#else
+		int m_stop_pipe[2] = {-1, -1};
+#endif
+
+		void run();
+		void report(const std::vector<size_t>& root_indices);
+
+	public:
+		// Roots must exist, a root that can't be watched is left out. Returns once the roots are watched.
+		directory_watcher(std::vector<std::filesystem::path> roots, std::chrono::milliseconds debounce, change_callback on_change);
+		// Stops the thread, waiting for a running on_change to return, so don't destroy the watcher from on_change.
+		~directory_watcher();
+
+		directory_watcher(const directory_watcher&)            = delete;
+		directory_watcher& operator=(const directory_watcher&) = delete;
+
+		const std::vector<std::filesystem::path>& roots() const
+		{
+			return m_roots;
+		}
+	};
+} // namespace imm::platform
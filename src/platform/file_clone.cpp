@@ -0,0 +1,151 @@
+#include "file_clone.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <winioctl.h>
+#else
+	#include <fcntl.h>
+	#include <sys/ioctl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#ifdef __linux__
+		#include <linux/fs.h>
+	#endif
+#endif
+
+namespace imm::platform
+{
+	namespace
+	{
+#ifdef _WIN32
+		bool reflink(const std::filesystem::path& from, const std::filesystem::path& to)
+		{
+			const auto source = CreateFileW(from.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (source == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			// Only volumes that count block references (ReFS, Dev Drive) can share blocks between files.
+			DWORD file_system_flags = 0;
+			LARGE_INTEGER file_size{};
+			FSCTL_GET_INTEGRITY_INFORMATION_BUFFER integrity{};
+			DWORD bytes_returned = 0;
+			if (!GetVolumeInformationByHandleW(source, NULL, 0, NULL, NULL, &file_system_flags, NULL, 0) || !(file_system_flags & FILE_SUPPORTS_BLOCK_REFCOUNTING)
+			    || !GetFileSizeEx(source, &file_size)
+			    || !DeviceIoControl(source, FSCTL_GET_INTEGRITY_INFORMATION, NULL, 0, &integrity, sizeof(integrity), &bytes_returned, NULL))
+			{
+				CloseHandle(source);
+				return false;
+			}
+
+			const auto target = CreateFileW(to.c_str(), GENERIC_READ | GENERIC_WRITE | DELETE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (target == INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(source);
+				return false;
+			}
+
+			// Cloned ranges must be whole clusters and both files need the same integrity setting, the target is sized
+			// first so the rounded up last cluster stays within its end of file.
+			FSCTL_SET_INTEGRITY_INFORMATION_BUFFER set_integrity{
+			    .ChecksumAlgorithm = integrity.ChecksumAlgorithm,
+			    .Flags             = integrity.Flags,
+			};
+			FILE_END_OF_FILE_INFO end_of_file{.EndOfFile = file_size};
+			bool success = DeviceIoControl(target, FSCTL_SET_INTEGRITY_INFORMATION, &set_integrity, sizeof(set_integrity), NULL, 0, &bytes_returned, NULL)
+			            && SetFileInformationByHandle(target, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file));
+
+			const int64_t cluster_size = integrity.ClusterSizeInBytes ? integrity.ClusterSizeInBytes : 4096;
+			// Below 4 GB per call, as a multiple of the cluster size.
+			const int64_t max_chunk_size = (int64_t)1 << 30;
+			for (int64_t offset = 0; success && offset < file_size.QuadPart; offset += max_chunk_size)
+			{
+				const auto chunk_size = std::min(max_chunk_size, file_size.QuadPart - offset);
+
+				DUPLICATE_EXTENTS_DATA extents{.FileHandle = source};
+				extents.SourceFileOffset.QuadPart = offset;
+				extents.TargetFileOffset.QuadPart = offset;
+				extents.ByteCount.QuadPart        = (chunk_size + cluster_size - 1) / cluster_size * cluster_size;
+				success                           = DeviceIoControl(target, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(extents), NULL, 0, &bytes_returned, NULL);
+			}
+
+			if (!success)
+			{
+				FILE_DISPOSITION_INFO disposition{.DeleteFile = TRUE};
+				SetFileInformationByHandle(target, FileDispositionInfo, &disposition, sizeof(disposition));
+			}
+
+			CloseHandle(target);
+			CloseHandle(source);
+			return success;
+		}
+#else
+		bool reflink(const std::filesystem::path& from, const std::filesystem::path& to)
+		{
+	#ifdef FICLONE
+			const int source = ::open(from.c_str(), O_RDONLY);
+			if (source == -1)
+			{
+				return false;
+			}
+
+			struct stat st{};
+			if (::fstat(source, &st) != 0)
+			{
+				::close(source);
+				return false;
+			}
+
+			const int target = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL, st.st_mode & 0777);
+			if (target == -1)
+			{
+				::close(source);
+				return false;
+			}
+
+			const bool success = ::ioctl(target, FICLONE, source) == 0;
+			::close(target);
+			::close(source);
+			if (!success)
+			{
+				::unlink(to.c_str());
+			}
+			return success;
+	#else
+			return false;
+	#endif
+		}
+#endif
+	} // namespace
+
+	std::optional<clone_method> clone_file(const std::filesystem::path& from, const std::filesystem::path& to, bool allow_hard_link)
+	{
+		// Unlinked rather than overwritten, to may be a hard link to a file that must not change.
+		std::error_code ec;
+		std::filesystem::remove(to, ec);
+
+		if (reflink(from, to))
+		{
+			return clone_method::reflink;
+		}
+
+		if (allow_hard_link)
+		{
+			std::filesystem::create_hard_link(from, to, ec);
+			if (!ec)
+			{
+				return clone_method::hard_link;
+			}
+		}
+
+		std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+		if (!ec)
+		{
+			return clone_method::copy;
+		}
+		return std::nullopt;
+	}
+} // namespace imm::platform
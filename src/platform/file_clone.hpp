@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+
+namespace imm::platform
+{
+	enum class clone_method
+	{
+		// Copy on write clone sharing the blocks of the source (ReFS block cloning, FICLONE on btrfs / xfs).
+		reflink,
+		// Same file as the source, writing to one changes the other.
+		hard_link,
+		copy,
+	};
+
+	// Makes to a file with the content of from, replacing it if it exists (the old file is unlinked, never written to).
+	// Tries a reflink, then a hard link when allow_hard_link, then a plain copy. Nullopt if even the copy failed.
+	std::optional<clone_method> clone_file(const std::filesystem::path& from, const std::filesystem::path& to, bool allow_hard_link);
+} // namespace imm::platform
@@ -0,0 +1,128 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace imm::platform
+{
+	mapped_file::mapped_file(const std::filesystem::path& path)
+	{
+#ifdef _WIN32
+		const auto file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file_handle == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		m_file_handle = file_handle;
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+		{
+			close();
+			return;
+		}
+
+		m_mapping_handle = CreateFileMappingW(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!m_mapping_handle)
+		{
+			close();
+			return;
+		}
+
+		m_data = (const std::byte*)MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		m_size = m_data ? (size_t)file_size.QuadPart : 0;
+#else
+		m_fd = ::open(path.c_str(), O_RDONLY);
+		if (m_fd == -1)
+		{
+			return;
+		}
+
+		struct stat st{};
+		if (::fstat(m_fd, &st) != 0 || st.st_size == 0)
+		{
+			close();
+			return;
+		}
+
+		const auto mapping = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			close();
+			return;
+		}
+
+		m_data = (const std::byte*)mapping;
+		m_size = (size_t)st.st_size;
+#endif
+	}
+
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	mapped_file::mapped_file(mapped_file&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+			m_file_handle    = std::exchange(other.m_file_handle, nullptr);
+			m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#else
+			m_fd = std::exchange(other.m_fd, -1);
+#endif
+		}
+
+		return *this;
+	}
+
+	void mapped_file::close()
+	{
+#ifdef _WIN32
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping_handle)
+		{
+			CloseHandle(m_mapping_handle);
+		}
+		if (m_file_handle)
+		{
+			CloseHandle(m_file_handle);
+		}
+		m_mapping_handle = nullptr;
+		m_file_handle    = nullptr;
+#else
+		if (m_data)
+		{
+			::munmap((void*)m_data, m_size);
+		}
+		if (m_fd != -1)
+		{
+			::close(m_fd);
+		}
+		m_fd = -1;
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+} // namespace imm::platform
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace imm::platform
+{
+	// Read-only memory mapping of a whole file.
+	class mapped_file
+	{
+		const std::byte* m_data = nullptr;
+		size_t m_size           = 0;
+
+#ifdef _WIN32
+		void* m_file_handle    = nullptr;
+		void* m_mapping_handle = nullptr;
+#else
+		int m_fd = -1;
+#endif
+
+		void close();
+
+	public:
+		mapped_file() = default;
+		explicit mapped_file(const std::filesystem::path& path);
+		~mapped_file();
+
+		mapped_file(const mapped_file&)            = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept;
+		mapped_file& operator=(mapped_file&& other) noexcept;
+
+		bool is_open() const
+		{
+			return m_data != nullptr;
+		}
+
+		const std::byte* data() const
+		{
+			return m_data;
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+	};
+} // namespace imm::platform
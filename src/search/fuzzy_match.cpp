@@ -0,0 +1,218 @@
+#include "fuzzy_match.hpp"
+
+#include "string/case_fold.hpp"
+
+#include <bit>
+#include <emmintrin.h>
+#include <vector>
+
+namespace imm::search
+{
+	namespace
+	{
+		constexpr int score_match       = 16;
+		constexpr int bonus_boundary    = 8;
+		constexpr int bonus_consecutive = 4;
+		constexpr int penalty_gap_start = 3;
+		constexpr int penalty_gap_step  = 1;
+		constexpr int penalty_typo      = 24;
+
+		constexpr size_t no_skip = std::string_view::npos;
+
+		int char_bit(char c)
+		{
+			if (c >= 'a' && c <= 'z')
+			{
+				return c - 'a';
+			}
+			if (c >= '0' && c <= '9')
+			{
+				return 26 + (c - '0');
+			}
+			return 36 + (uint8_t)c % 28;
+		}
+
+		bool is_boundary(std::string_view text, size_t i)
+		{
+			if (i == 0)
+			{
+				return true;
+			}
+
+			const char prev = text[i - 1];
+			return prev == '-' || prev == '_' || prev == ' ' || prev == '.' || prev == '/';
+		}
+	} // namespace
+
+	uint64_t char_mask(std::string_view text)
+	{
+		uint64_t mask = 0;
+		for (const char c : text)
+		{
+			mask |= 1ull << char_bit(c);
+		}
+		return mask;
+	}
+
+	int min_fuzzy_score(int best_score)
+	{
+		// Half of the best, and only the best ones if even those are mostly gaps.
+		return best_score > 0 ? best_score / 2 : best_score;
+	}
+
+	namespace reference
+	{
+		size_t find_char(std::string_view text, char c, size_t from)
+		{
+			for (size_t i = from; i < text.size(); i++)
+			{
+				if (text[i] == c)
+				{
+					return i;
+				}
+			}
+			return std::string_view::npos;
+		}
+	} // namespace reference
+
+	size_t find_char(std::string_view text, char c, size_t from)
+	{
+		const __m128i needle = _mm_set1_epi8(c);
+
+		size_t i = from;
+		for (; i + 16 <= text.size(); i += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128((const __m128i*)(text.data() + i));
+			const int hits      = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+			if (hits)
+			{
+				return i + std::countr_zero((unsigned)hits);
+			}
+		}
+
+		return reference::find_char(text, c, i);
+	}
+
+	fuzzy_pattern::fuzzy_pattern(std::string_view pattern)
+	{
+		for (const char c : pattern)
+		{
+			if (c != ' ')
+			{
+				m_pattern += c;
+			}
+		}
+		imm::string::fold_case_in_place(m_pattern);
+		m_mask = char_mask(m_pattern);
+	}
+
+	bool fuzzy_pattern::may_match(uint64_t text_mask) const
+	{
+		const int missing = std::popcount(m_mask & ~text_mask);
+		return missing == 0 || (missing == 1 && m_pattern.size() >= 4);
+	}
+
+	std::optional<int> fuzzy_pattern::score_skipping(std::string_view text, size_t skipped_index) const
+	{
+		// Leftmost occurrence of the whole pattern as a subsequence.
+		size_t end = 0;
+		for (size_t k = 0, pos = 0; k < m_pattern.size(); k++)
+		{
+			if (k == skipped_index)
+			{
+				continue;
+			}
+
+			const auto found = find_char(text, m_pattern[k], pos);
+			if (found == std::string_view::npos)
+			{
+				return std::nullopt;
+			}
+			end = found;
+			pos = found + 1;
+		}
+
+		// Walk back from its end, matching the pattern in reverse, for the shortest window ending there.
+		thread_local std::vector<size_t> positions;
+		positions.assign(m_pattern.size(), no_skip);
+		size_t j = end + 1;
+		for (size_t k = m_pattern.size(); k-- > 0;)
+		{
+			if (k == skipped_index)
+			{
+				continue;
+			}
+
+			do
+			{
+				j--;
+			} while (text[j] != m_pattern[k]);
+			positions[k] = j;
+		}
+
+		int score   = 0;
+		size_t last = no_skip;
+		for (const auto pos : positions)
+		{
+			if (pos == no_skip)
+			{
+				continue;
+			}
+
+			score += score_match;
+			if (is_boundary(text, pos))
+			{
+				score += bonus_boundary;
+			}
+
+			if (last != no_skip)
+			{
+				if (pos == last + 1)
+				{
+					score += bonus_consecutive;
+				}
+				else
+				{
+					score -= penalty_gap_start + penalty_gap_step * (int)(pos - last - 2);
+				}
+			}
+			last = pos;
+		}
+
+		if (skipped_index != no_skip)
+		{
+			score -= penalty_typo;
+		}
+
+		return score;
+	}
+
+	std::optional<int> fuzzy_pattern::score(std::string_view text) const
+	{
+		if (m_pattern.empty())
+		{
+			return 0;
+		}
+
+		if (const auto exact = score_skipping(text, no_skip))
+		{
+			return exact;
+		}
+
+		if (m_pattern.size() < 4)
+		{
+			return std::nullopt;
+		}
+
+		std::optional<int> best;
+		for (size_t k = 0; k < m_pattern.size(); k++)
+		{
+			const auto s = score_skipping(text, k);
+			if (s && (!best || *s > *best))
+			{
+				best = s;
+			}
+		}
+		return best;
+	}
+} // namespace imm::search
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace imm::search
+{
+	// Presence bits of the characters of a case folded text, for cheap rejection before fuzzy matching.
+	uint64_t char_mask(std::string_view text);
+
+	// Subsequence matcher in the spirit of fzf v1: leftmost match, then walked back from its end to find
+	// the tightest window, scored on consecutive runs, word boundaries and gaps.
+	// Patterns of 4+ characters may also match with one character missing, for typos, at a penalty.
+	// The pattern is folded with imm::string::fold_case, texts are expected to be folded the same way.
+	// Spaces in the pattern are ignored, other bytes of UTF-8 sequences match one by one.
+	class fuzzy_pattern
+	{
+		std::string m_pattern;
+		uint64_t m_mask = 0;
+
+		std::optional<int> score_skipping(std::string_view text, size_t skipped_index) const;
+
+	public:
+		explicit fuzzy_pattern(std::string_view pattern);
+
+		bool empty() const
+		{
+			return m_pattern.empty();
+		}
+
+		// False means score() can't match a text with that char_mask.
+		bool may_match(uint64_t text_mask) const;
+
+		std::optional<int> score(std::string_view text) const;
+	};
+
+	// Matches scoring below this, given the best score among them, are dropped: on long texts almost any short
+	// pattern is a scattered subsequence, those would otherwise bury the few results that look like the query.
+	int min_fuzzy_score(int best_score);
+
+	// Index of the first c in text at or after from, or npos. SSE2, 16 bytes per step.
+	size_t find_char(std::string_view text, char c, size_t from);
+
+	namespace reference
+	{
+		size_t find_char(std::string_view text, char c, size_t from);
+	} // namespace reference
+} // namespace imm::search
@@ -0,0 +1,304 @@
+#include "search_index.hpp"
+
+#include "fuzzy_match.hpp"
+#include "string/case_fold.hpp"
+
+#include <algorithm>
+
+namespace imm::search
+{
+	namespace
+	{
+		constexpr std::array<int, (size_t)field::count> field_weights = {
+		    16, // name
+		    8,  // owner
+		    4,  // categories
+		    1,  // description
+		};
+
+		uint32_t trigram_key(std::string_view text, size_t i)
+		{
+			return (uint32_t)(uint8_t)text[i] | ((uint32_t)(uint8_t)text[i + 1] << 8) | ((uint32_t)(uint8_t)text[i + 2] << 16);
+		}
+	} // namespace
+
+	void search_index::add_trigrams(std::string_view text, uint32_t doc_id)
+	{
+		for (size_t i = 0; i + 3 <= text.size(); i++)
+		{
+			auto& postings = m_postings[trigram_key(text, i)];
+			if (postings.empty() || postings.back() < doc_id)
+			{
+				postings.push_back(doc_id);
+				continue;
+			}
+
+			// Updated documents land in the middle of the list.
+			const auto it = std::lower_bound(postings.begin(), postings.end(), doc_id);
+			if (it == postings.end() || *it != doc_id)
+			{
+				postings.insert(it, doc_id);
+			}
+		}
+	}
+
+	void search_index::remove_trigrams(std::string_view text, uint32_t doc_id)
+	{
+		for (size_t i = 0; i + 3 <= text.size(); i++)
+		{
+			const auto postings_it = m_postings.find(trigram_key(text, i));
+			if (postings_it == m_postings.end())
+			{
+				continue;
+			}
+
+			auto& postings = postings_it->second;
+			const auto it  = std::lower_bound(postings.begin(), postings.end(), doc_id);
+			if (it != postings.end() && *it == doc_id)
+			{
+				postings.erase(it);
+			}
+			if (postings.empty())
+			{
+				m_postings.erase(postings_it);
+			}
+		}
+	}
+
+	void search_index::set_fields(document& doc, std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description)
+	{
+		doc.fields[(size_t)field::name]        = imm::string::fold_case(name);
+		doc.fields[(size_t)field::owner]       = owner.folded();
+		doc.fields[(size_t)field::description] = imm::string::fold_case(description);
+		doc.name_char_mask                     = char_mask(doc.fields[(size_t)field::name]);
+		doc.fields[(size_t)field::categories].clear();
+		for (const auto& category : categories)
+		{
+			// Newline separated so a term can't match across two categories.
+			doc.fields[(size_t)field::categories] += category.folded();
+			doc.fields[(size_t)field::categories] += '\n';
+		}
+	}
+
+	uint32_t search_index::add(std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description)
+	{
+		const auto doc_id = (uint32_t)m_documents.size();
+
+		auto& doc = m_documents.emplace_back();
+		set_fields(doc, name, owner, categories, description);
+		for (const auto& text : doc.fields)
+		{
+			add_trigrams(text, doc_id);
+		}
+
+		m_generation++;
+		return doc_id;
+	}
+
+	void search_index::update(uint32_t doc_id, std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description)
+	{
+		auto& doc = m_documents[doc_id];
+		for (const auto& text : doc.fields)
+		{
+			remove_trigrams(text, doc_id);
+		}
+
+		set_fields(doc, name, owner, categories, description);
+		for (const auto& text : doc.fields)
+		{
+			add_trigrams(text, doc_id);
+		}
+
+		m_generation++;
+	}
+
+	void search_index::clear()
+	{
+		m_documents.clear();
+		m_postings.clear();
+		m_generation++;
+	}
+
+	const std::vector<uint32_t>* search_index::find_postings(std::string_view trigram) const
+	{
+		const auto it = m_postings.find(trigram_key(trigram, 0));
+		return it != m_postings.end() ? &it->second : nullptr;
+	}
+
+	int search_index::score(const document& doc, std::span<const std::string_view> terms) const
+	{
+		int total = 0;
+		for (const auto term : terms)
+		{
+			int best = 0;
+			for (size_t f = 0; f < doc.fields.size(); f++)
+			{
+				const auto& text = doc.fields[f];
+				const auto pos   = text.find(term);
+				if (pos == std::string::npos)
+				{
+					continue;
+				}
+
+				int s = field_weights[f];
+				if (f == (size_t)field::name)
+				{
+					if (text.size() == term.size())
+					{
+						s += field_weights[f];
+					}
+					// Start of the owner or of the name part of "Owner-Name".
+					else if (pos == 0 || text[pos - 1] == '-')
+					{
+						s += field_weights[f] / 2;
+					}
+				}
+
+				best = std::max(best, s);
+			}
+
+			if (best == 0)
+			{
+				return 0;
+			}
+			total += best;
+		}
+
+		return total;
+	}
+
+	std::vector<uint32_t> search_index::query(std::string_view text) const
+	{
+		const auto folded = imm::string::fold_case(text);
+
+		std::vector<std::string_view> terms;
+		for (size_t start = 0; start < folded.size();)
+		{
+			const auto end = std::min(folded.find(' ', start), folded.size());
+			if (end > start)
+			{
+				terms.emplace_back(folded.data() + start, end - start);
+			}
+			start = end + 1;
+		}
+
+		if (terms.empty())
+		{
+			return {};
+		}
+
+		std::vector<uint32_t> results = query_terms(terms);
+
+		// Typos and abbreviations, only against the name, after every exact match.
+		const fuzzy_pattern pattern(folded);
+		std::vector<bool> already_matched(m_documents.size());
+		for (const auto doc_id : results)
+		{
+			already_matched[doc_id] = true;
+		}
+
+		std::vector<std::pair<int, uint32_t>> fuzzy_scored;
+		for (uint32_t doc_id = 0; doc_id < m_documents.size(); doc_id++)
+		{
+			const auto& doc = m_documents[doc_id];
+			if (already_matched[doc_id] || !pattern.may_match(doc.name_char_mask))
+			{
+				continue;
+			}
+
+			if (const auto s = pattern.score(doc.fields[(size_t)field::name]))
+			{
+				fuzzy_scored.emplace_back(*s, doc_id);
+			}
+		}
+
+		std::stable_sort(fuzzy_scored.begin(),
+		                 fuzzy_scored.end(),
+		                 [](const auto& a, const auto& b)
+		                 {
+			                 return a.first > b.first;
+		                 });
+		for (const auto& [s, doc_id] : fuzzy_scored)
+		{
+			if (s < min_fuzzy_score(fuzzy_scored[0].first))
+			{
+				break;
+			}
+			results.push_back(doc_id);
+		}
+
+		return results;
+	}
+
+	std::vector<uint32_t> search_index::query_terms(std::span<const std::string_view> terms) const
+	{
+		// Gather the posting lists of every trigram, smallest first so the intersection shrinks fast.
+		std::vector<const std::vector<uint32_t>*> lists;
+		for (const auto term : terms)
+		{
+			for (size_t i = 0; i + 3 <= term.size(); i++)
+			{
+				const auto postings = find_postings(term.substr(i, 3));
+				if (!postings)
+				{
+					return {};
+				}
+				lists.push_back(postings);
+			}
+		}
+		std::sort(lists.begin(),
+		          lists.end(),
+		          [](const auto* a, const auto* b)
+		          {
+			          return a->size() < b->size();
+		          });
+
+		std::vector<uint32_t> candidates;
+		if (lists.empty())
+		{
+			// Only 1 or 2 character terms, every document is a candidate.
+			candidates.resize(m_documents.size());
+			for (uint32_t i = 0; i < candidates.size(); i++)
+			{
+				candidates[i] = i;
+			}
+		}
+		else
+		{
+			candidates = *lists[0];
+			std::vector<uint32_t> intersection;
+			for (size_t i = 1; i < lists.size() && candidates.size(); i++)
+			{
+				intersection.clear();
+				std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+				candidates.swap(intersection);
+			}
+		}
+
+		// Trigrams only say the characters are there, not contiguous nor in one field, confirm with a substring check.
+		std::vector<std::pair<int, uint32_t>> scored;
+		for (const auto doc_id : candidates)
+		{
+			const int s = score(m_documents[doc_id], terms);
+			if (s > 0)
+			{
+				scored.emplace_back(s, doc_id);
+			}
+		}
+
+		std::stable_sort(scored.begin(),
+		                 scored.end(),
+		                 [](const auto& a, const auto& b)
+		                 {
+			                 return a.first > b.first;
+		                 });
+
+		std::vector<uint32_t> results;
+		results.reserve(scored.size());
+		for (const auto& [s, doc_id] : scored)
+		{
+			results.push_back(doc_id);
+		}
+		return results;
+	}
+} // namespace imm::search
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "string/intern_pool.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace imm::search
+{
+	enum class field : uint8_t
+	{
+		name,
+		owner,
+		categories,
+		description,
+		count
+	};
+
+	// Trigram postings over a few text fields per document, case folded with imm::string::fold_case like the queries.
+	// A query is split on spaces, every term has to be found in at least one field of a document,
+	// terms of 3+ characters narrow the candidates down through their trigrams before the substring check.
+	// Documents whose name only fuzzy matches the whole query (see fuzzy_pattern) come after those,
+	// minus the ones far below the best fuzzy match (see min_fuzzy_score).
+	// Documents can be updated in place, removing one means clearing and adding everything again.
+	class search_index
+	{
+		struct document
+		{
+			std::array<std::string, (size_t)field::count> fields;
+			uint64_t name_char_mask;
+		};
+
+		std::vector<document> m_documents;
+		// Doc ids in each list are ascending, documents are added in id order.
+		std::unordered_map<uint32_t, std::vector<uint32_t>> m_postings;
+		uint64_t m_generation = 0;
+
+		static void set_fields(document& doc, std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description);
+		void add_trigrams(std::string_view text, uint32_t doc_id);
+		void remove_trigrams(std::string_view text, uint32_t doc_id);
+		const std::vector<uint32_t>* find_postings(std::string_view trigram) const;
+		int score(const document& doc, std::span<const std::string_view> terms) const;
+		std::vector<uint32_t> query_terms(std::span<const std::string_view> terms) const;
+
+	public:
+		// Returns the document id, ids are dense and start at 0.
+		uint32_t add(std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description);
+
+		// Replaces the fields of an existing document, its id stays the same.
+		void update(uint32_t doc_id, std::string_view name, const imm::string::interned& owner, std::span<const imm::string::interned> categories, std::string_view description);
+
+		void clear();
+
+		size_t size() const
+		{
+			return m_documents.size();
+		}
+
+		// Bumped on every add / update / clear, cached query results are stale once it moved.
+		uint64_t generation() const
+		{
+			return m_generation;
+		}
+
+		// Matching document ids, best match first, ties in id order.
+		std::vector<uint32_t> query(std::string_view text) const;
+	};
+} // namespace imm::search
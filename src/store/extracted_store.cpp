@@ -0,0 +1,85 @@
+#include "extracted_store.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace imm::store
+{
+	namespace
+	{
+		constexpr std::string_view partial_marker = ".partial.";
+	} // namespace
+
+	extracted_store::extracted_store(std::filesystem::path folder) :
+	    m_folder(std::move(folder))
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_folder, ec);
+
+		// Left over by a run that stopped while filling an entry.
+		std::vector<std::filesystem::path> partial_paths;
+		for (const auto& entry : std::filesystem::directory_iterator(m_folder, ec))
+		{
+			if (entry.path().filename().string().find(partial_marker) != std::string::npos)
+			{
+				partial_paths.push_back(entry.path());
+			}
+		}
+		for (const auto& path : partial_paths)
+		{
+			std::filesystem::remove_all(path, ec);
+		}
+	}
+
+	std::optional<std::filesystem::path> extracted_store::get_or_create(const std::string& name, const std::function<bool(const std::filesystem::path& folder)>& fill)
+	{
+		const auto path = m_folder / name;
+
+		std::error_code ec;
+		if (std::filesystem::is_directory(path, ec))
+		{
+			return path;
+		}
+
+		static std::atomic<uint64_t> counter = 0;
+		const auto partial_path =
+		    m_folder / (name + std::string(partial_marker) + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" + std::to_string(counter++));
+		std::filesystem::create_directories(partial_path, ec);
+		if (ec || !fill(partial_path))
+		{
+			std::filesystem::remove_all(partial_path, ec);
+			return std::nullopt;
+		}
+
+		std::filesystem::rename(partial_path, path, ec);
+		if (ec)
+		{
+			// Another install filled the same entry first, both hold the same content.
+			std::filesystem::remove_all(partial_path, ec);
+			if (!std::filesystem::is_directory(path, ec))
+			{
+				return std::nullopt;
+			}
+		}
+		return path;
+	}
+
+	void extracted_store::prune(const std::function<bool(std::string_view name)>& keep)
+	{
+		std::error_code ec;
+		std::vector<std::filesystem::path> removed_paths;
+		for (const auto& entry : std::filesystem::directory_iterator(m_folder, ec))
+		{
+			const auto name = entry.path().filename().string();
+			if (name.find(partial_marker) == std::string::npos && !keep(name))
+			{
+				removed_paths.push_back(entry.path());
+			}
+		}
+		for (const auto& path : removed_paths)
+		{
+			std::filesystem::remove_all(path, ec);
+		}
+	}
+} // namespace imm::store
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace imm::store
+{
+	// Extracted package versions as "<name>/", each one written once and never changed afterwards, so installs can hard link
+	// or reflink their files instead of copying them, and every profile installing the same version shares the bytes.
+	// An entry is filled in a temporary folder and renamed into place, a folder named after an entry is always complete.
+	class extracted_store
+	{
+		std::filesystem::path m_folder;
+
+	public:
+		explicit extracted_store(std::filesystem::path folder);
+
+		// Folder of the entry name, calling fill with an empty temporary folder to create it when missing.
+		// Nullopt if fill returned false, nothing is kept then.
+		std::optional<std::filesystem::path> get_or_create(const std::string& name, const std::function<bool(const std::filesystem::path& folder)>& fill);
+
+		// Removes every entry keep returns false for. Files hard linked from it stay in place, only the store's copy goes.
+		void prune(const std::function<bool(std::string_view name)>& keep);
+	};
+} // namespace imm::store
@@ -0,0 +1,335 @@
+#include "zip_store.hpp"
+
+#include "hash/fnv1a.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace imm::store
+{
+	namespace
+	{
+		// A batch install hits the store once per package, its last uses are written together.
+		constexpr auto index_save_interval = std::chrono::seconds(5);
+
+		std::optional<uint64_t> hash_file(const std::filesystem::path& path)
+		{
+			std::ifstream f(path, std::ios::binary);
+			if (!f)
+			{
+				return std::nullopt;
+			}
+
+			std::vector<char> buffer(1024 * 1024);
+			uint64_t hash = imm::hash::fnv1a_64_offset_basis;
+			while (f)
+			{
+				f.read(buffer.data(), buffer.size());
+				hash = imm::hash::fnv1a_64(buffer.data(), (size_t)f.gcount(), hash);
+			}
+
+			if (f.bad())
+			{
+				return std::nullopt;
+			}
+			return hash;
+		}
+	} // namespace
+
+	zip_store::zip_store(std::filesystem::path folder, uint64_t budget_bytes) :
+	    m_folder(std::move(folder)),
+	    m_budget_bytes(budget_bytes)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_folder / "objects", ec);
+
+		std::unique_lock lock(m_mutex);
+		load_index();
+		collect_garbage_locked();
+		save_index();
+	}
+
+	zip_store::~zip_store()
+	{
+		flush();
+	}
+
+	void zip_store::flush()
+	{
+		std::unique_lock lock(m_mutex);
+		if (m_index_dirty)
+		{
+			save_index();
+		}
+	}
+
+	std::filesystem::path zip_store::object_path(const std::string& hash) const
+	{
+		return m_folder / "objects" / (hash + ".zip");
+	}
+
+	std::filesystem::path zip_store::index_path() const
+	{
+		return m_folder / "index.json";
+	}
+
+	void zip_store::load_index()
+	{
+		{
+			std::ifstream f(index_path());
+			if (f)
+			{
+				const auto j = nlohmann::json::parse(f, nullptr, false, true);
+				if (!j.is_discarded())
+				{
+					m_index = j.get<zip_store_index>();
+				}
+			}
+		}
+
+		// The index is saved after the files move, a crash in between leaves objects it doesn't know about.
+		// Those are kept as least recently used, indexed objects whose file is gone are forgotten.
+		std::unordered_set<std::string> on_disk;
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator(m_folder / "objects", ec))
+		{
+			if (!entry.is_regular_file() || entry.path().extension() != ".zip")
+			{
+				continue;
+			}
+
+			const auto hash = entry.path().stem().string();
+			on_disk.insert(hash);
+			if (!m_index.objects.contains(hash))
+			{
+				m_index.objects[hash] = {.size = (uint64_t)entry.file_size(ec), .last_used = 0};
+			}
+		}
+
+		std::erase_if(m_index.objects,
+		              [&](const auto& object)
+		              {
+			              return !on_disk.contains(object.first);
+		              });
+		std::erase_if(m_index.names,
+		              [&](const auto& name)
+		              {
+			              return !m_index.objects.contains(name.second);
+		              });
+
+		m_total_bytes = 0;
+		for (const auto& [hash, object] : m_index.objects)
+		{
+			m_total_bytes += object.size;
+		}
+	}
+
+	void zip_store::save_index()
+	{
+		m_index_dirty = false;
+		m_last_save   = std::chrono::steady_clock::now();
+
+		const auto tmp_path = std::filesystem::path(index_path()).concat(".tmp");
+		{
+			std::ofstream f(tmp_path, std::ios::trunc);
+			nlohmann::json j = m_index;
+			f << j << std::endl;
+			if (!f)
+			{
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmp_path, index_path(), ec);
+	}
+
+	void zip_store::remove_object(const std::string& hash)
+	{
+		const auto it = m_index.objects.find(hash);
+		if (it == m_index.objects.end())
+		{
+			return;
+		}
+
+		std::error_code ec;
+		std::filesystem::remove(object_path(hash), ec);
+
+		m_total_bytes -= it->second.size;
+		m_index.objects.erase(it);
+		m_verified.erase(hash);
+		std::erase_if(m_index.names,
+		              [&](const auto& name)
+		              {
+			              return name.second == hash;
+		              });
+	}
+
+	void zip_store::save_index_if_due()
+	{
+		if (m_index_dirty && std::chrono::steady_clock::now() - m_last_save >= index_save_interval)
+		{
+			save_index();
+		}
+	}
+
+	void zip_store::touch(const std::string& hash)
+	{
+		m_index.objects[hash].last_used = ++m_index.clock;
+		m_used_this_session.insert(hash);
+		m_index_dirty = true;
+	}
+
+	std::optional<std::filesystem::path> zip_store::find(const std::string& name)
+	{
+		std::string hash;
+		bool verified = false;
+		{
+			std::unique_lock lock(m_mutex);
+
+			const auto it = m_index.names.find(name);
+			if (it == m_index.names.end())
+			{
+				m_stats.misses++;
+				return std::nullopt;
+			}
+
+			hash     = it->second;
+			verified = m_verified.contains(hash);
+			// Spared by eviction from here on, the hash below runs unlocked.
+			m_used_this_session.insert(hash);
+		}
+
+		// Hashing a big zip takes a while, other installs and stats() keep going meanwhile.
+		const auto path = object_path(hash);
+		bool intact     = std::filesystem::exists(path);
+		if (intact && !verified)
+		{
+			const auto actual_hash = hash_file(path);
+			intact                 = actual_hash && imm::hash::to_hex(*actual_hash) == hash;
+		}
+
+		std::unique_lock lock(m_mutex);
+
+		// Dropped by another find while this one was hashing.
+		if (!m_index.objects.contains(hash))
+		{
+			m_stats.misses++;
+			return std::nullopt;
+		}
+
+		if (!intact)
+		{
+			remove_object(hash);
+			save_index();
+			if (!verified)
+			{
+				m_stats.corrupted++;
+			}
+			m_stats.misses++;
+			return std::nullopt;
+		}
+
+		m_verified.insert(hash);
+		touch(hash);
+		save_index_if_due();
+		m_stats.hits++;
+		return path;
+	}
+
+	std::optional<std::filesystem::path> zip_store::add(const std::string& name, const std::filesystem::path& file)
+	{
+		// Hashing doesn't touch the store, keep other installs going meanwhile.
+		const auto file_hash = hash_file(file);
+		if (!file_hash)
+		{
+			return std::nullopt;
+		}
+		const auto hash = imm::hash::to_hex(*file_hash);
+		const auto path = object_path(hash);
+
+		std::unique_lock lock(m_mutex);
+
+		std::error_code ec;
+		if (m_index.objects.contains(hash))
+		{
+			std::filesystem::remove(file, ec);
+			m_stats.deduplicated++;
+		}
+		else
+		{
+			const auto size = std::filesystem::file_size(file, ec);
+			if (ec)
+			{
+				return std::nullopt;
+			}
+
+			std::filesystem::rename(file, path, ec);
+			if (ec)
+			{
+				return std::nullopt;
+			}
+
+			m_index.objects[hash]  = {.size = size};
+			m_total_bytes         += size;
+		}
+
+		m_index.names[name] = hash;
+		m_verified.insert(hash);
+		touch(hash);
+
+		collect_garbage_locked();
+		save_index();
+		return path;
+	}
+
+	void zip_store::collect_garbage()
+	{
+		std::unique_lock lock(m_mutex);
+		collect_garbage_locked();
+		save_index();
+	}
+
+	void zip_store::collect_garbage_locked()
+	{
+		if (m_total_bytes <= m_budget_bytes)
+		{
+			return;
+		}
+
+		std::vector<std::pair<uint64_t, std::string>> candidates;
+		for (const auto& [hash, object] : m_index.objects)
+		{
+			if (!m_used_this_session.contains(hash))
+			{
+				candidates.emplace_back(object.last_used, hash);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		for (const auto& [last_used, hash] : candidates)
+		{
+			if (m_total_bytes <= m_budget_bytes)
+			{
+				break;
+			}
+
+			m_stats.evicted_bytes += m_index.objects[hash].size;
+			m_stats.evicted_objects++;
+			remove_object(hash);
+		}
+	}
+
+	zip_store_stats zip_store::stats() const
+	{
+		std::unique_lock lock(m_mutex);
+
+		auto stats         = m_stats;
+		stats.object_count = m_index.objects.size();
+		stats.name_count   = m_index.names.size();
+		stats.total_bytes  = m_total_bytes;
+		stats.budget_bytes = m_budget_bytes;
+		return stats;
+	}
+} // namespace imm::store
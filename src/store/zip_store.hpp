@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace imm::store
+{
+	struct zip_store_object
+	{
+		uint64_t size{};
+		// Logical clock of the last find / add, the lowest one is evicted first.
+		uint64_t last_used{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(zip_store_object, size, last_used)
+	};
+
+	struct zip_store_index
+	{
+		uint64_t clock{};
+		// Keyed by the hex content hash.
+		std::map<std::string, zip_store_object> objects{};
+		// Package version full name to hex content hash, several names can share an object.
+		std::map<std::string, std::string> names{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(zip_store_index, clock, objects, names)
+	};
+
+	struct zip_store_stats
+	{
+		uint64_t hits{};
+		uint64_t misses{};
+		// Adds whose bytes were already stored under another name.
+		uint64_t deduplicated{};
+		// Objects that failed verification and were dropped.
+		uint64_t corrupted{};
+		uint64_t evicted_objects{};
+		uint64_t evicted_bytes{};
+
+		size_t object_count{};
+		size_t name_count{};
+		uint64_t total_bytes{};
+		uint64_t budget_bytes{};
+	};
+
+	// Downloaded zips stored once per content as "objects/<hash>.zip", with an index from package version names to hashes.
+	// An object is hashed again the first time it is handed out in a run, a mismatch drops it and counts as a miss.
+	// Past the byte budget, least recently used objects are evicted, except those used since the store was opened
+	// since an install may still be reading them.
+	// Adds and removals are saved to index.json right away. A hit only bumps its last use, that is saved at most every
+	// few seconds, by flush() or on destruction, losing it in a crash only makes the eviction order a bit off.
+	class zip_store
+	{
+		std::filesystem::path m_folder;
+		uint64_t m_budget_bytes;
+
+		mutable std::mutex m_mutex;
+		zip_store_index m_index;
+		uint64_t m_total_bytes = 0;
+		std::unordered_set<std::string> m_verified;
+		std::unordered_set<std::string> m_used_this_session;
+		zip_store_stats m_stats;
+		bool m_index_dirty = false;
+		std::chrono::steady_clock::time_point m_last_save;
+
+		std::filesystem::path object_path(const std::string& hash) const;
+		std::filesystem::path index_path() const;
+
+		void load_index();
+		void save_index();
+		void save_index_if_due();
+		void remove_object(const std::string& hash);
+		void touch(const std::string& hash);
+		void collect_garbage_locked();
+
+	public:
+		zip_store(std::filesystem::path folder, uint64_t budget_bytes);
+		~zip_store();
+
+		zip_store(const zip_store&)            = delete;
+		zip_store& operator=(const zip_store&) = delete;
+
+		// Path of the verified zip stored for name.
+		std::optional<std::filesystem::path> find(const std::string& name);
+
+		// Moves file into the store under its content hash, or deletes it when that content is already stored.
+		// Returns the path of the stored object, file is left alone on failure.
+		std::optional<std::filesystem::path> add(const std::string& name, const std::filesystem::path& file);
+
+		// Evicts least recently used objects until the store fits its budget.
+		void collect_garbage();
+
+		// Saves last uses not written yet.
+		void flush();
+
+		zip_store_stats stats() const;
+	};
+} // namespace imm::store
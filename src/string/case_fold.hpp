@@ -0,0 +1,109 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <string>
+#include <string_view>
+
+namespace imm::string
+{
+	namespace detail
+	{
+		// Lowercase of the 2 byte UTF-8 code points that have a simple 2 byte lowercase:
+		// Latin-1, Latin Extended-A, Greek and Cyrillic capitals.
+		inline char32_t to_lower_2_byte(char32_t cp)
+		{
+			if ((cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) || (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) || (cp >= 0x410 && cp <= 0x42F))
+			{
+				return cp + 0x20;
+			}
+			if (cp >= 0x400 && cp <= 0x40F)
+			{
+				return cp + 0x50;
+			}
+			// The one capital of Latin Extended-A whose lowercase is in Latin-1.
+			if (cp == 0x178)
+			{
+				return 0xFF;
+			}
+			// Pairs of upper / lower, except the few that break the even / odd pattern.
+			if (cp >= 0x100 && cp <= 0x17F && cp != 0x130 && cp != 0x131 && cp != 0x138 && cp != 0x149 && cp != 0x17F)
+			{
+				const bool odd_upper = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+				if ((cp % 2 == 1) == odd_upper)
+				{
+					return cp + 1;
+				}
+			}
+			return cp;
+		}
+
+		// ASCII A-Z, 16 bytes at a time. Bytes with the high bit set compare as negative and are left alone.
+		// Returns whether any such byte was seen.
+		inline bool to_lower_ascii(char* data, size_t size)
+		{
+			const __m128i upper_a  = _mm_set1_epi8('A' - 1);
+			const __m128i upper_z  = _mm_set1_epi8('Z' + 1);
+			const __m128i case_bit = _mm_set1_epi8(0x20);
+
+			int non_ascii = 0;
+			size_t i      = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const __m128i chunk    = _mm_loadu_si128((const __m128i*)(data + i));
+				const __m128i is_upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, upper_a), _mm_cmplt_epi8(chunk, upper_z));
+				_mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(chunk, _mm_and_si128(is_upper, case_bit)));
+				non_ascii |= _mm_movemask_epi8(chunk);
+			}
+
+			for (; i < size; i++)
+			{
+				const char c = data[i];
+				if (c >= 'A' && c <= 'Z')
+				{
+					data[i] = (char)(c + 0x20);
+				}
+				non_ascii |= (unsigned char)c & 0x80;
+			}
+
+			return non_ascii != 0;
+		}
+
+		inline void to_lower_utf8(char* data, size_t size)
+		{
+			for (size_t i = 0; i + 1 < size; i++)
+			{
+				const auto b0 = (unsigned char)data[i];
+				const auto b1 = (unsigned char)data[i + 1];
+				if ((b0 & 0xE0) != 0xC0 || (b1 & 0xC0) != 0x80)
+				{
+					continue;
+				}
+
+				const char32_t cp    = ((char32_t)(b0 & 0x1F) << 6) | (b1 & 0x3F);
+				const char32_t lower = to_lower_2_byte(cp);
+				data[i]              = (char)(0xC0 | (lower >> 6));
+				data[i + 1]          = (char)(0x80 | (lower & 0x3F));
+				i++;
+			}
+		}
+	} // namespace detail
+
+	// Lowercases UTF-8 text in place: ASCII 16 bytes at a time, then the 2 byte code points that have a 2 byte lowercase.
+	// Every case insensitive comparison (search queries, indexed texts, interned strings) folds through this,
+	// so both sides of a match always agree.
+	inline void fold_case_in_place(std::string& text)
+	{
+		// Lowercase mappings used all stay within 2 byte sequences, so the string is edited in place.
+		if (detail::to_lower_ascii(text.data(), text.size()))
+		{
+			detail::to_lower_utf8(text.data(), text.size());
+		}
+	}
+
+	inline std::string fold_case(std::string_view text)
+	{
+		std::string result(text);
+		fold_case_in_place(result);
+		return result;
+	}
+} // namespace imm::string
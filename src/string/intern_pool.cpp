@@ -0,0 +1,64 @@
+#include "intern_pool.hpp"
+
+#include "case_fold.hpp"
+
+namespace imm::string
+{
+	const interned::entry interned::empty_entry{};
+
+	interned::interned(std::string_view str) :
+	    interned(intern_pool::global().intern(str))
+	{
+	}
+
+	interned::interned(const std::string& str) :
+	    interned(std::string_view(str))
+	{
+	}
+
+	interned::interned(const char* str) :
+	    interned(std::string_view(str))
+	{
+	}
+
+	intern_pool& intern_pool::global()
+	{
+		static intern_pool pool;
+		return pool;
+	}
+
+	interned intern_pool::intern(std::string_view str)
+	{
+		if (str.empty())
+		{
+			return interned();
+		}
+
+		std::unique_lock lock(m_mutex);
+
+		const auto it = m_lookup.find(str);
+		if (it != m_lookup.end())
+		{
+			return interned(it->second);
+		}
+
+		// Folded once here, so every user of the handle gets it for free.
+		auto& e = m_entries.emplace_back(interned::entry{.value = std::string(str), .folded = fold_case(str)});
+
+		m_lookup.emplace(e.value, &e);
+		m_bytes += e.value.size() + e.folded.size();
+		return interned(&e);
+	}
+
+	size_t intern_pool::count() const
+	{
+		std::unique_lock lock(m_mutex);
+		return m_entries.size();
+	}
+
+	size_t intern_pool::bytes() const
+	{
+		std::unique_lock lock(m_mutex);
+		return m_bytes;
+	}
+} // namespace imm::string
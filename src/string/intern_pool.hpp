@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace imm::string
+{
+	// Handle to a string stored once in the global intern_pool, along with its case folded form (see fold_case).
+	// Pointer sized and trivially copyable, equal handles mean equal strings.
+	class interned
+	{
+		friend class intern_pool;
+
+		struct entry
+		{
+			std::string value;
+			std::string folded;
+		};
+
+		static const entry empty_entry;
+
+		const entry* m_entry = &empty_entry;
+
+		explicit interned(const entry* e) :
+		    m_entry(e)
+		{
+		}
+
+	public:
+		interned() = default;
+		interned(std::string_view str);
+		interned(const std::string& str);
+		interned(const char* str);
+
+		const std::string& str() const
+		{
+			return m_entry->value;
+		}
+
+		const std::string& folded() const
+		{
+			return m_entry->folded;
+		}
+
+		const char* c_str() const
+		{
+			return m_entry->value.c_str();
+		}
+
+		size_t size() const
+		{
+			return m_entry->value.size();
+		}
+
+		bool empty() const
+		{
+			return m_entry->value.empty();
+		}
+
+		operator const std::string&() const
+		{
+			return m_entry->value;
+		}
+
+		operator std::string_view() const
+		{
+			return m_entry->value;
+		}
+
+		bool operator==(const interned& other) const
+		{
+			return m_entry == other.m_entry;
+		}
+
+		bool operator==(std::string_view other) const
+		{
+			return m_entry->value == other;
+		}
+	};
+
+	// Append only, entries live until exit: the catalog references the same few thousand owners,
+	// categories and dependency strings over and over, dropping them would save next to nothing.
+	class intern_pool
+	{
+		mutable std::mutex m_mutex;
+		std::deque<interned::entry> m_entries;
+		std::unordered_map<std::string_view, const interned::entry*> m_lookup;
+		size_t m_bytes = 0;
+
+	public:
+		static intern_pool& global();
+
+		interned intern(std::string_view str);
+
+		size_t count() const;
+
+		// Characters stored, original and folded.
+		size_t bytes() const;
+	};
+} // namespace imm::string
@@ -1,6 +1,14 @@
 #pragma once
+#include "case_fold.hpp"
+
+#include <charconv>
+#include <imgui.h>
 #include <locale>
+#include <sstream>
 #include <string.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace imm::string
@@ -11,28 +19,160 @@ namespace imm::string
 	}
 
 	template<typename T>
-	inline std::enable_if_t<std::is_same_v<T, std::string>, T> get_text_value(std::string text)
+	inline std::enable_if_t<std::is_same_v<T, std::string>, T> get_text_value(std::string_view text)
 	{
-		return text;
+		return std::string(text);
 	}
 
+	// Parses text like std::stringstream(text) >> value would.
+	// Arithmetic types take std::from_chars. What it reads differently goes through the stream instead: out of range values
+	// (operator>> clamps them), "-5" for an unsigned (operator>> wraps it) and an incomplete exponent.
+	// "inf", "nan" and "+-5", which from_chars would take, give 0 like operator>>. Leading whitespace includes \v and \f.
 	template<typename T>
-	inline std::enable_if_t<!std::is_same_v<T, std::string>, T> get_text_value(std::string text)
+	inline std::enable_if_t<!std::is_same_v<T, std::string>, T> get_text_value(std::string_view text)
 	{
+		// operator>> reads a char type as a character and bool as 0 / 1.
+		constexpr bool from_chars_type = (std::is_integral_v<T> && sizeof(T) > 1) || std::is_floating_point_v<T>;
+
 		T value = (T)0;
-		std::stringstream(text) >> value;
+		if constexpr (from_chars_type)
+		{
+			auto number = text;
+			while (number.size() && (number.front() == ' ' || (number.front() >= '\t' && number.front() <= '\r')))
+			{
+				number.remove_prefix(1);
+			}
+			const bool plus = number.size() && number.front() == '+';
+			number.remove_prefix(plus);
+
+			// from_chars takes "inf", "nan" and a '-' after the '+', operator>> wants digits.
+			const bool minus  = number.size() && number.front() == '-';
+			const auto digits = number.substr(minus);
+			if ((plus && minus) || digits.empty() || !((digits.front() >= '0' && digits.front() <= '9') || (std::is_floating_point_v<T> && digits.front() == '.')))
+			{
+				return value;
+			}
+
+			// It also stops before an incomplete exponent ("1e") that operator>> rejects.
+			const auto [end, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+			if (ec == std::errc() && !(std::is_floating_point_v<T> && end != number.data() + number.size() && (*end == 'e' || *end == 'E')))
+			{
+				return value;
+			}
+			value = (T)0;
+		}
+
+		std::stringstream(std::string(text)) >> value;
 		return value;
 	}
 
+	// Iterates the fields of text separated by delim as views into text, without allocating.
+	// Same fields as std::getline would give: no trailing empty field, nothing for an empty text.
+	class split_range
+	{
+		std::string_view m_text;
+		char m_delim;
+
+	public:
+		class iterator
+		{
+			std::string_view m_rest;
+			std::string_view m_field;
+			char m_delim = 0;
+			bool m_done  = true;
+
+			void next()
+			{
+				if (m_rest.empty())
+				{
+					m_done = true;
+					return;
+				}
+
+				const auto pos = m_rest.find(m_delim);
+				m_field        = m_rest.substr(0, pos);
+				m_rest         = pos == std::string_view::npos ? std::string_view() : m_rest.substr(pos + 1);
+			}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = std::string_view;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = const std::string_view*;
+			using reference         = const std::string_view&;
+
+			iterator() = default;
+
+			iterator(std::string_view text, char delim) :
+			    m_rest(text),
+			    m_delim(delim),
+			    m_done(false)
+			{
+				next();
+			}
+
+			reference operator*() const
+			{
+				return m_field;
+			}
+
+			pointer operator->() const
+			{
+				return &m_field;
+			}
+
+			iterator& operator++()
+			{
+				next();
+				return *this;
+			}
+
+			iterator operator++(int)
+			{
+				auto copy = *this;
+				next();
+				return copy;
+			}
+
+			bool operator==(const iterator& other) const
+			{
+				if (m_done || other.m_done)
+				{
+					return m_done == other.m_done;
+				}
+				return m_rest.data() == other.m_rest.data() && m_field.data() == other.m_field.data();
+			}
+		};
+
+		split_range(std::string_view text, char delim) :
+		    m_text(text),
+		    m_delim(delim)
+		{
+		}
+
+		iterator begin() const
+		{
+			return iterator(m_text, m_delim);
+		}
+
+		iterator end() const
+		{
+			return iterator();
+		}
+	};
+
+	inline split_range split_view(std::string_view text, const char delim)
+	{
+		return split_range(text, delim);
+	}
+
 	template<typename T = std::string>
-	inline std::vector<T> split(const std::string& text, const char delim)
+	inline std::vector<T> split(std::string_view text, const char delim)
 	{
 		std::vector<T> result;
-		std::string str;
-		std::stringstream ss(text);
-		while (std::getline(ss, str, delim))
+		for (const auto field : split_view(text, delim))
 		{
-			result.push_back(get_text_value<T>(str));
+			result.push_back(get_text_value<T>(field));
 		}
 		return result;
 	}
@@ -56,18 +196,23 @@ namespace imm::string
 	{
 		T result = input;
 
-		// Use the std::locale to ensure proper case conversion for the current locale
-		std::locale loc;
-
-		for (size_t i = 0; i < result.length(); ++i)
+		if constexpr (std::is_same_v<T, std::string>)
 		{
-			result[i] = std::tolower(result[i], loc);
+			fold_case_in_place(result);
+		}
+		else
+		{
+			// Use the std::locale to ensure proper case conversion for the current locale
+			std::locale loc;
+
+			for (size_t i = 0; i < result.length(); ++i)
+			{
+				result[i] = std::tolower(result[i], loc);
+			}
 		}
 
 		return result;
 	}
-
-
 } // namespace imm::string
 
 namespace ImGui
@@ -0,0 +1,183 @@
+#include "catalog_cache.hpp"
+
+#include "catalog_file.hpp"
+#include "logger.hpp"
+#include "net/chunk_stream.hpp"
+#include "net/http_header.hpp"
+
+#include <atomic>
+#include <cpr/cpr.h>
+#include <fstream>
+#include <thread>
+
+namespace ts::v1
+{
+	catalog_cache::catalog_cache(std::filesystem::path folder) :
+	    m_folder(std::move(folder))
+	{
+	}
+
+	std::filesystem::path catalog_cache::snapshot_path() const
+	{
+		return m_folder / "catalog.bin";
+	}
+
+	std::filesystem::path catalog_cache::meta_path() const
+	{
+		return m_folder / "catalog_meta.json";
+	}
+
+	catalog_cache_meta catalog_cache::read_meta() const
+	{
+		std::ifstream f(meta_path());
+		if (!f)
+		{
+			return {};
+		}
+
+		const auto j = nlohmann::json::parse(f, nullptr, false, true);
+		if (j.is_discarded())
+		{
+			return {};
+		}
+
+		return j.get<catalog_cache_meta>();
+	}
+
+	void catalog_cache::write_meta(const catalog_cache_meta& meta) const
+	{
+		std::ofstream f(meta_path());
+		nlohmann::json j = meta;
+		f << j << std::endl;
+	}
+
+	bool catalog_cache::load_snapshot(const snapshot_callback& on_package)
+	{
+		// Snapshots from before the binary format.
+		std::error_code ec;
+		std::filesystem::remove(m_folder / "catalog.json", ec);
+
+		{
+			const catalog_file snapshot(snapshot_path());
+			if (!snapshot.is_open())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < snapshot.package_count(); i++)
+			{
+				on_package(snapshot.package(i));
+			}
+		}
+
+		m_snapshot_loaded = true;
+		return true;
+	}
+
+	catalog_cache::refresh_result catalog_cache::refresh(const std::string& url, const package_callback& on_package)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_folder, ec);
+
+		// Without a usable snapshot a 304 would leave us with nothing, so don't send validators.
+		auto meta = read_meta();
+		if (meta.url != url || !m_snapshot_loaded)
+		{
+			meta = {.url = url};
+		}
+
+		cpr::Header request_header{{"accept", "application/json"}};
+		if (meta.etag.size())
+		{
+			request_header["If-None-Match"] = meta.etag;
+		}
+		if (meta.last_modified.size())
+		{
+			request_header["If-Modified-Since"] = meta.last_modified;
+		}
+
+		catalog_file_writer snapshot_writer;
+
+		// Header lines are seen before any body byte, so the status is known by the time the write callback runs.
+		std::atomic<long> status_code = 0;
+		catalog_cache_meta new_meta{.url = url};
+
+		auto on_header = [&](std::string_view line, intptr_t)
+		{
+			if (const auto code = imm::net::status_code_of(line))
+			{
+				// A new status line starts a new response (redirects).
+				status_code = code;
+				new_meta    = {.url = url};
+			}
+			else if (imm::net::header_name_equals(line, "etag"))
+			{
+				new_meta.etag = imm::net::header_value(line, "etag");
+			}
+			else if (imm::net::header_name_equals(line, "last-modified"))
+			{
+				new_meta.last_modified = imm::net::header_value(line, "last-modified");
+			}
+			return true;
+		};
+
+		imm::net::chunk_stream index_stream;
+
+		auto on_write = [&](std::string_view data, intptr_t)
+		{
+			if (status_code != 200)
+			{
+				return true;
+			}
+
+			return index_stream.push(data);
+		};
+
+		std::thread download_thread(
+		    [&]
+		    {
+			    const auto r = cpr::Get(cpr::Url{url}, request_header, cpr::HeaderCallback{on_header}, cpr::WriteCallback{on_write});
+			    if (r.error)
+			    {
+				    SPDLOG_LOGGER_INFO(logger, "catalog refresh of {} failed: {}", url, r.error.message);
+				    status_code = 0;
+			    }
+			    index_stream.finish();
+		    });
+
+		// Nothing is pushed for non-200 responses, the reader then simply sees an empty stream.
+		const auto parsed = read_package_index(index_stream,
+		                                       [&](package&& pkg)
+		                                       {
+			                                       if (status_code == 200)
+			                                       {
+				                                       snapshot_writer.add(pkg);
+				                                       on_package(std::move(pkg));
+			                                       }
+		                                       });
+		index_stream.finish();
+		download_thread.join();
+
+		if (status_code == 304)
+		{
+			return refresh_result::not_modified;
+		}
+
+		if (status_code != 200 || !parsed)
+		{
+			SPDLOG_LOGGER_INFO(logger, "catalog refresh of {} failed with status {}", url, status_code.load());
+			return refresh_result::failed;
+		}
+
+		if (snapshot_writer.write(snapshot_path()))
+		{
+			write_meta(new_meta);
+		}
+		else
+		{
+			SPDLOG_LOGGER_INFO(logger, "could not replace catalog snapshot");
+		}
+
+		return refresh_result::updated;
+	}
+} // namespace ts::v1
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "catalog_file.hpp"
+#include "package_reader.hpp"
+
+#include <filesystem>
+#include <string>
+
+namespace ts::v1
+{
+	struct catalog_cache_meta
+	{
+		std::string url{};
+		std::string etag{};
+		std::string last_modified{};
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(catalog_cache_meta, url, etag, last_modified)
+	};
+
+	// On-disk snapshot of a package index (in the binary catalog_file format)
+	// plus the validators needed to revalidate it.
+	// The snapshot is only replaced once a full 200 response parsed successfully.
+	class catalog_cache
+	{
+		std::filesystem::path m_folder;
+		bool m_snapshot_loaded = false;
+
+		std::filesystem::path snapshot_path() const;
+		std::filesystem::path meta_path() const;
+
+		catalog_cache_meta read_meta() const;
+		void write_meta(const catalog_cache_meta& meta) const;
+
+	public:
+		enum class refresh_result
+		{
+			not_modified,
+			updated,
+			failed,
+		};
+
+		explicit catalog_cache(std::filesystem::path folder);
+
+		using snapshot_callback = std::function<void(const package_view&)>;
+
+		// Replays the snapshot through on_package as views into the mapped file, nothing is copied out of it
+		// but what on_package copies. Views are only valid during the call.
+		// Returns false if there is none or it is corrupted.
+		bool load_snapshot(const snapshot_callback& on_package);
+
+		// Conditional GET of url (If-None-Match / If-Modified-Since).
+		// on_package is only called for a 200 response, while the body streams in.
+		refresh_result refresh(const std::string& url, const package_callback& on_package);
+	};
+} // namespace ts::v1
@@ -0,0 +1,393 @@
+#include "catalog_file.hpp"
+
+#include "package_reader.hpp"
+
+#include <fstream>
+
+namespace ts::v1
+{
+	using namespace catalog_format;
+
+	namespace
+	{
+		constexpr uint64_t align_up(uint64_t value)
+		{
+			return (value + 7) & ~uint64_t(7);
+		}
+
+		bool is_in_range(const range& r, uint64_t count)
+		{
+			return (uint64_t)r.first + r.count <= count;
+		}
+	} // namespace
+
+	std::string_view package_version_view::name() const
+	{
+		return m_file->string(m_record->name);
+	}
+
+	std::string_view package_version_view::full_name() const
+	{
+		return m_file->string(m_record->full_name);
+	}
+
+	std::string_view package_version_view::description() const
+	{
+		return m_file->string(m_record->description);
+	}
+
+	std::string_view package_version_view::icon() const
+	{
+		return m_file->string(m_record->icon);
+	}
+
+	std::string_view package_version_view::version_number() const
+	{
+		return m_file->string(m_record->version_number);
+	}
+
+	std::string_view package_version_view::download_url() const
+	{
+		return m_file->string(m_record->download_url);
+	}
+
+	std::string_view package_version_view::date_created() const
+	{
+		return m_file->string(m_record->date_created);
+	}
+
+	std::string_view package_version_view::website_url() const
+	{
+		return m_file->string(m_record->website_url);
+	}
+
+	std::string_view package_version_view::uuid4() const
+	{
+		return m_file->string(m_record->uuid4);
+	}
+
+	std::string_view package_version_view::dependency(size_t index) const
+	{
+		return m_file->string(m_file->m_list_entries[m_record->dependencies.first + index]);
+	}
+
+	package_version package_version_view::to_package_version() const
+	{
+		package_version pkg_version{};
+		pkg_version.name           = name();
+		pkg_version.full_name      = full_name();
+		pkg_version.description    = description();
+		pkg_version.icon           = icon();
+		pkg_version.version_number = version_number();
+		pkg_version.download_url   = download_url();
+		pkg_version.downloads      = downloads();
+		pkg_version.date_created   = date_created();
+		pkg_version.website_url    = website_url();
+		pkg_version.is_active      = is_active();
+		pkg_version.uuid4          = uuid4();
+		pkg_version.file_size      = file_size();
+
+		pkg_version.dependencies.reserve(dependency_count());
+		for (size_t i = 0; i < dependency_count(); i++)
+		{
+			pkg_version.dependencies.emplace_back(dependency(i));
+		}
+
+		return pkg_version;
+	}
+
+	std::string_view package_view::name() const
+	{
+		return m_file->string(m_record->name);
+	}
+
+	std::string_view package_view::full_name() const
+	{
+		return m_file->string(m_record->full_name);
+	}
+
+	std::string_view package_view::owner() const
+	{
+		return m_file->string(m_record->owner);
+	}
+
+	std::string_view package_view::package_url() const
+	{
+		return m_file->string(m_record->package_url);
+	}
+
+	std::string_view package_view::date_created() const
+	{
+		return m_file->string(m_record->date_created);
+	}
+
+	std::string_view package_view::date_updated() const
+	{
+		return m_file->string(m_record->date_updated);
+	}
+
+	std::string_view package_view::uuid4() const
+	{
+		return m_file->string(m_record->uuid4);
+	}
+
+	std::optional<std::string_view> package_view::donation_link() const
+	{
+		if (!m_record->has_donation_link)
+		{
+			return std::nullopt;
+		}
+
+		return m_file->string(m_record->donation_link);
+	}
+
+	std::string_view package_view::category(size_t index) const
+	{
+		return m_file->string(m_file->m_list_entries[m_record->categories.first + index]);
+	}
+
+	package_version_view package_view::version(size_t index) const
+	{
+		return {m_file, m_file->m_versions + m_record->versions.first + index};
+	}
+
+	package package_view::to_package() const
+	{
+		package pkg{};
+		pkg.name             = name();
+		pkg.full_name        = full_name();
+		pkg.owner            = owner();
+		pkg.package_url      = package_url();
+		pkg.date_created     = date_created();
+		pkg.date_updated     = date_updated();
+		pkg.uuid4            = uuid4();
+		pkg.rating_score     = rating_score();
+		pkg.is_pinned        = is_pinned();
+		pkg.is_deprecated    = is_deprecated();
+		pkg.has_nsfw_content = has_nsfw_content();
+		if (const auto link = donation_link())
+		{
+			pkg.donation_link = std::string(*link);
+		}
+
+		pkg.categories.reserve(category_count());
+		for (size_t i = 0; i < category_count(); i++)
+		{
+			pkg.categories.emplace_back(category(i));
+		}
+
+		pkg.versions.reserve(version_count());
+		for (size_t i = 0; i < version_count(); i++)
+		{
+			pkg.versions.push_back(version(i).to_package_version());
+		}
+
+		return pkg;
+	}
+
+	catalog_file::catalog_file(const std::filesystem::path& path) :
+	    m_mapping(path)
+	{
+		if (!m_mapping.is_open() || m_mapping.size() < sizeof(header))
+		{
+			return;
+		}
+
+		const auto base = m_mapping.data();
+		const auto hdr  = (const header*)base;
+		if (hdr->magic != magic || hdr->version != version)
+		{
+			return;
+		}
+
+		const uint64_t file_size = m_mapping.size();
+		if (hdr->packages_offset + (uint64_t)hdr->package_count * sizeof(package_record) > file_size
+		    || hdr->versions_offset + (uint64_t)hdr->version_count * sizeof(version_record) > file_size
+		    || hdr->list_entries_offset + (uint64_t)hdr->list_entry_count * sizeof(string_ref) > file_size
+		    || hdr->strings_offset + hdr->strings_size > file_size)
+		{
+			return;
+		}
+
+		m_packages     = (const package_record*)(base + hdr->packages_offset);
+		m_versions     = (const version_record*)(base + hdr->versions_offset);
+		m_list_entries = (const string_ref*)(base + hdr->list_entries_offset);
+		m_strings      = (const char*)(base + hdr->strings_offset);
+		m_header       = hdr;
+
+		if (!validate())
+		{
+			m_header = nullptr;
+		}
+	}
+
+	bool catalog_file::validate() const
+	{
+		const auto is_valid_string = [this](const string_ref& ref)
+		{
+			// Strings are NUL terminated in the table, the terminator has to be in bounds too.
+			return (uint64_t)ref.offset + ref.size < m_header->strings_size && m_strings[ref.offset + ref.size] == '\0';
+		};
+
+		for (uint32_t i = 0; i < m_header->list_entry_count; i++)
+		{
+			if (!is_valid_string(m_list_entries[i]))
+			{
+				return false;
+			}
+		}
+
+		for (uint32_t i = 0; i < m_header->version_count; i++)
+		{
+			const auto& v = m_versions[i];
+			if (!is_valid_string(v.name) || !is_valid_string(v.full_name) || !is_valid_string(v.description)
+			    || !is_valid_string(v.icon) || !is_valid_string(v.version_number) || !is_valid_string(v.download_url)
+			    || !is_valid_string(v.date_created) || !is_valid_string(v.website_url) || !is_valid_string(v.uuid4)
+			    || !is_in_range(v.dependencies, m_header->list_entry_count))
+			{
+				return false;
+			}
+		}
+
+		for (uint32_t i = 0; i < m_header->package_count; i++)
+		{
+			const auto& p = m_packages[i];
+			if (!is_valid_string(p.name) || !is_valid_string(p.full_name) || !is_valid_string(p.owner)
+			    || !is_valid_string(p.package_url) || !is_valid_string(p.date_created) || !is_valid_string(p.date_updated)
+			    || !is_valid_string(p.uuid4) || !is_valid_string(p.donation_link)
+			    || !is_in_range(p.versions, m_header->version_count) || !is_in_range(p.categories, m_header->list_entry_count))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	string_ref catalog_file_writer::intern(std::string_view str)
+	{
+		const auto it = m_interned.find(std::string(str));
+		if (it != m_interned.end())
+		{
+			return it->second;
+		}
+
+		const string_ref ref{.offset = (uint32_t)m_strings.size(), .size = (uint32_t)str.size()};
+		m_strings.append(str);
+		m_strings.push_back('\0');
+		m_interned.emplace(str, ref);
+		return ref;
+	}
+
+	void catalog_file_writer::add(const package& pkg)
+	{
+		package_record record{};
+		record.name              = intern(pkg.name);
+		record.full_name         = intern(pkg.full_name);
+		record.owner             = intern(pkg.owner);
+		record.package_url       = intern(pkg.package_url);
+		record.date_created      = intern(pkg.date_created);
+		record.date_updated      = intern(pkg.date_updated);
+		record.uuid4             = intern(pkg.uuid4);
+		record.donation_link     = intern(pkg.donation_link.value_or(""));
+		record.has_donation_link = pkg.donation_link.has_value();
+		record.rating_score      = pkg.rating_score;
+		record.is_pinned         = pkg.is_pinned;
+		record.is_deprecated     = pkg.is_deprecated;
+		record.has_nsfw_content  = pkg.has_nsfw_content;
+
+		record.categories = {.first = (uint32_t)m_list_entries.size(), .count = (uint32_t)pkg.categories.size()};
+		for (const auto& category : pkg.categories)
+		{
+			m_list_entries.push_back(intern(category));
+		}
+
+		record.versions = {.first = (uint32_t)m_versions.size(), .count = (uint32_t)pkg.versions.size()};
+		for (const auto& pkg_version : pkg.versions)
+		{
+			version_record version_rec{};
+			version_rec.name           = intern(pkg_version.name);
+			version_rec.full_name      = intern(pkg_version.full_name);
+			version_rec.description    = intern(pkg_version.description);
+			version_rec.icon           = intern(pkg_version.icon);
+			version_rec.version_number = intern(pkg_version.version_number);
+			version_rec.download_url   = intern(pkg_version.download_url);
+			version_rec.date_created   = intern(pkg_version.date_created);
+			version_rec.website_url    = intern(pkg_version.website_url);
+			version_rec.uuid4          = intern(pkg_version.uuid4);
+			version_rec.downloads      = pkg_version.downloads;
+			version_rec.file_size      = pkg_version.file_size;
+			version_rec.is_active      = pkg_version.is_active;
+
+			version_rec.dependencies = {.first = (uint32_t)m_list_entries.size(), .count = (uint32_t)pkg_version.dependencies.size()};
+			for (const auto& dependency : pkg_version.dependencies)
+			{
+				m_list_entries.push_back(intern(dependency));
+			}
+
+			m_versions.push_back(version_rec);
+		}
+
+		m_packages.push_back(record);
+	}
+
+	bool catalog_file_writer::write(const std::filesystem::path& path) const
+	{
+		header hdr{};
+		hdr.magic               = magic;
+		hdr.version             = version;
+		hdr.package_count       = (uint32_t)m_packages.size();
+		hdr.version_count       = (uint32_t)m_versions.size();
+		hdr.list_entry_count    = (uint32_t)m_list_entries.size();
+		hdr.packages_offset     = align_up(sizeof(header));
+		hdr.versions_offset     = align_up(hdr.packages_offset + m_packages.size() * sizeof(package_record));
+		hdr.list_entries_offset = align_up(hdr.versions_offset + m_versions.size() * sizeof(version_record));
+		hdr.strings_offset      = align_up(hdr.list_entries_offset + m_list_entries.size() * sizeof(string_ref));
+		hdr.strings_size        = m_strings.size();
+
+		const auto tmp_path = std::filesystem::path(path).concat(".tmp");
+		{
+			std::ofstream f(tmp_path, std::ios::binary | std::ios::trunc);
+
+			const auto write_at = [&f](uint64_t offset, const void* data, size_t size)
+			{
+				static constexpr char zeroes[8] = {};
+				f.write(zeroes, offset - (uint64_t)f.tellp());
+				f.write((const char*)data, size);
+			};
+
+			write_at(0, &hdr, sizeof(hdr));
+			write_at(hdr.packages_offset, m_packages.data(), m_packages.size() * sizeof(package_record));
+			write_at(hdr.versions_offset, m_versions.data(), m_versions.size() * sizeof(version_record));
+			write_at(hdr.list_entries_offset, m_list_entries.data(), m_list_entries.size() * sizeof(string_ref));
+			write_at(hdr.strings_offset, m_strings.data(), m_strings.size());
+
+			if (!f.flush())
+			{
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmp_path, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(tmp_path, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool convert_package_index(std::istream& json_index, const std::filesystem::path& catalog_path)
+	{
+		catalog_file_writer writer;
+		const auto parsed = read_package_index(json_index,
+		                                       [&writer](package&& pkg)
+		                                       {
+			                                       writer.add(pkg);
+		                                       });
+
+		return parsed && writer.write(catalog_path);
+	}
+} // namespace ts::v1
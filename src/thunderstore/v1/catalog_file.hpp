@@ -0,0 +1,267 @@
+#pragma once
+
+#include "package.hpp"
+#include "platform/mapped_file.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Binary catalog format, meant to be memory mapped and read in place.
+//
+// [header][package records][version records][list entries][string table]
+//
+// Every string is interned once in the string table (NUL terminated) and referenced by offset,
+// versions are stored in a fixed-stride table, each package owning a contiguous range of it.
+// Category and dependency lists are ranges of string refs in the list entries table.
+namespace ts::v1::catalog_format
+{
+	inline constexpr uint32_t magic   = 0x43'4D'4D'49; // "IMMC"
+	inline constexpr uint32_t version = 1;
+
+	struct string_ref
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct range
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	struct header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t package_count;
+		uint32_t version_count;
+		uint32_t list_entry_count;
+		uint32_t reserved;
+		uint64_t packages_offset;
+		uint64_t versions_offset;
+		uint64_t list_entries_offset;
+		uint64_t strings_offset;
+		uint64_t strings_size;
+	};
+
+	struct package_record
+	{
+		string_ref name;
+		string_ref full_name;
+		string_ref owner;
+		string_ref package_url;
+		string_ref date_created;
+		string_ref date_updated;
+		string_ref uuid4;
+		string_ref donation_link;
+		int64_t rating_score;
+		range versions;
+		range categories;
+		uint8_t is_pinned;
+		uint8_t is_deprecated;
+		uint8_t has_nsfw_content;
+		uint8_t has_donation_link;
+		uint8_t padding[4];
+	};
+
+	struct version_record
+	{
+		string_ref name;
+		string_ref full_name;
+		string_ref description;
+		string_ref icon;
+		string_ref version_number;
+		string_ref download_url;
+		string_ref date_created;
+		string_ref website_url;
+		string_ref uuid4;
+		int64_t downloads;
+		int64_t file_size;
+		range dependencies;
+		uint8_t is_active;
+		uint8_t padding[7];
+	};
+} // namespace ts::v1::catalog_format
+
+namespace ts::v1
+{
+	class catalog_file;
+
+	// Read-only views over a mapped catalog_file, valid as long as the catalog_file is alive.
+	// Returned string_views are NUL terminated.
+	class package_version_view
+	{
+		const catalog_file* m_file;
+		const catalog_format::version_record* m_record;
+
+	public:
+		package_version_view(const catalog_file* file, const catalog_format::version_record* record) :
+		    m_file(file),
+		    m_record(record)
+		{
+		}
+
+		std::string_view name() const;
+		std::string_view full_name() const;
+		std::string_view description() const;
+		std::string_view icon() const;
+		std::string_view version_number() const;
+		std::string_view download_url() const;
+		std::string_view date_created() const;
+		std::string_view website_url() const;
+		std::string_view uuid4() const;
+
+		int64_t downloads() const
+		{
+			return m_record->downloads;
+		}
+
+		int64_t file_size() const
+		{
+			return m_record->file_size;
+		}
+
+		bool is_active() const
+		{
+			return m_record->is_active;
+		}
+
+		size_t dependency_count() const
+		{
+			return m_record->dependencies.count;
+		}
+
+		std::string_view dependency(size_t index) const;
+
+		package_version to_package_version() const;
+	};
+
+	class package_view
+	{
+		const catalog_file* m_file;
+		const catalog_format::package_record* m_record;
+
+	public:
+		package_view(const catalog_file* file, const catalog_format::package_record* record) :
+		    m_file(file),
+		    m_record(record)
+		{
+		}
+
+		std::string_view name() const;
+		std::string_view full_name() const;
+		std::string_view owner() const;
+		std::string_view package_url() const;
+		std::string_view date_created() const;
+		std::string_view date_updated() const;
+		std::string_view uuid4() const;
+		std::optional<std::string_view> donation_link() const;
+
+		int64_t rating_score() const
+		{
+			return m_record->rating_score;
+		}
+
+		bool is_pinned() const
+		{
+			return m_record->is_pinned;
+		}
+
+		bool is_deprecated() const
+		{
+			return m_record->is_deprecated;
+		}
+
+		bool has_nsfw_content() const
+		{
+			return m_record->has_nsfw_content;
+		}
+
+		size_t category_count() const
+		{
+			return m_record->categories.count;
+		}
+
+		std::string_view category(size_t index) const;
+
+		size_t version_count() const
+		{
+			return m_record->versions.count;
+		}
+
+		package_version_view version(size_t index) const;
+
+		package to_package() const;
+	};
+
+	class catalog_file
+	{
+		imm::platform::mapped_file m_mapping;
+		const catalog_format::header* m_header           = nullptr;
+		const catalog_format::package_record* m_packages = nullptr;
+		const catalog_format::version_record* m_versions = nullptr;
+		const catalog_format::string_ref* m_list_entries = nullptr;
+		const char* m_strings                            = nullptr;
+
+		bool validate() const;
+
+		friend class package_view;
+		friend class package_version_view;
+
+		std::string_view string(const catalog_format::string_ref& ref) const
+		{
+			return {m_strings + ref.offset, ref.size};
+		}
+
+	public:
+		// Maps the file and checks the header and every offset, is_open() is false if anything is off.
+		explicit catalog_file(const std::filesystem::path& path);
+
+		bool is_open() const
+		{
+			return m_header != nullptr;
+		}
+
+		size_t package_count() const
+		{
+			return m_header ? m_header->package_count : 0;
+		}
+
+		package_view package(size_t index) const
+		{
+			return {this, m_packages + index};
+		}
+	};
+
+	class catalog_file_writer
+	{
+		std::vector<catalog_format::package_record> m_packages;
+		std::vector<catalog_format::version_record> m_versions;
+		std::vector<catalog_format::string_ref> m_list_entries;
+		std::string m_strings;
+		std::unordered_map<std::string, catalog_format::string_ref> m_interned;
+
+		catalog_format::string_ref intern(std::string_view str);
+
+	public:
+		void add(const package& pkg);
+
+		size_t package_count() const
+		{
+			return m_packages.size();
+		}
+
+		// Written to a temporary file first, then renamed over path.
+		bool write(const std::filesystem::path& path) const;
+	};
+
+	// Converts a json /api/v1/package/ index into the binary catalog format.
+	bool convert_package_index(std::istream& json_index, const std::filesystem::path& catalog_path);
+} // namespace ts::v1
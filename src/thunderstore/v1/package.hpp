@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nlohmann/json.hpp"
+#include "string/intern_pool.hpp"
 
 #include <semver.hpp>
 
@@ -67,6 +68,23 @@ namespace nlohmann
 } // namespace nlohmann
 #endif
 
+namespace nlohmann
+{
+	template<>
+	struct adl_serializer<imm::string::interned>
+	{
+		static void to_json(json& j, const imm::string::interned& str)
+		{
+			j = str.str();
+		}
+
+		static void from_json(const json& j, imm::string::interned& str)
+		{
+			str = j.get_ref<const std::string&>();
+		}
+	};
+} // namespace nlohmann
+
 namespace ts::v1
 {
 	struct package_version
@@ -76,7 +94,7 @@ namespace ts::v1
 		std::string description;
 		std::string icon;
 		std::string version_number;
-		std::vector<std::string> dependencies;
+		std::vector<imm::string::interned> dependencies;
 		std::string download_url;
 		int64_t downloads;
 		std::string date_created;
@@ -88,16 +106,15 @@ namespace ts::v1
 		NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(package_version, name, full_name, description, icon, version_number, dependencies, download_url, downloads, date_created, website_url, is_active, uuid4, file_size)
 
 		// Extra data
-		ID3D11ShaderResourceView* icon_texture;
-		bool is_installed           = false;
-		std::string full_name_lower = "";
+		bool has_icon_file = false;
+		bool is_installed  = false;
 	};
 
 	struct package
 	{
 		std::string name;
 		std::string full_name;
-		std::string owner;
+		imm::string::interned owner;
 		std::string package_url;
 		std::string date_created{};
 		std::string date_updated{};
@@ -106,7 +123,7 @@ namespace ts::v1
 		bool is_pinned{};
 		bool is_deprecated{};
 		bool has_nsfw_content{};
-		std::vector<std::string> categories{};
+		std::vector<imm::string::interned> categories{};
 		std::vector<package_version> versions{};
 		std::optional<std::string> donation_link{};
 
@@ -115,6 +132,7 @@ namespace ts::v1
 		bool is_installed                    = false;
 		std::string installed_version_number = "";
 		bool is_local                        = false;
-		std::string full_name_lower          = "";
+		uint64_t category_mask               = 0;
+		uint32_t search_document             = 0;
 	};
 } // namespace ts::v1
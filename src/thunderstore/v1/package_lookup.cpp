@@ -0,0 +1,78 @@
+#include "package_lookup.hpp"
+
+namespace ts::v1
+{
+	void package_lookup::add(package* pkg)
+	{
+		m_packages.emplace(pkg->full_name, pkg);
+		add_versions(pkg);
+	}
+
+	void package_lookup::add_versions(package* pkg)
+	{
+		for (size_t i = 0; i < pkg->versions.size(); i++)
+		{
+			m_versions.emplace(pkg->versions[i].full_name, package_version_ref{.pkg = pkg, .version_index = i});
+		}
+	}
+
+	void package_lookup::remove_versions(package* pkg)
+	{
+		for (const auto& pkg_version : pkg->versions)
+		{
+			const auto it = m_versions.find(pkg_version.full_name);
+			if (it != m_versions.end() && it->second.pkg == pkg)
+			{
+				m_versions.erase(it);
+			}
+		}
+	}
+
+	void package_lookup::clear()
+	{
+		m_packages.clear();
+		m_versions.clear();
+	}
+
+	package* package_lookup::find_package(std::string_view full_name) const
+	{
+		package* found           = nullptr;
+		const auto [first, last] = m_packages.equal_range(full_name);
+		for (auto it = first; it != last; ++it)
+		{
+			if (!found || found->is_local)
+			{
+				found = it->second;
+			}
+		}
+		return found;
+	}
+
+	std::optional<package_version_ref> package_lookup::find_version(std::string_view version_full_name) const
+	{
+		const auto it = m_versions.find(version_full_name);
+		if (it == m_versions.end())
+		{
+			return std::nullopt;
+		}
+		return it->second;
+	}
+
+	std::optional<package_version_ref> package_lookup::find_version(std::string_view full_name, std::string_view version_number) const
+	{
+		const auto [first, last] = m_packages.equal_range(full_name);
+		for (auto it = first; it != last; ++it)
+		{
+			const auto& versions = it->second->versions;
+			for (size_t i = 0; i < versions.size(); i++)
+			{
+				if (versions[i].version_number == version_number)
+				{
+					return package_version_ref{.pkg = it->second, .version_index = i};
+				}
+			}
+		}
+
+		return std::nullopt;
+	}
+} // namespace ts::v1
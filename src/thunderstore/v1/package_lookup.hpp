@@ -0,0 +1,44 @@
+#pragma once
+
+#include "package.hpp"
+
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+namespace ts::v1
+{
+	struct package_version_ref
+	{
+		package* pkg;
+		size_t version_index;
+	};
+
+	// Lookups by "Owner-Name" and by "Owner-Name-x.y.z". Keys view the strings of the packages themselves,
+	// so a package has to be removed before its versions are replaced and the lookup cleared before packages are freed.
+	// A local package can share its full name with a catalog one, hence the multimap.
+	// Version names are unique, the first package added wins like the linear scans this replaced.
+	// Not synchronized, it is guarded by whatever guards the packages.
+	class package_lookup
+	{
+		std::unordered_multimap<std::string_view, package*> m_packages;
+		std::unordered_map<std::string_view, package_version_ref> m_versions;
+
+	public:
+		void add(package* pkg);
+
+		// Around replacing the versions of an added package.
+		void remove_versions(package* pkg);
+		void add_versions(package* pkg);
+
+		void clear();
+
+		// Local packages can't be downloaded, the catalog one of the same name is preferred.
+		package* find_package(std::string_view full_name) const;
+
+		std::optional<package_version_ref> find_version(std::string_view version_full_name) const;
+
+		// First package named full_name that has version_number.
+		std::optional<package_version_ref> find_version(std::string_view full_name, std::string_view version_number) const;
+	};
+} // namespace ts::v1
@@ -0,0 +1,304 @@
+#include "package_reader.hpp"
+
+#include <vector>
+
+namespace ts::v1
+{
+	namespace
+	{
+		class package_sax
+		{
+			using json = nlohmann::json;
+
+			enum class scope
+			{
+				root,
+				package,
+				categories,
+				versions,
+				version,
+				dependencies,
+				skip,
+			};
+
+			const package_callback& m_on_package;
+
+			std::vector<scope> m_scopes;
+			std::string m_key;
+
+			package m_package{};
+			package_version m_version{};
+
+			scope top() const
+			{
+				return m_scopes.empty() ? scope::root : m_scopes.back();
+			}
+
+			scope child_scope(bool is_array) const
+			{
+				switch (top())
+				{
+				case scope::root:
+					if (m_scopes.empty())
+					{
+						return is_array ? scope::root : scope::skip;
+					}
+					return is_array ? scope::skip : scope::package;
+				case scope::package:
+					if (is_array && m_key == "categories")
+					{
+						return scope::categories;
+					}
+					if (is_array && m_key == "versions")
+					{
+						return scope::versions;
+					}
+					return scope::skip;
+				case scope::versions:    return is_array ? scope::skip : scope::version;
+				case scope::version:     return is_array && m_key == "dependencies" ? scope::dependencies : scope::skip;
+				default:                 return scope::skip;
+				}
+			}
+
+			bool open(bool is_array)
+			{
+				const auto child = child_scope(is_array);
+				if (child == scope::package)
+				{
+					m_package = {};
+				}
+				else if (child == scope::version)
+				{
+					m_version = {};
+				}
+
+				m_scopes.push_back(child);
+				return true;
+			}
+
+			bool close()
+			{
+				const auto closed = top();
+				m_scopes.pop_back();
+
+				if (closed == scope::package)
+				{
+					m_on_package(std::move(m_package));
+				}
+				else if (closed == scope::version)
+				{
+					m_package.versions.push_back(std::move(m_version));
+				}
+
+				return true;
+			}
+
+			void on_string(std::string&& val)
+			{
+				switch (top())
+				{
+				case scope::package:
+					if (m_key == "name")
+					{
+						m_package.name = std::move(val);
+					}
+					else if (m_key == "full_name")
+					{
+						m_package.full_name = std::move(val);
+					}
+					else if (m_key == "owner")
+					{
+						m_package.owner = std::move(val);
+					}
+					else if (m_key == "package_url")
+					{
+						m_package.package_url = std::move(val);
+					}
+					else if (m_key == "date_created")
+					{
+						m_package.date_created = std::move(val);
+					}
+					else if (m_key == "date_updated")
+					{
+						m_package.date_updated = std::move(val);
+					}
+					else if (m_key == "uuid4")
+					{
+						m_package.uuid4 = std::move(val);
+					}
+					else if (m_key == "donation_link")
+					{
+						m_package.donation_link = std::move(val);
+					}
+					break;
+				case scope::version:
+					if (m_key == "name")
+					{
+						m_version.name = std::move(val);
+					}
+					else if (m_key == "full_name")
+					{
+						m_version.full_name = std::move(val);
+					}
+					else if (m_key == "description")
+					{
+						m_version.description = std::move(val);
+					}
+					else if (m_key == "icon")
+					{
+						m_version.icon = std::move(val);
+					}
+					else if (m_key == "version_number")
+					{
+						m_version.version_number = std::move(val);
+					}
+					else if (m_key == "download_url")
+					{
+						m_version.download_url = std::move(val);
+					}
+					else if (m_key == "date_created")
+					{
+						m_version.date_created = std::move(val);
+					}
+					else if (m_key == "website_url")
+					{
+						m_version.website_url = std::move(val);
+					}
+					else if (m_key == "uuid4")
+					{
+						m_version.uuid4 = std::move(val);
+					}
+					break;
+				case scope::categories:   m_package.categories.push_back(std::move(val)); break;
+				case scope::dependencies: m_version.dependencies.push_back(std::move(val)); break;
+				default:                  break;
+				}
+			}
+
+			void on_integer(int64_t val)
+			{
+				if (top() == scope::package && m_key == "rating_score")
+				{
+					m_package.rating_score = val;
+				}
+				else if (top() == scope::version)
+				{
+					if (m_key == "downloads")
+					{
+						m_version.downloads = val;
+					}
+					else if (m_key == "file_size")
+					{
+						m_version.file_size = val;
+					}
+				}
+			}
+
+			void on_boolean(bool val)
+			{
+				if (top() == scope::package)
+				{
+					if (m_key == "is_pinned")
+					{
+						m_package.is_pinned = val;
+					}
+					else if (m_key == "is_deprecated")
+					{
+						m_package.is_deprecated = val;
+					}
+					else if (m_key == "has_nsfw_content")
+					{
+						m_package.has_nsfw_content = val;
+					}
+				}
+				else if (top() == scope::version && m_key == "is_active")
+				{
+					m_version.is_active = val;
+				}
+			}
+
+		public:
+			explicit package_sax(const package_callback& on_package) :
+			    m_on_package(on_package)
+			{
+			}
+
+			bool null()
+			{
+				return true;
+			}
+
+			bool boolean(bool val)
+			{
+				on_boolean(val);
+				return true;
+			}
+
+			bool number_integer(json::number_integer_t val)
+			{
+				on_integer(val);
+				return true;
+			}
+
+			bool number_unsigned(json::number_unsigned_t val)
+			{
+				on_integer((int64_t)val);
+				return true;
+			}
+
+			bool number_float(json::number_float_t val, const json::string_t&)
+			{
+				on_integer((int64_t)val);
+				return true;
+			}
+
+			bool string(json::string_t& val)
+			{
+				on_string(std::move(val));
+				return true;
+			}
+
+			bool binary(json::binary_t&)
+			{
+				return true;
+			}
+
+			bool start_object(size_t)
+			{
+				return open(false);
+			}
+
+			bool key(json::string_t& val)
+			{
+				m_key = val;
+				return true;
+			}
+
+			bool end_object()
+			{
+				return close();
+			}
+
+			bool start_array(size_t)
+			{
+				return open(true);
+			}
+
+			bool end_array()
+			{
+				return close();
+			}
+
+			bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&)
+			{
+				return false;
+			}
+		};
+	} // namespace
+
+	bool read_package_index(std::istream& stream, const package_callback& on_package)
+	{
+		package_sax sax(on_package);
+		return nlohmann::json::sax_parse(stream, &sax, nlohmann::json::input_format_t::json, true, true);
+	}
+} // namespace ts::v1
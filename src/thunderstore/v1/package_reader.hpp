@@ -0,0 +1,17 @@
+#pragma once
+
+#include "package.hpp"
+
+#include <functional>
+#include <istream>
+
+namespace ts::v1
+{
+	using package_callback = std::function<void(package&&)>;
+
+	// SAX ingest of a /api/v1/package/ index.
+	// Each package is handed to on_package as soon as its closing brace is read,
+	// no json DOM of the whole index is ever built.
+	// Returns false if the stream is not a well formed package array.
+	bool read_package_index(std::istream& stream, const package_callback& on_package);
+} // namespace ts::v1
@@ -0,0 +1,169 @@
+#include "icons/atlas_packer.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+using imm::icons::atlas_packer;
+
+namespace
+{
+	// 2x2 cells per page.
+	constexpr uint32_t page_size = 256;
+	constexpr uint32_t cell_size = 128;
+
+	std::optional<imm::icons::atlas_slot> allocate(atlas_packer& packer, uint64_t id, uint64_t frame, uint64_t min_protected_frame, std::optional<uint64_t>* evicted = nullptr)
+	{
+		std::optional<uint64_t> evicted_id;
+		auto slot = packer.allocate(id, frame, min_protected_frame, evicted_id);
+		if (evicted)
+		{
+			*evicted = evicted_id;
+		}
+		return slot;
+	}
+} // namespace
+
+TEST(atlas_packer, grows_page_by_page_up_to_the_budget)
+{
+	atlas_packer packer(page_size, cell_size, 2);
+	EXPECT_EQ(packer.page_count(), 0u);
+
+	for (uint64_t id = 1; id <= 4; id++)
+	{
+		ASSERT_TRUE(allocate(packer, id, 1, 0));
+	}
+	EXPECT_EQ(packer.page_count(), 1u);
+
+	const auto slot = allocate(packer, 5, 1, 0);
+	ASSERT_TRUE(slot);
+	EXPECT_EQ(slot->page, 1u);
+	EXPECT_EQ(packer.page_count(), 2u);
+	EXPECT_EQ(packer.used_cell_count(), 5u);
+}
+
+TEST(atlas_packer, evicts_the_least_recently_used_once_the_budget_is_reached)
+{
+	atlas_packer packer(page_size, cell_size, 1);
+	for (uint64_t id = 1; id <= 4; id++)
+	{
+		ASSERT_TRUE(allocate(packer, id, id, 0));
+	}
+
+	// 1 is the oldest but was drawn again since, 2 is now the least recently used.
+	packer.touch(1, 10);
+
+	std::optional<uint64_t> evicted;
+	const auto slot = allocate(packer, 5, 11, 11, &evicted);
+	ASSERT_TRUE(slot);
+	EXPECT_EQ(evicted, 2u);
+	EXPECT_FALSE(packer.find(2));
+	EXPECT_TRUE(packer.find(1));
+	EXPECT_EQ(packer.page_count(), 1u);
+	EXPECT_EQ(packer.used_cell_count(), 4u);
+}
+
+TEST(atlas_packer, never_evicts_icons_drawn_in_protected_frames)
+{
+	atlas_packer packer(page_size, cell_size, 1);
+	for (uint64_t id = 1; id <= 4; id++)
+	{
+		ASSERT_TRUE(allocate(packer, id, 10, 0));
+	}
+
+	// Everything was drawn in frame 10, which is still on screen.
+	std::optional<uint64_t> evicted;
+	EXPECT_FALSE(allocate(packer, 5, 11, 10, &evicted));
+	EXPECT_FALSE(evicted);
+	EXPECT_EQ(packer.used_cell_count(), 4u);
+
+	EXPECT_TRUE(allocate(packer, 5, 12, 11, &evicted));
+	EXPECT_TRUE(evicted);
+}
+
+TEST(atlas_packer, allocating_a_resident_id_keeps_its_slot)
+{
+	atlas_packer packer(page_size, cell_size, 1);
+	const auto first = allocate(packer, 7, 1, 0);
+	ASSERT_TRUE(first);
+
+	const auto again = allocate(packer, 7, 2, 0);
+	ASSERT_TRUE(again);
+	EXPECT_EQ(again->page, first->page);
+	EXPECT_EQ(again->x, first->x);
+	EXPECT_EQ(again->y, first->y);
+	EXPECT_EQ(packer.used_cell_count(), 1u);
+}
+
+TEST(atlas_packer, repack_fills_holes_and_drops_empty_pages)
+{
+	atlas_packer packer(page_size, cell_size, 3);
+	for (uint64_t id = 1; id <= 9; id++)
+	{
+		ASSERT_TRUE(allocate(packer, id, 1, 0));
+	}
+	EXPECT_EQ(packer.page_count(), 3u);
+
+	for (const uint64_t id : {1, 2, 3, 4, 6})
+	{
+		packer.release(id);
+	}
+
+	const auto moves = packer.repack();
+	EXPECT_EQ(packer.page_count(), 1u);
+	EXPECT_EQ(packer.used_cell_count(), 4u);
+
+	for (const auto& move : moves)
+	{
+		const auto slot = packer.find(move.id);
+		ASSERT_TRUE(slot);
+		EXPECT_EQ(slot->page, move.to.page);
+		EXPECT_EQ(slot->x, move.to.x);
+		EXPECT_EQ(slot->y, move.to.y);
+	}
+	for (const uint64_t id : {5, 7, 8, 9})
+	{
+		const auto slot = packer.find(id);
+		ASSERT_TRUE(slot);
+		EXPECT_EQ(slot->page, 0u);
+	}
+}
+
+TEST(atlas_packer, page_bytes_count_the_mip_chain)
+{
+	constexpr uint64_t mib = 1024 * 1024;
+	EXPECT_EQ(imm::icons::atlas_page_bytes(2048, 1), 16 * mib);
+	// 2048, 1024, 512 and 256 squared, 4 bytes each.
+	EXPECT_EQ(imm::icons::atlas_page_bytes(2048, 4), 16 * mib + 4 * mib + 1 * mib + mib / 4);
+
+	// The icon cache budget: four pages would be 85 MiB with their mips, only three fit.
+	EXPECT_EQ(64 * mib / imm::icons::atlas_page_bytes(2048, 4), 3u);
+
+	// Levels past 1x1 don't exist.
+	EXPECT_EQ(imm::icons::atlas_page_bytes(2, 8), 2 * 2 * 4 + 4u);
+}
+
+TEST(atlas_packer, released_idle_cells_let_repack_drop_pages)
+{
+	atlas_packer packer(page_size, cell_size, 2);
+	for (uint64_t id = 1; id <= 8; id++)
+	{
+		ASSERT_TRUE(allocate(packer, id, 1, 0));
+	}
+	EXPECT_EQ(packer.page_count(), 2u);
+
+	// Only 2 and 7 are still drawn.
+	packer.touch(2, 20);
+	packer.touch(7, 20);
+
+	auto released = packer.release_unused(10);
+	std::sort(released.begin(), released.end());
+	EXPECT_EQ(released, (std::vector<uint64_t>{1, 3, 4, 5, 6, 8}));
+	EXPECT_EQ(packer.used_cell_count(), 2u);
+	EXPECT_FALSE(packer.find(1));
+
+	packer.repack();
+	EXPECT_EQ(packer.page_count(), 1u);
+	EXPECT_TRUE(packer.find(2));
+	EXPECT_TRUE(packer.find(7));
+	EXPECT_TRUE(packer.release_unused(10).empty());
+}
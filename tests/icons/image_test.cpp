@@ -0,0 +1,91 @@
+#include "icons/image.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using imm::icons::rgba_image;
+
+namespace
+{
+	rgba_image random_image(int width, int height, uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		rgba_image image{.width = width, .height = height};
+		image.pixels.resize((size_t)width * height * 4);
+		for (auto& byte : image.pixels)
+		{
+			byte = (uint8_t)rng();
+		}
+		return image;
+	}
+
+	// Every value pair the kernels can see, so rounding is checked exhaustively rather than by chance.
+	rgba_image every_channel_alpha_pair()
+	{
+		rgba_image image{.width = 256, .height = 256};
+		image.pixels.resize(256 * 256 * 4);
+		for (int alpha = 0; alpha < 256; alpha++)
+		{
+			for (int value = 0; value < 256; value++)
+			{
+				uint8_t* p = image.pixels.data() + ((size_t)alpha * 256 + value) * 4;
+				p[0]       = (uint8_t)value;
+				p[1]       = (uint8_t)(255 - value);
+				p[2]       = (uint8_t)(value ^ alpha);
+				p[3]       = (uint8_t)alpha;
+			}
+		}
+		return image;
+	}
+
+	// Sizes around the 16 byte SSE2 lanes, odd ones included, so the scalar tails are covered too.
+	const std::pair<int, int> sizes[] = {{1, 1}, {2, 2}, {3, 5}, {4, 4}, {5, 3}, {7, 9}, {8, 8}, {17, 6}, {33, 31}, {128, 128}, {255, 129}};
+} // namespace
+
+TEST(image, premultiply_alpha_matches_the_scalar_reference)
+{
+	auto simd      = every_channel_alpha_pair();
+	auto reference = simd;
+	imm::icons::premultiply_alpha(simd);
+	imm::icons::reference::premultiply_alpha(reference);
+	EXPECT_EQ(simd.pixels, reference.pixels);
+
+	uint32_t seed = 1;
+	for (const auto [width, height] : sizes)
+	{
+		auto simd      = random_image(width, height, seed++);
+		auto reference = simd;
+		imm::icons::premultiply_alpha(simd);
+		imm::icons::reference::premultiply_alpha(reference);
+		EXPECT_EQ(simd.pixels, reference.pixels) << width << "x" << height;
+	}
+}
+
+TEST(image, downsample_2x_matches_the_scalar_reference)
+{
+	const auto pairs = every_channel_alpha_pair();
+	EXPECT_EQ(imm::icons::downsample_2x(pairs).pixels, imm::icons::reference::downsample_2x(pairs).pixels);
+
+	uint32_t seed = 100;
+	for (const auto [width, height] : sizes)
+	{
+		const auto image     = random_image(width, height, seed++);
+		const auto simd      = imm::icons::downsample_2x(image);
+		const auto reference = imm::icons::reference::downsample_2x(image);
+		EXPECT_EQ(simd.width, reference.width);
+		EXPECT_EQ(simd.height, reference.height);
+		EXPECT_EQ(simd.pixels, reference.pixels) << width << "x" << height;
+	}
+}
+
+TEST(image, mip_chain_halves_every_level)
+{
+	const auto mips = imm::icons::build_mip_chain(random_image(128, 128, 7), 4);
+	ASSERT_EQ(mips.size(), 4u);
+	for (size_t level = 0; level < mips.size(); level++)
+	{
+		EXPECT_EQ(mips[level].width, 128 >> level);
+		EXPECT_EQ(mips[level].height, 128 >> level);
+		EXPECT_EQ(mips[level].pixels.size(), (size_t)(128 >> level) * (128 >> level) * 4);
+	}
+}
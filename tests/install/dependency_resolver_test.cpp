@@ -0,0 +1,269 @@
+#include "install/dependency_resolver.hpp"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+	using imm::install::install_plan;
+
+	// Packages by "Owner-Name", versions are given newest first like the catalog lists them.
+	class synthetic_catalog
+	{
+		std::unordered_map<std::string, std::unique_ptr<ts::v1::package>> m_packages;
+		std::unordered_map<std::string, std::string> m_installed;
+
+	public:
+		struct version
+		{
+			std::string version_number;
+			std::vector<std::string> dependencies;
+		};
+
+		ts::v1::package& add(const std::string& full_name, std::vector<version> versions)
+		{
+			auto& pkg      = m_packages[full_name];
+			pkg            = std::make_unique<ts::v1::package>();
+			pkg->full_name = full_name;
+			for (auto& v : versions)
+			{
+				auto& pkg_version          = pkg->versions.emplace_back();
+				pkg_version.full_name      = full_name + "-" + v.version_number;
+				pkg_version.version_number = v.version_number;
+				for (const auto& dependency : v.dependencies)
+				{
+					pkg_version.dependencies.emplace_back(dependency);
+				}
+			}
+			return *pkg;
+		}
+
+		void install(const std::string& full_name, const std::string& version_number)
+		{
+			m_installed[full_name] = version_number;
+		}
+
+		install_plan resolve(const std::string& full_name, size_t version_index = 0) const
+		{
+			const imm::install::resolver_catalog catalog{
+			    .find_package = [this](std::string_view package_full_name) -> const ts::v1::package*
+			    {
+				    const auto it = m_packages.find(std::string(package_full_name));
+				    return it != m_packages.end() ? it->second.get() : nullptr;
+			    },
+			    .installed_version = [this](std::string_view package_full_name) -> std::optional<std::string>
+			    {
+				    const auto it = m_installed.find(std::string(package_full_name));
+				    if (it == m_installed.end())
+				    {
+					    return std::nullopt;
+				    }
+				    return it->second;
+			    },
+			};
+			return imm::install::resolve_install_plan(*m_packages.at(full_name), version_index, catalog);
+		}
+	};
+
+	// "Owner-Name-x.y.z" of every step, in plan order.
+	std::vector<std::string> step_names(const install_plan& plan)
+	{
+		std::vector<std::string> names;
+		for (const auto& step : plan.steps)
+		{
+			names.push_back(step.pkg->versions[step.version_index].full_name);
+		}
+		return names;
+	}
+
+	size_t step_of(const install_plan& plan, const std::string& full_name)
+	{
+		for (size_t i = 0; i < plan.steps.size(); i++)
+		{
+			if (plan.steps[i].pkg->full_name == full_name)
+			{
+				return i;
+			}
+		}
+		ADD_FAILURE() << full_name << " is not in the plan";
+		return 0;
+	}
+
+	bool has_conflict_about(const install_plan& plan, std::string_view text)
+	{
+		for (const auto& conflict : plan.conflicts)
+		{
+			if (conflict.contains(text))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+} // namespace
+
+TEST(dependency_resolver, parses_dependency_strings)
+{
+	const auto parsed = imm::install::parse_dependency("Some-Owner-Mod-1.2.3");
+	ASSERT_TRUE(parsed);
+	EXPECT_EQ(parsed->package_full_name, "Some-Owner-Mod");
+	EXPECT_EQ(parsed->version_number, "1.2.3");
+
+	EXPECT_FALSE(imm::install::parse_dependency("NoVersion"));
+	EXPECT_FALSE(imm::install::parse_dependency("-1.0.0"));
+	EXPECT_FALSE(imm::install::parse_dependency("Owner-Mod-"));
+}
+
+TEST(dependency_resolver, plans_dependencies_first_with_the_newest_compatible_version)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Lib-1.0.0"}}});
+	catalog.add("B-Lib", {{"2.0.0", {}}, {"1.2.0", {"C-Core-1.0.0"}}, {"1.0.0", {}}});
+	catalog.add("C-Core", {{"1.0.1", {}}, {"1.0.0", {}}});
+
+	const auto plan = catalog.resolve("A-Root");
+	ASSERT_TRUE(plan.ok()) << plan.conflicts[0];
+	EXPECT_EQ(step_names(plan), (std::vector<std::string>{"C-Core-1.0.1", "B-Lib-1.2.0", "A-Root-1.0.0"}));
+	EXPECT_EQ(plan.steps[1].depends_on, std::vector<size_t>{0});
+	EXPECT_EQ(plan.steps[2].depends_on, std::vector<size_t>{1});
+}
+
+TEST(dependency_resolver, diamond_plans_the_shared_dependency_once)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Left-1.0.0", "C-Right-1.0.0"}}});
+	catalog.add("B-Left", {{"1.0.0", {"D-Shared-1.0.0"}}});
+	catalog.add("C-Right", {{"1.0.0", {"D-Shared-1.1.0"}}});
+	catalog.add("D-Shared", {{"1.2.0", {}}, {"1.1.0", {}}, {"1.0.0", {}}});
+
+	const auto plan = catalog.resolve("A-Root");
+	ASSERT_TRUE(plan.ok()) << plan.conflicts[0];
+	ASSERT_EQ(plan.steps.size(), 4);
+
+	const auto shared = step_of(plan, "D-Shared");
+	EXPECT_EQ(plan.steps[shared].pkg->versions[plan.steps[shared].version_index].version_number, "1.2.0");
+	EXPECT_EQ(plan.steps[step_of(plan, "B-Left")].depends_on, std::vector<size_t>{shared});
+	EXPECT_EQ(plan.steps[step_of(plan, "C-Right")].depends_on, std::vector<size_t>{shared});
+	EXPECT_EQ(step_of(plan, "A-Root"), 3);
+}
+
+TEST(dependency_resolver, diamond_upgrades_an_installed_dependency_one_side_outgrew)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Left-1.0.0", "C-Right-1.0.0"}}});
+	catalog.add("B-Left", {{"1.0.0", {"D-Shared-1.0.0"}}});
+	catalog.add("C-Right", {{"1.0.0", {"D-Shared-1.1.0"}}});
+	catalog.add("D-Shared", {{"1.1.0", {}}, {"1.0.0", {}}});
+	catalog.install("D-Shared", "1.0.0");
+
+	// B is fine with the installed D, C is not, so both end up on the planned 1.1.0.
+	const auto plan = catalog.resolve("A-Root");
+	ASSERT_TRUE(plan.ok()) << plan.conflicts[0];
+
+	const auto shared = step_of(plan, "D-Shared");
+	EXPECT_EQ(plan.steps[shared].pkg->versions[plan.steps[shared].version_index].version_number, "1.1.0");
+	EXPECT_EQ(plan.steps[step_of(plan, "B-Left")].depends_on, std::vector<size_t>{shared});
+	EXPECT_EQ(plan.steps[step_of(plan, "C-Right")].depends_on, std::vector<size_t>{shared});
+}
+
+TEST(dependency_resolver, leaves_out_installed_packages_and_their_dependencies)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Lib-1.0.0"}}});
+	catalog.add("B-Lib", {{"1.1.0", {"C-Core-1.0.0"}}});
+	catalog.add("C-Core", {{"1.0.0", {}}});
+	catalog.install("B-Lib", "1.0.5");
+
+	const auto plan = catalog.resolve("A-Root");
+	ASSERT_TRUE(plan.ok());
+	EXPECT_EQ(step_names(plan), std::vector<std::string>{"A-Root-1.0.0"});
+}
+
+TEST(dependency_resolver, breaks_cycles_at_the_closing_edge)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Lib-1.0.0"}}});
+	catalog.add("B-Lib", {{"1.0.0", {"C-Core-1.0.0"}}});
+	catalog.add("C-Core", {{"1.0.0", {"A-Root-1.0.0", "C-Core-1.0.0"}}});
+
+	const auto plan = catalog.resolve("A-Root");
+	ASSERT_TRUE(plan.ok()) << plan.conflicts[0];
+	EXPECT_EQ(step_names(plan), (std::vector<std::string>{"C-Core-1.0.0", "B-Lib-1.0.0", "A-Root-1.0.0"}));
+	EXPECT_TRUE(plan.steps[0].depends_on.empty());
+}
+
+TEST(dependency_resolver, reports_major_version_conflicts)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"B-Left-1.0.0", "C-Right-1.0.0"}}});
+	catalog.add("B-Left", {{"1.0.0", {"D-Shared-1.0.0"}}});
+	catalog.add("C-Right", {{"1.0.0", {"D-Shared-2.0.0"}}});
+	catalog.add("D-Shared", {{"2.0.0", {}}, {"1.0.0", {}}});
+
+	const auto plan = catalog.resolve("A-Root");
+	EXPECT_FALSE(plan.ok());
+	EXPECT_TRUE(has_conflict_about(plan, "D-Shared"));
+}
+
+TEST(dependency_resolver, reports_missing_packages_versions_and_bad_strings)
+{
+	synthetic_catalog catalog;
+	catalog.add("A-Root", {{"1.0.0", {"X-Unknown-1.0.0", "B-Lib-1.5.0", "garbage"}}});
+	catalog.add("B-Lib", {{"1.4.0", {}}, {"1.0.0", {}}});
+
+	const auto plan = catalog.resolve("A-Root");
+	EXPECT_FALSE(plan.ok());
+	EXPECT_TRUE(has_conflict_about(plan, "X-Unknown, needed by A-Root-1.0.0, is not in the catalog"));
+	EXPECT_TRUE(has_conflict_about(plan, "B-Lib: no version compatible with 1.5.0"));
+	EXPECT_TRUE(has_conflict_about(plan, "malformed dependency garbage"));
+
+	EXPECT_FALSE(catalog.resolve("A-Root", 3).ok());
+}
+
+TEST(dependency_resolver, random_catalogs_give_well_formed_plans)
+{
+	std::mt19937 rng(7);
+	for (int round = 0; round < 20; round++)
+	{
+		// Any package may depend on any other, cycles included, versions 1.0.0 to 1.3.0.
+		constexpr size_t package_count = 300;
+		synthetic_catalog catalog;
+		for (size_t i = 0; i < package_count; i++)
+		{
+			std::vector<synthetic_catalog::version> versions;
+			for (int v = 3; v >= 0; v--)
+			{
+				auto& version          = versions.emplace_back();
+				version.version_number = "1." + std::to_string(v) + ".0";
+				for (size_t d = 0, n = rng() % 4; d < n; d++)
+				{
+					version.dependencies.push_back("P-" + std::to_string(rng() % package_count) + "-1." + std::to_string(rng() % 4) + ".0");
+				}
+			}
+			catalog.add("P-" + std::to_string(i), std::move(versions));
+
+			if (rng() % 5 == 0)
+			{
+				catalog.install("P-" + std::to_string(i), "1." + std::to_string(rng() % 4) + ".0");
+			}
+		}
+
+		const auto plan = catalog.resolve("P-0");
+		ASSERT_TRUE(plan.ok()) << plan.conflicts[0];
+		ASSERT_FALSE(plan.steps.empty());
+		EXPECT_EQ(plan.steps.back().pkg->full_name, "P-0");
+
+		std::unordered_set<std::string> planned;
+		for (size_t i = 0; i < plan.steps.size(); i++)
+		{
+			EXPECT_TRUE(planned.insert(plan.steps[i].pkg->full_name).second) << plan.steps[i].pkg->full_name << " planned twice";
+			for (const auto dependency : plan.steps[i].depends_on)
+			{
+				EXPECT_LT(dependency, i);
+			}
+		}
+	}
+}
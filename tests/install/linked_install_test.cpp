@@ -0,0 +1,57 @@
+#include "install/linked_install.hpp"
+#include "support/temp_folder.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace
+{
+	void write_file(const std::filesystem::path& path, const std::string& content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+	}
+
+	std::string read_file(const std::filesystem::path& path)
+	{
+		std::ifstream in(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), {});
+	}
+} // namespace
+
+TEST(linked_install, places_every_plugin_folder)
+{
+	const imm::test::temp_folder temp;
+	const auto source = imm::install::extracted_plugin_folders(temp / "extracted");
+	write_file(source.plugins / "Mod.dll", "dll");
+	write_file(source.plugins_data / "save.dat", "data");
+	write_file(source.config / "Mod.cfg", "cfg");
+
+	const imm::install::plugin_folders folders{.plugins = temp / "plugins", .plugins_data = temp / "plugins_data", .config = temp / "config"};
+	const auto stats = imm::install::install_extracted(temp / "extracted", folders);
+	EXPECT_EQ(stats.failed, 0u);
+	EXPECT_EQ(stats.reflinked + stats.hard_linked + stats.copied, 3u);
+
+	EXPECT_EQ(read_file(folders.plugins / "Mod.dll"), "dll");
+	EXPECT_EQ(read_file(folders.plugins_data / "save.dat"), "data");
+	EXPECT_EQ(read_file(folders.config / "Mod.cfg"), "cfg");
+}
+
+TEST(linked_install, writable_folders_are_never_hard_linked)
+{
+	const imm::test::temp_folder temp;
+	const auto source = imm::install::extracted_plugin_folders(temp / "extracted");
+	write_file(source.plugins_data / "save.dat", "data");
+	write_file(source.config / "Mod.cfg", "cfg");
+
+	const imm::install::plugin_folders folders{.plugins = temp / "plugins", .plugins_data = temp / "plugins_data", .config = temp / "config"};
+	const auto stats = imm::install::install_extracted(temp / "extracted", folders);
+	EXPECT_EQ(stats.hard_linked, 0u);
+
+	// What mods and users do to these files at runtime.
+	std::ofstream(folders.plugins_data / "save.dat", std::ios::binary | std::ios::app) << " changed";
+	std::ofstream(folders.config / "Mod.cfg", std::ios::binary | std::ios::app) << " changed";
+
+	EXPECT_EQ(read_file(source.plugins_data / "save.dat"), "data");
+	EXPECT_EQ(read_file(source.config / "Mod.cfg"), "cfg");
+}
@@ -0,0 +1,149 @@
+#include "install/manifest_index.hpp"
+#include "install/transaction.hpp"
+#include "support/temp_folder.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace
+{
+	void write_file(const std::filesystem::path& path, const std::string& content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+	}
+
+	// A mod as installed: the manifest, a dll and a nested assets folder.
+	void write_mod(const std::filesystem::path& plugins, const std::string& name, const std::string& version, const char* manifest_filename = "manifest.json")
+	{
+		const auto folder = plugins / ("Owner-" + name);
+		write_file(folder / manifest_filename, R"({"name": ")" + name + R"(", "version_number": ")" + version + R"(", "website_url": "", "description": "", "dependencies": []})");
+		write_file(folder / (name + ".dll"), "dll");
+		write_file(folder / "assets" / "textures" / "icon.png", "png");
+	}
+
+	std::vector<std::string> names(const std::vector<imm::install::scanned_manifest>& manifests)
+	{
+		std::vector<std::string> result;
+		for (const auto& scanned : manifests)
+		{
+			result.push_back(scanned.manifest.name + " " + scanned.manifest.version_number + " " + scanned.path.filename().string());
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	const auto skip_transaction_paths = [](const std::filesystem::path& directory)
+	{
+		return imm::install::is_transaction_path(directory);
+	};
+} // namespace
+
+TEST(manifest_index, first_scan_parses_everything)
+{
+	const imm::test::temp_folder temp;
+	const auto plugins = temp / "plugins";
+	write_mod(plugins, "A", "1.0.0");
+	write_mod(plugins, "B", "2.0.0", "manifest_disabled.json");
+	write_file(plugins / "Owner-Broken" / "manifest.json", "{ not json");
+
+	imm::install::manifest_index index(temp / "index.json");
+	EXPECT_EQ(names(index.scan(plugins, skip_transaction_paths)), (std::vector<std::string>{"A 1.0.0 manifest.json", "B 2.0.0 manifest_disabled.json"}));
+
+	const auto stats = index.last_stats();
+	EXPECT_EQ(stats.reused_directories, 0u);
+	EXPECT_EQ(stats.parsed_manifests, 3u);
+	EXPECT_EQ(stats.reused_manifests, 0u);
+}
+
+TEST(manifest_index, unchanged_rescan_lists_and_parses_nothing)
+{
+	const imm::test::temp_folder temp;
+	const auto plugins = temp / "plugins";
+	for (const auto& name : {"A", "B", "C"})
+	{
+		write_mod(plugins, name, "1.0.0");
+	}
+
+	std::vector<std::string> first;
+	{
+		imm::install::manifest_index index(temp / "index.json");
+		first = names(index.scan(plugins, skip_transaction_paths));
+	}
+
+	// A new run, loaded from index.json.
+	imm::install::manifest_index index(temp / "index.json");
+	EXPECT_EQ(names(index.scan(plugins, skip_transaction_paths)), first);
+
+	const auto stats = index.last_stats();
+	EXPECT_EQ(stats.listed_directories, 0u);
+	EXPECT_EQ(stats.parsed_manifests, 0u);
+	EXPECT_EQ(stats.reused_manifests, 3u);
+}
+
+TEST(manifest_index, rescan_after_an_install_only_lists_what_changed)
+{
+	const imm::test::temp_folder temp;
+	const auto plugins = temp / "plugins";
+	for (int i = 0; i < 50; i++)
+	{
+		write_mod(plugins, "Mod" + std::to_string(i), "1.0.0");
+	}
+
+	imm::install::manifest_index index(temp / "index.json");
+	index.scan(plugins, skip_transaction_paths);
+
+	write_mod(plugins, "New", "1.0.0");
+	const auto manifests = index.scan(plugins, skip_transaction_paths);
+	EXPECT_EQ(manifests.size(), 51u);
+
+	// The plugins folder and the three folders of the new mod.
+	const auto stats = index.last_stats();
+	EXPECT_EQ(stats.listed_directories, 4u);
+	EXPECT_EQ(stats.parsed_manifests, 1u);
+	EXPECT_EQ(stats.reused_manifests, 50u);
+}
+
+TEST(manifest_index, edits_disables_and_removals_are_picked_up)
+{
+	const imm::test::temp_folder temp;
+	const auto plugins = temp / "plugins";
+	write_mod(plugins, "A", "1.0.0");
+	write_mod(plugins, "B", "1.0.0");
+	write_mod(plugins, "C", "1.0.0");
+
+	imm::install::manifest_index index(temp / "index.json");
+	index.scan(plugins, skip_transaction_paths);
+
+	// Updated in place, a different size so the change shows whatever the mtime resolution.
+	write_mod(plugins, "A", "1.10.0");
+	std::filesystem::rename(plugins / "Owner-B" / "manifest.json", plugins / "Owner-B" / "manifest_disabled.json");
+	std::filesystem::remove_all(plugins / "Owner-C");
+
+	EXPECT_EQ(names(index.scan(plugins, skip_transaction_paths)), (std::vector<std::string>{"A 1.10.0 manifest.json", "B 1.0.0 manifest_disabled.json"}));
+	EXPECT_EQ(index.last_stats().parsed_manifests, 2u);
+}
+
+TEST(manifest_index, skipped_directories_are_left_out)
+{
+	const imm::test::temp_folder temp;
+	const auto plugins = temp / "plugins";
+	write_mod(plugins, "A", "1.0.0");
+	write_mod(plugins, "A.imm_staging.123_0", "2.0.0");
+
+	imm::install::manifest_index index(temp / "index.json");
+	EXPECT_EQ(names(index.scan(plugins, skip_transaction_paths)), std::vector<std::string>{"A 1.0.0 manifest.json"});
+}
+
+TEST(manifest_index, another_plugins_folder_starts_over)
+{
+	const imm::test::temp_folder temp;
+	write_mod(temp / "first", "A", "1.0.0");
+	write_mod(temp / "second", "B", "1.0.0");
+
+	imm::install::manifest_index index(temp / "index.json");
+	index.scan(temp / "first", skip_transaction_paths);
+	EXPECT_EQ(names(index.scan(temp / "second", skip_transaction_paths)), std::vector<std::string>{"B 1.0.0 manifest.json"});
+	EXPECT_EQ(index.last_stats().reused_directories, 0u);
+}
@@ -0,0 +1,117 @@
+#include "install/plan_runner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace
+{
+	// Steps only carry their dependencies, the runner never looks at the packages.
+	imm::install::install_plan make_plan(std::vector<std::vector<size_t>> depends_on)
+	{
+		imm::install::install_plan plan;
+		for (auto& dependencies : depends_on)
+		{
+			plan.steps.push_back({.pkg = nullptr, .version_index = 0, .depends_on = std::move(dependencies)});
+		}
+		return plan;
+	}
+} // namespace
+
+TEST(plan_runner, empty_plan_succeeds)
+{
+	EXPECT_TRUE(imm::install::run_install_plan({}, 4,
+	                                           [](size_t)
+	                                           {
+		                                           return false;
+	                                           }));
+}
+
+TEST(plan_runner, runs_every_step_after_its_dependencies)
+{
+	std::mt19937 rng(3);
+	std::vector<std::vector<size_t>> depends_on(200);
+	for (size_t i = 1; i < depends_on.size(); i++)
+	{
+		for (size_t d = 0, n = rng() % 4; d < n; d++)
+		{
+			depends_on[i].push_back(rng() % i);
+		}
+	}
+	const auto plan = make_plan(depends_on);
+
+	std::mutex mutex;
+	std::vector<int> runs(plan.steps.size());
+	std::vector<bool> done(plan.steps.size());
+	const auto ok = imm::install::run_install_plan(plan, 8,
+	                                               [&](size_t step)
+	                                               {
+		                                               {
+			                                               std::unique_lock lock(mutex);
+			                                               for (const auto dependency : plan.steps[step].depends_on)
+			                                               {
+				                                               EXPECT_TRUE(done[dependency]) << step << " ran before " << dependency;
+			                                               }
+			                                               runs[step]++;
+		                                               }
+
+		                                               std::this_thread::yield();
+
+		                                               std::unique_lock lock(mutex);
+		                                               done[step] = true;
+		                                               return true;
+	                                               });
+
+	EXPECT_TRUE(ok);
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		EXPECT_EQ(runs[i], 1) << i;
+	}
+}
+
+TEST(plan_runner, failure_skips_dependents_but_not_other_branches)
+{
+	// 0 <- 1 <- 2, 0 <- 3, 4 alone, 5 needs 2 and 4.
+	const auto plan = make_plan({{}, {0}, {1}, {0}, {}, {2, 4}});
+
+	std::mutex mutex;
+	std::vector<size_t> ran;
+	const auto ok = imm::install::run_install_plan(plan, 3,
+	                                               [&](size_t step)
+	                                               {
+		                                               std::unique_lock lock(mutex);
+		                                               ran.push_back(step);
+		                                               return step != 1;
+	                                               });
+
+	EXPECT_FALSE(ok);
+	std::sort(ran.begin(), ran.end());
+	EXPECT_EQ(ran, (std::vector<size_t>{0, 1, 3, 4}));
+}
+
+TEST(plan_runner, stays_within_max_parallel)
+{
+	const auto plan = make_plan(std::vector<std::vector<size_t>>(32));
+
+	std::atomic<int> running = 0;
+	std::atomic<int> peak    = 0;
+	const auto run_step      = [&](size_t)
+	{
+		const int now = ++running;
+		int seen      = peak;
+		while (now > seen && !peak.compare_exchange_weak(seen, now))
+		{
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		running--;
+		return true;
+	};
+
+	EXPECT_TRUE(imm::install::run_install_plan(plan, 3, run_step));
+	EXPECT_LE(peak, 3);
+	EXPECT_GE(peak, 1);
+}
@@ -0,0 +1,222 @@
+#include "install/transaction.hpp"
+#include "support/temp_folder.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+
+namespace
+{
+	void write_file(const std::filesystem::path& path, const std::string& content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+	}
+
+	// Relative path to content of every file below root, "/" for empty directories.
+	std::map<std::string, std::string> read_tree(const std::filesystem::path& root)
+	{
+		std::map<std::string, std::string> tree;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+		{
+			const auto relative = entry.path().lexically_relative(root).generic_string();
+			if (entry.is_regular_file())
+			{
+				std::ifstream in(entry.path(), std::ios::binary);
+				tree[relative] = std::string(std::istreambuf_iterator<char>(in), {});
+			}
+			else if (std::filesystem::is_empty(entry.path()))
+			{
+				tree[relative] = "/";
+			}
+		}
+		return tree;
+	}
+
+	// The mods folder before any change: a package to update, one to remove and a config file.
+	void write_initial_state(const std::filesystem::path& mods)
+	{
+		write_file(mods / "Owner-Update" / "Update.dll", "update 1.0");
+		write_file(mods / "Owner-Update" / "readme.txt", "kept");
+		write_file(mods / "Owner-Remove" / "Remove.dll", "remove");
+		write_file(mods / "settings.cfg", "old settings");
+	}
+
+	// Updates one package, installs a new one, removes one and rewrites the config file.
+	void stage_changes(imm::install::transaction& t, const std::filesystem::path& mods)
+	{
+		const auto update = t.stage_directory(mods / "Owner-Update", true);
+		std::filesystem::remove(update / "Update.dll");
+		write_file(update / "Update.dll", "update 2.0");
+
+		const auto install = t.stage_directory(mods / "Owner-New", false);
+		write_file(install / "New.dll", "new");
+
+		t.remove(mods / "Owner-Remove");
+
+		write_file(t.stage_file(mods / "settings.cfg"), "new settings");
+	}
+
+	const std::map<std::string, std::string> initial_tree = {
+	    {"Owner-Update/Update.dll", "update 1.0"},
+	    {"Owner-Update/readme.txt", "kept"},
+	    {"Owner-Remove/Remove.dll", "remove"},
+	    {"settings.cfg", "old settings"},
+	};
+
+	const std::map<std::string, std::string> committed_tree = {
+	    {"Owner-Update/Update.dll", "update 2.0"},
+	    {"Owner-Update/readme.txt", "kept"},
+	    {"Owner-New/New.dll", "new"},
+	    {"settings.cfg", "new settings"},
+	};
+
+	struct simulated_crash
+	{
+	};
+} // namespace
+
+TEST(transaction, commit_applies_every_change)
+{
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	imm::install::transaction t(temp / "journals");
+	stage_changes(t, mods);
+	ASSERT_TRUE(t.commit());
+
+	EXPECT_EQ(read_tree(mods), committed_tree);
+	EXPECT_TRUE(std::filesystem::is_empty(temp / "journals"));
+}
+
+TEST(transaction, rollback_leaves_live_paths_alone)
+{
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	{
+		imm::install::transaction t(temp / "journals");
+		stage_changes(t, mods);
+	}
+
+	EXPECT_EQ(read_tree(mods), initial_tree);
+	EXPECT_TRUE(std::filesystem::is_empty(temp / "journals"));
+}
+
+TEST(transaction, staging_does_not_write_through_to_live)
+{
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	imm::install::transaction t(temp / "journals");
+	const auto staging = t.stage_directory(mods / "Owner-Update", true);
+	std::ofstream(staging / "readme.txt", std::ios::binary | std::ios::app) << " and changed";
+	t.rollback();
+
+	EXPECT_EQ(read_tree(mods), initial_tree);
+}
+
+TEST(transaction, staging_without_live_files_replaces_the_folder)
+{
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	imm::install::transaction t(temp / "journals");
+	const auto staging = t.stage_directory(mods / "Owner-Update", false);
+	EXPECT_TRUE(std::filesystem::is_empty(staging));
+	write_file(staging / "Update.dll", "update 2.0");
+	ASSERT_TRUE(t.commit());
+
+	// readme.txt was only in the old version.
+	auto expected = initial_tree;
+	expected.erase("Owner-Update/readme.txt");
+	expected["Owner-Update/Update.dll"] = "update 2.0";
+	EXPECT_EQ(read_tree(mods), expected);
+}
+
+TEST(transaction, failed_commit_undoes_new_installs)
+{
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	imm::install::transaction t(temp / "journals");
+	write_file(t.stage_directory(mods / "Owner-New", false) / "New.dll", "new");
+	const auto update = t.stage_directory(mods / "Owner-Update", true);
+	std::filesystem::remove(update / "Update.dll");
+	write_file(update / "Update.dll", "update 2.0");
+
+	// Owner-Update can't be backed up, like when the game holds one of its files open, so its swap fails after
+	// Owner-New went in.
+	auto blocked_backup = update.native();
+	blocked_backup.replace(blocked_backup.find(".imm_staging."), std::string_view(".imm_staging.").size(), ".imm_backup.");
+	write_file(std::filesystem::path(blocked_backup) / "blocker", "");
+
+	EXPECT_FALSE(t.commit());
+	std::filesystem::remove_all(blocked_backup);
+
+	EXPECT_EQ(read_tree(mods), initial_tree);
+}
+
+class transaction_crash : public testing::TestWithParam<std::pair<const char*, int>>
+{
+};
+
+TEST_P(transaction_crash, recover_ends_in_the_old_or_the_new_state)
+{
+	const auto [point, occurrence] = GetParam();
+
+	const imm::test::temp_folder temp;
+	const auto mods = temp / "mods";
+	write_initial_state(mods);
+
+	bool crashed = false;
+	{
+		int seen = 0;
+		imm::install::transaction t(temp / "journals",
+		                            [&](std::string_view at)
+		                            {
+			                            if (at == point && ++seen == occurrence)
+			                            {
+				                            throw simulated_crash{};
+			                            }
+		                            });
+		stage_changes(t, mods);
+		try
+		{
+			t.commit();
+		}
+		catch (const simulated_crash&)
+		{
+			crashed = true;
+		}
+	}
+	ASSERT_TRUE(crashed);
+
+	imm::install::recover(temp / "journals");
+
+	// Only a crash before the journal says committing goes back.
+	EXPECT_EQ(read_tree(mods), std::string_view(point) == "staged" ? initial_tree : committed_tree);
+	EXPECT_TRUE(std::filesystem::is_empty(temp / "journals"));
+	for (const auto& entry : std::filesystem::directory_iterator(mods))
+	{
+		EXPECT_FALSE(imm::install::is_transaction_path(entry.path())) << entry.path();
+	}
+}
+
+// Four operations: three are backed up (the new install has nothing to back up), three are swapped in.
+INSTANTIATE_TEST_SUITE_P(fault_points,
+                         transaction_crash,
+                         testing::Values(std::pair{"staged", 1},
+                                         std::pair{"committing", 1},
+                                         std::pair{"backed_up", 1},
+                                         std::pair{"swapped", 1},
+                                         std::pair{"backed_up", 2},
+                                         std::pair{"swapped", 2},
+                                         std::pair{"backed_up", 3},
+                                         std::pair{"swapped", 3},
+                                         std::pair{"committed", 1}));
@@ -0,0 +1,138 @@
+#include "install/zip_install.hpp"
+#include "support/temp_folder.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <zip/zip.h>
+
+namespace
+{
+	using entry_list = std::vector<std::pair<std::string, std::string>>;
+
+	bool write_zip(const std::filesystem::path& zip_path, const entry_list& entries)
+	{
+		auto zip = zip_open((const char*)zip_path.u8string().c_str(), 6, 'w');
+		if (!zip)
+		{
+			return false;
+		}
+
+		for (const auto& [name, content] : entries)
+		{
+			zip_entry_open(zip, name.c_str());
+			zip_entry_write(zip, content.data(), content.size());
+			zip_entry_close(zip);
+		}
+
+		zip_close(zip);
+		return true;
+	}
+
+	// Relative path to content of every file below root.
+	std::map<std::string, std::string> read_tree(const std::filesystem::path& root)
+	{
+		std::map<std::string, std::string> tree;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+		{
+			if (entry.is_regular_file())
+			{
+				std::ifstream in(entry.path(), std::ios::binary);
+				tree[entry.path().lexically_relative(root).generic_string()] = std::string(std::istreambuf_iterator<char>(in), {});
+			}
+		}
+		return tree;
+	}
+
+	imm::install::plugin_folders make_folders(const std::filesystem::path& root)
+	{
+		return {.plugins = root / "plugins" / "Owner-Mod", .plugins_data = root / "plugins_data" / "Owner-Mod", .config = root / "config" / "Owner-Mod"};
+	}
+
+	bool extract(const std::filesystem::path& zip_path, const std::filesystem::path& root, size_t worker_count)
+	{
+		const auto folders = make_folders(root);
+		return imm::install::extract_zip(
+		    zip_path,
+		    [&](std::string_view entry_name)
+		    {
+			    return imm::install::route_plugin_zip_entry(entry_name, folders);
+		    },
+		    worker_count);
+	}
+} // namespace
+
+TEST(zip_install, routes_entries_to_their_folders)
+{
+	const imm::test::temp_folder temp;
+	ASSERT_TRUE(write_zip(temp / "mod.zip", {{"Mod.dll", "dll"}, {"config/Mod.cfg", "cfg"}, {"plugins_data/assets/a.bin", "bin"}, {"sub/readme.txt", "txt"}}));
+	ASSERT_TRUE(extract(temp / "mod.zip", temp / "out", 1));
+
+	const std::map<std::string, std::string> expected = {
+	    {"plugins/Owner-Mod/Mod.dll", "dll"},
+	    {"config/Owner-Mod/config/Mod.cfg", "cfg"},
+	    {"plugins_data/Owner-Mod/plugins_data/assets/a.bin", "bin"},
+	    {"plugins/Owner-Mod/sub/readme.txt", "txt"},
+	};
+	EXPECT_EQ(read_tree(temp / "out"), expected);
+}
+
+TEST(zip_install, skips_entries_that_escape_the_folder)
+{
+	const imm::test::temp_folder temp;
+	ASSERT_TRUE(write_zip(temp / "mod.zip", {{"../evil.dll", "x"}, {"sub/../../evil.dll", "x"}, {"/abs.dll", "x"}, {"C:/abs.dll", "x"}, {"ok.dll", "ok"}}));
+	ASSERT_TRUE(extract(temp / "mod.zip", temp / "out", 1));
+
+	const std::map<std::string, std::string> expected = {{"plugins/Owner-Mod/ok.dll", "ok"}};
+	EXPECT_EQ(read_tree(temp / "out"), expected);
+	EXPECT_FALSE(std::filesystem::exists(temp / "evil.dll"));
+}
+
+TEST(zip_install, parallel_extraction_matches_sequential)
+{
+	const imm::test::temp_folder temp;
+
+	// Mixed sizes over all three folders, above the parallel threshold, with a few names written twice: the later entry wins.
+	std::mt19937 rng(7);
+	entry_list entries;
+	for (size_t i = 0; i < 300; i++)
+	{
+		static const char* prefixes[] = {"", "config/", "plugins_data/", "folder/", "folder/nested/"};
+		const auto name = std::string(prefixes[i % std::size(prefixes)]) + "file" + std::to_string(i % 280) + ".bin";
+
+		std::string content(i % 20 == 0 ? 1024 * 1024 + rng() % 4096 : rng() % 8192, '\0');
+		for (auto& c : content)
+		{
+			c = (char)('a' + rng() % 8);
+		}
+		entries.emplace_back(name, std::move(content));
+	}
+	ASSERT_TRUE(write_zip(temp / "mod.zip", entries));
+
+	ASSERT_TRUE(extract(temp / "mod.zip", temp / "sequential", 1));
+	ASSERT_TRUE(extract(temp / "mod.zip", temp / "parallel", 4));
+	ASSERT_TRUE(extract(temp / "mod.zip", temp / "auto", 0));
+
+	const auto sequential = read_tree(temp / "sequential");
+	EXPECT_EQ(sequential.size(), 280u);
+	EXPECT_EQ(read_tree(temp / "parallel"), sequential);
+	EXPECT_EQ(read_tree(temp / "auto"), sequential);
+
+	// Matches the entries applied in order.
+	std::map<std::string, std::string> expected;
+	for (const auto& [name, content] : entries)
+	{
+		const auto destination = imm::install::route_plugin_zip_entry(name, make_folders(temp / "sequential"));
+		expected[destination->lexically_relative(temp / "sequential").generic_string()] = content;
+	}
+	EXPECT_EQ(sequential, expected);
+}
+
+TEST(zip_install, unreadable_zip_fails)
+{
+	const imm::test::temp_folder temp;
+	std::ofstream(temp / "broken.zip") << "not a zip";
+	EXPECT_FALSE(extract(temp / "broken.zip", temp / "out", 1));
+	EXPECT_FALSE(extract(temp / "missing.zip", temp / "out", 1));
+}
@@ -0,0 +1,13 @@
+#include "logger.hpp"
+
+#include <gtest/gtest.h>
+
+int main(int argc, char** argv)
+{
+	// Code under test logs through the global logger, which only the app sets up.
+	logger = spdlog::default_logger();
+	logger->set_level(spdlog::level::warn);
+
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
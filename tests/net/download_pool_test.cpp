@@ -0,0 +1,144 @@
+#include "net/download_pool.hpp"
+#include "support/http_stand_in.hpp"
+#include "support/temp_folder.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <optional>
+
+namespace
+{
+	const std::string file_body = "hello world!";
+
+	std::string read_file(const std::filesystem::path& path)
+	{
+		std::ifstream f(path, std::ios::binary);
+		return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	}
+
+	void write_file(const std::filesystem::path& path, std::string_view content)
+	{
+		std::ofstream f(path, std::ios::binary);
+		f.write(content.data(), content.size());
+	}
+
+	// Downloads url to path on a pool of its own and returns what on_done got.
+	bool download(const std::string& url, const std::filesystem::path& path)
+	{
+		std::optional<bool> result;
+		imm::net::download_pool pool(1);
+		pool.enqueue({.url     = url,
+		              .path    = path,
+		              .on_done = [&](bool success)
+		              {
+			              result = success;
+		              }});
+		pool.wait_idle();
+		return result.value_or(false);
+	}
+} // namespace
+
+TEST(download_pool, dropped_transfer_resumes_with_a_range_request)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(
+	    [](const imm::test::http_request& request) -> imm::test::http_response
+	    {
+		    if (request.header("range") == "bytes=6-")
+		    {
+			    return {.status = 206, .headers = {{"Content-Range", "bytes 6-11/12"}}, .body = file_body.substr(6)};
+		    }
+		    return {.status = 200, .body = file_body, .chunk_size = 3, .drop_after = 6};
+	    });
+
+	EXPECT_TRUE(download(server.url("/file"), folder / "file.zip"));
+	EXPECT_EQ(read_file(folder / "file.zip"), file_body);
+	EXPECT_FALSE(std::filesystem::exists(folder / "file.zip.part"));
+
+	const auto requests = server.requests();
+	ASSERT_EQ(requests.size(), 2u);
+	EXPECT_EQ(requests[0].header("range"), "");
+	EXPECT_EQ(requests[1].header("range"), "bytes=6-");
+}
+
+TEST(download_pool, headers_of_a_redirect_do_not_leak_into_the_final_response)
+{
+	imm::test::temp_folder folder;
+	// A part the size the redirect claims the whole file is, the 416 behind it must not make it look complete.
+	write_file(folder / "file.zip.part", file_body.substr(0, 5));
+
+	imm::test::http_stand_in server(
+	    [&](const imm::test::http_request& request) -> imm::test::http_response
+	    {
+		    if (request.target == "/moved")
+		    {
+			    return {.status = 416};
+		    }
+		    if (request.header("range").size())
+		    {
+			    return {.status = 302, .headers = {{"Location", "/moved"}, {"Content-Range", "bytes */5"}}};
+		    }
+		    return {.status = 200, .body = file_body};
+	    });
+
+	EXPECT_TRUE(download(server.url("/file"), folder / "file.zip"));
+	EXPECT_EQ(read_file(folder / "file.zip"), file_body);
+}
+
+TEST(download_pool, destruction_fails_the_queued_jobs_once)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(
+	    [](const imm::test::http_request&) -> imm::test::http_response
+	    {
+		    return {.status = 200, .body = file_body, .chunk_size = 1, .chunk_delay = std::chrono::milliseconds(20)};
+	    });
+
+	std::atomic<int> succeeded = 0;
+	std::atomic<int> failed    = 0;
+	{
+		imm::net::download_pool pool(1);
+		for (int i = 0; i < 4; i++)
+		{
+			pool.enqueue({.url     = server.url("/file"),
+			              .path    = folder / ("file" + std::to_string(i) + ".zip"),
+			              .on_done = [&](bool success)
+			              {
+				              (success ? succeeded : failed)++;
+			              }});
+		}
+
+		// The first transfer is running, the other three are still queued.
+		while (server.requests().empty())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	EXPECT_EQ(succeeded, 1);
+	EXPECT_EQ(failed, 3);
+}
+
+TEST(download_pool, client_errors_are_not_retried)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(
+	    [](const imm::test::http_request& request) -> imm::test::http_response
+	    {
+		    if (request.target == "/flaky")
+		    {
+			    return {.status = 503};
+		    }
+		    return {.status = 404};
+	    });
+
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_FALSE(download(server.url("/missing"), folder / "missing.png"));
+	EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+	EXPECT_EQ(server.requests().size(), 1u);
+
+	// Server errors still get every attempt.
+	EXPECT_FALSE(download(server.url("/flaky"), folder / "flaky.png"));
+	EXPECT_EQ(server.requests().size(), 4u);
+}
@@ -0,0 +1,127 @@
+#include "platform/directory_watcher.hpp"
+#include "support/temp_folder.hpp"
+
+#include <condition_variable>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mutex>
+
+namespace
+{
+	using namespace std::chrono_literals;
+
+	constexpr auto debounce = 100ms;
+
+	// Every on_change call, in order.
+	class change_log
+	{
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::vector<std::vector<std::filesystem::path>> m_calls;
+
+	public:
+		imm::platform::directory_watcher::change_callback callback()
+		{
+			return [this](const std::vector<std::filesystem::path>& changed_roots)
+			{
+				std::unique_lock lock(m_mutex);
+				m_calls.push_back(changed_roots);
+				m_cv.notify_all();
+			};
+		}
+
+		// Waits for at least count calls, returns every call so far.
+		std::vector<std::vector<std::filesystem::path>> wait_for(size_t count, std::chrono::milliseconds timeout = 5s)
+		{
+			std::unique_lock lock(m_mutex);
+			m_cv.wait_for(lock,
+			              timeout,
+			              [&]
+			              {
+				              return m_calls.size() >= count;
+			              });
+			return m_calls;
+		}
+	};
+
+	void write_file(const std::filesystem::path& path, const std::string& content)
+	{
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+	}
+} // namespace
+
+#ifdef __linux__
+
+TEST(directory_watcher, reports_a_burst_of_changes_once)
+{
+	const imm::test::temp_folder temp;
+	change_log log;
+	const imm::platform::directory_watcher watcher({temp.path()}, debounce, log.callback());
+
+	for (int i = 0; i < 100; i++)
+	{
+		write_file(temp / ("file" + std::to_string(i)), "content");
+	}
+
+	const auto calls = log.wait_for(1);
+	ASSERT_EQ(calls.size(), 1u);
+	EXPECT_EQ(calls[0], std::vector{temp.path()});
+
+	// Nothing else is pending once it settled.
+	EXPECT_EQ(log.wait_for(2, debounce * 3).size(), 1u);
+}
+
+TEST(directory_watcher, reports_only_the_roots_that_changed)
+{
+	const imm::test::temp_folder temp;
+	for (const char* name : {"plugins", "config", "plugins_data"})
+	{
+		std::filesystem::create_directories(temp / name);
+	}
+
+	change_log log;
+	const imm::platform::directory_watcher watcher({temp / "plugins", temp / "config", temp / "plugins_data"}, debounce, log.callback());
+	EXPECT_EQ(watcher.roots().size(), 3u);
+
+	write_file(temp / "config" / "Mod.cfg", "cfg");
+	write_file(temp / "plugins_data" / "save.dat", "data");
+
+	const auto calls = log.wait_for(1);
+	ASSERT_EQ(calls.size(), 1u);
+	EXPECT_EQ(calls[0], (std::vector{temp / "config", temp / "plugins_data"}));
+}
+
+TEST(directory_watcher, watches_subdirectories_created_after_it_started)
+{
+	const imm::test::temp_folder temp;
+	std::filesystem::create_directories(temp / "existing" / "nested");
+
+	change_log log;
+	const imm::platform::directory_watcher watcher({temp.path()}, debounce, log.callback());
+
+	// Already there when it started.
+	write_file(temp / "existing" / "nested" / "file", "content");
+	ASSERT_EQ(log.wait_for(1).size(), 1u);
+
+	// Created while it runs, the second write lands once the first change was reported.
+	std::filesystem::create_directories(temp / "new" / "deeper");
+	ASSERT_EQ(log.wait_for(2).size(), 2u);
+	write_file(temp / "new" / "deeper" / "file", "content");
+	EXPECT_EQ(log.wait_for(3).size(), 3u);
+}
+
+TEST(directory_watcher, stops_promptly_without_events)
+{
+	const imm::test::temp_folder temp;
+	change_log log;
+
+	const auto start = std::chrono::steady_clock::now();
+	{
+		const imm::platform::directory_watcher watcher({temp.path()}, 10s, log.callback());
+		write_file(temp / "file", "content");
+	}
+	EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+	EXPECT_EQ(log.wait_for(1, 0ms).size(), 0u);
+}
+
+#endif
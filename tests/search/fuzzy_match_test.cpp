@@ -0,0 +1,165 @@
+#include "search/fuzzy_match.hpp"
+#include "search/search_index.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace
+{
+	using imm::search::fuzzy_pattern;
+
+	std::optional<int> score(std::string_view pattern, std::string_view text)
+	{
+		return fuzzy_pattern(pattern).score(text);
+	}
+
+	// The letters of word with gap filler characters between each of them.
+	std::string scatter(std::string_view word, size_t gap)
+	{
+		std::string result;
+		for (const char c : word)
+		{
+			if (result.size())
+			{
+				result.append(gap, 'x');
+			}
+			result += c;
+		}
+		return result;
+	}
+} // namespace
+
+TEST(fuzzy_match, empty_pattern_matches_everything)
+{
+	EXPECT_EQ(score("", "anything"), 0);
+	EXPECT_EQ(score("   ", ""), 0);
+	EXPECT_TRUE(fuzzy_pattern(" ").empty());
+}
+
+TEST(fuzzy_match, matches_subsequences_only)
+{
+	EXPECT_TRUE(score("bbs", "betterbosses"));
+	EXPECT_TRUE(score("betterbosses", "betterbosses"));
+	EXPECT_FALSE(score("sbb", "betterbosses"));
+	EXPECT_FALSE(score("bbs", "bosses"));
+}
+
+TEST(fuzzy_match, pattern_is_case_folded_and_spaces_are_ignored)
+{
+	EXPECT_EQ(score("Better Bosses", "betterbosses"), score("betterbosses", "betterbosses"));
+	EXPECT_EQ(score("BB", "better-bosses"), score("bb", "better-bosses"));
+}
+
+TEST(fuzzy_match, consecutive_beats_scattered)
+{
+	EXPECT_GT(*score("abc", "abcxx"), *score("abc", "axbxc"));
+	EXPECT_GT(*score("abc", "axbxc"), *score("abc", "axxxxbxxxxc"));
+}
+
+TEST(fuzzy_match, word_boundaries_get_a_bonus)
+{
+	EXPECT_GT(*score("bos", "better-bosses"), *score("bos", "betterbosses"));
+	EXPECT_GT(*score("bb", "better-bosses"), *score("bb", "abbey"));
+}
+
+TEST(fuzzy_match, picks_the_tightest_window_ending_at_the_leftmost_match)
+{
+	// The leftmost a is dropped for the one right before b.
+	EXPECT_EQ(score("abc", "a--abc"), score("abc", "-abc"));
+}
+
+TEST(fuzzy_match, tolerates_one_typo_from_four_characters)
+{
+	const auto exact = score("bosses", "bosses");
+	const auto typo  = score("bosess", "bosses");
+	ASSERT_TRUE(exact);
+	ASSERT_TRUE(typo);
+	EXPECT_LT(*typo, *exact);
+
+	EXPECT_TRUE(score("bxss", "bosses"));
+	EXPECT_FALSE(score("bxs", "bosses"));
+	EXPECT_FALSE(score("bxyses", "bosses"));
+}
+
+TEST(fuzzy_match, may_match_never_rejects_a_match)
+{
+	static const char alphabet[] = "abcdefghij-_ 0123456789";
+
+	std::mt19937 rng(42);
+	const auto random_text = [&](size_t max_size)
+	{
+		std::string text(rng() % max_size, ' ');
+		for (auto& c : text)
+		{
+			c = alphabet[rng() % (sizeof(alphabet) - 1)];
+		}
+		return text;
+	};
+
+	for (int i = 0; i < 20'000; i++)
+	{
+		const fuzzy_pattern pattern(random_text(7));
+		const auto text = random_text(24);
+		if (pattern.score(text))
+		{
+			ASSERT_TRUE(pattern.may_match(imm::search::char_mask(text))) << text;
+		}
+	}
+}
+
+TEST(fuzzy_match, find_char_agrees_with_reference)
+{
+	std::string text;
+	for (size_t size = 0; size <= 48; size++)
+	{
+		text.assign(size, 'a');
+		for (size_t hit = 0; hit <= size; hit++)
+		{
+			if (hit < size)
+			{
+				text[hit] = 'b';
+			}
+
+			for (size_t from = 0; from <= size; from++)
+			{
+				ASSERT_EQ(imm::search::find_char(text, 'b', from), imm::search::reference::find_char(text, 'b', from)) << size << ' ' << hit << ' ' << from;
+			}
+
+			if (hit < size)
+			{
+				text[hit] = 'a';
+			}
+		}
+	}
+}
+
+TEST(fuzzy_match, min_score_is_relative_to_the_best)
+{
+	EXPECT_EQ(imm::search::min_fuzzy_score(100), 50);
+	EXPECT_EQ(imm::search::min_fuzzy_score(0), 0);
+	EXPECT_EQ(imm::search::min_fuzzy_score(-10), -10);
+}
+
+TEST(fuzzy_match, search_drops_matches_far_below_the_best)
+{
+	// No trigram of the query is in either name, both only match through the fuzzy pass.
+	const std::string strong = "betterbosses";
+	const std::string weak   = scatter("bettrboss", 10);
+
+	const fuzzy_pattern pattern("bettrboss");
+	const auto strong_score = pattern.score(strong);
+	const auto weak_score   = pattern.score(weak);
+	ASSERT_TRUE(strong_score);
+	ASSERT_TRUE(weak_score);
+	ASSERT_LT(*weak_score, imm::search::min_fuzzy_score(*strong_score));
+
+	imm::search::search_index index;
+	index.add(weak, "Owner", {}, "");
+	const auto strong_id = index.add(strong, "Owner", {}, "");
+	EXPECT_EQ(index.query("bettrboss"), std::vector<uint32_t>{strong_id});
+
+	// Alone it is the best match, so it is kept.
+	imm::search::search_index weak_only;
+	const auto weak_id = weak_only.add(weak, "Owner", {}, "");
+	EXPECT_EQ(weak_only.query("bettrboss"), std::vector<uint32_t>{weak_id});
+}
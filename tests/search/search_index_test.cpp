@@ -0,0 +1,58 @@
+#include "search/search_index.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+	using imm::search::search_index;
+	using imm::string::interned;
+
+	uint32_t add(search_index& index, std::string_view name, std::vector<interned> categories, std::string_view description = "")
+	{
+		return index.add(name, "Owner", categories, description);
+	}
+} // namespace
+
+TEST(search_index, finds_terms_in_every_field)
+{
+	search_index index;
+	const auto better = add(index, "Owner-BetterBosses", {"Mods"}, "harder fights");
+	const auto chef   = add(index, "Owner-ChefSkills", {"Survivors"});
+
+	EXPECT_EQ(index.query("bosses"), std::vector<uint32_t>{better});
+	EXPECT_EQ(index.query("survivors"), std::vector<uint32_t>{chef});
+	EXPECT_EQ(index.query("fights"), std::vector<uint32_t>{better});
+}
+
+TEST(search_index, update_replaces_the_postings_of_a_document)
+{
+	search_index index;
+	const auto first  = add(index, "Owner-First", {"Mods"});
+	const auto second = add(index, "Owner-Second", {"Mods"}, "old description");
+	const auto third  = add(index, "Owner-Third", {"Mods"});
+
+	const auto generation = index.generation();
+	index.update(second, "Owner-Second", "Owner", std::vector<interned>{"Modpacks"}, "new description");
+	EXPECT_NE(index.generation(), generation);
+
+	EXPECT_TRUE(index.query("old description").empty());
+	EXPECT_EQ(index.query("new description"), std::vector<uint32_t>{second});
+	EXPECT_EQ(index.query("modpacks"), std::vector<uint32_t>{second});
+
+	// Still in id order among equal scores after being reinserted in the middle of the lists.
+	EXPECT_EQ(index.query("owner"), (std::vector<uint32_t>{first, second, third}));
+	EXPECT_EQ(index.size(), 3);
+}
+
+TEST(search_index, folds_queries_and_documents_the_same_way)
+{
+	search_index index;
+	const auto doc = add(index, "Owner-ŸÖÜR_Items", {"Modpacks"}, "ÉDITION SPÉCIALE");
+
+	EXPECT_EQ(index.query("ÿöür"), std::vector<uint32_t>{doc});
+	EXPECT_EQ(index.query("ŸÖÜR"), std::vector<uint32_t>{doc});
+	EXPECT_EQ(index.query("édition spéciale"), std::vector<uint32_t>{doc});
+
+	// Through the fuzzy pass too, "ÿoür" is not a substring.
+	EXPECT_EQ(index.query("ŸOÜRITEMS"), std::vector<uint32_t>{doc});
+}
@@ -0,0 +1,165 @@
+#include "store/zip_store.hpp"
+#include "support/temp_folder.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace
+{
+	// A downloaded "zip" of size bytes, its content only depends on seed.
+	std::filesystem::path write_download(const imm::test::temp_folder& temp, const std::string& name, size_t size, char seed)
+	{
+		std::filesystem::create_directories(temp / "downloads");
+		const auto path = temp / "downloads" / (name + ".zip");
+		std::ofstream(path, std::ios::binary) << std::string(size, seed);
+		return path;
+	}
+
+	nlohmann::json read_index(const imm::test::temp_folder& temp)
+	{
+		std::ifstream f(temp / "store" / "index.json");
+		return nlohmann::json::parse(f, nullptr, false);
+	}
+} // namespace
+
+TEST(zip_store, add_then_find)
+{
+	const imm::test::temp_folder temp;
+	imm::store::zip_store store(temp / "store", 1024 * 1024);
+
+	EXPECT_FALSE(store.find("Owner-Mod-1.0.0"));
+
+	const auto download = write_download(temp, "Owner-Mod-1.0.0", 100, 'a');
+	const auto stored   = store.add("Owner-Mod-1.0.0", download);
+	ASSERT_TRUE(stored);
+	EXPECT_FALSE(std::filesystem::exists(download));
+	EXPECT_EQ(store.find("Owner-Mod-1.0.0"), stored);
+
+	const auto stats = store.stats();
+	EXPECT_EQ(stats.hits, 1u);
+	EXPECT_EQ(stats.misses, 1u);
+	EXPECT_EQ(stats.object_count, 1u);
+	EXPECT_EQ(stats.total_bytes, 100u);
+}
+
+TEST(zip_store, identical_payloads_are_stored_once)
+{
+	const imm::test::temp_folder temp;
+	imm::store::zip_store store(temp / "store", 1024 * 1024);
+
+	const auto first  = store.add("Owner-Mod-1.0.0", write_download(temp, "Owner-Mod-1.0.0", 100, 'a'));
+	const auto second = store.add("Owner-Copy-1.0.0", write_download(temp, "Owner-Copy-1.0.0", 100, 'a'));
+	ASSERT_TRUE(first);
+	EXPECT_EQ(first, second);
+
+	const auto stats = store.stats();
+	EXPECT_EQ(stats.deduplicated, 1u);
+	EXPECT_EQ(stats.object_count, 1u);
+	EXPECT_EQ(stats.name_count, 2u);
+}
+
+TEST(zip_store, corrupted_object_is_dropped_on_first_use)
+{
+	const imm::test::temp_folder temp;
+	std::filesystem::path stored;
+	{
+		imm::store::zip_store store(temp / "store", 1024 * 1024);
+		stored = store.add("Owner-Mod-1.0.0", write_download(temp, "Owner-Mod-1.0.0", 100, 'a')).value();
+	}
+
+	std::ofstream(stored, std::ios::binary) << "truncated";
+
+	imm::store::zip_store store(temp / "store", 1024 * 1024);
+	EXPECT_FALSE(store.find("Owner-Mod-1.0.0"));
+	EXPECT_FALSE(std::filesystem::exists(stored));
+	EXPECT_EQ(store.stats().corrupted, 1u);
+	EXPECT_EQ(store.stats().object_count, 0u);
+}
+
+TEST(zip_store, evicts_least_recently_used_first_on_open)
+{
+	const imm::test::temp_folder temp;
+	{
+		imm::store::zip_store store(temp / "store", 1024 * 1024);
+		for (const char seed : {'a', 'b', 'c', 'd'})
+		{
+			const auto name = std::string("Owner-Mod") + seed + "-1.0.0";
+			ASSERT_TRUE(store.add(name, write_download(temp, name, 1000, seed)));
+		}
+
+		// b and a are used again, c then d are now the oldest.
+		ASSERT_TRUE(store.find("Owner-Modb-1.0.0"));
+		ASSERT_TRUE(store.find("Owner-Moda-1.0.0"));
+	}
+
+	// Room for two, opening a new run with a smaller budget evicts c and d.
+	imm::store::zip_store store(temp / "store", 2000);
+	const auto stats = store.stats();
+	EXPECT_EQ(stats.evicted_objects, 2u);
+	EXPECT_EQ(stats.evicted_bytes, 2000u);
+	EXPECT_EQ(stats.total_bytes, 2000u);
+	EXPECT_TRUE(store.find("Owner-Moda-1.0.0"));
+	EXPECT_TRUE(store.find("Owner-Modb-1.0.0"));
+	EXPECT_FALSE(store.find("Owner-Modc-1.0.0"));
+	EXPECT_FALSE(store.find("Owner-Modd-1.0.0"));
+}
+
+TEST(zip_store, objects_used_this_run_are_never_evicted)
+{
+	const imm::test::temp_folder temp;
+	{
+		imm::store::zip_store store(temp / "store", 1024 * 1024);
+		ASSERT_TRUE(store.add("Owner-Old-1.0.0", write_download(temp, "Owner-Old-1.0.0", 1000, 'o')));
+	}
+
+	imm::store::zip_store store(temp / "store", 1500);
+	ASSERT_TRUE(store.find("Owner-Old-1.0.0"));
+
+	// Over budget with both, but the old one is in use: it stays, and so does the new one since nothing else can go.
+	ASSERT_TRUE(store.add("Owner-New-1.0.0", write_download(temp, "Owner-New-1.0.0", 1000, 'n')));
+	store.collect_garbage();
+	EXPECT_EQ(store.stats().evicted_objects, 0u);
+	EXPECT_TRUE(store.find("Owner-Old-1.0.0"));
+	EXPECT_TRUE(store.find("Owner-New-1.0.0"));
+}
+
+TEST(zip_store, hits_are_saved_in_batches)
+{
+	const imm::test::temp_folder temp;
+	imm::store::zip_store store(temp / "store", 1024 * 1024);
+	ASSERT_TRUE(store.add("Owner-Mod-1.0.0", write_download(temp, "Owner-Mod-1.0.0", 100, 'a')));
+
+	// Adds are written right away.
+	const auto clock_after_add = read_index(temp)["clock"].get<uint64_t>();
+	EXPECT_EQ(clock_after_add, 1u);
+
+	// Hits right after are not, until a flush.
+	for (int i = 0; i < 10; i++)
+	{
+		ASSERT_TRUE(store.find("Owner-Mod-1.0.0"));
+	}
+	EXPECT_EQ(read_index(temp)["clock"].get<uint64_t>(), clock_after_add);
+
+	store.flush();
+	EXPECT_EQ(read_index(temp)["clock"].get<uint64_t>(), clock_after_add + 10);
+}
+
+TEST(zip_store, objects_missing_from_the_index_are_adopted)
+{
+	const imm::test::temp_folder temp;
+	std::filesystem::path stored;
+	{
+		imm::store::zip_store store(temp / "store", 1024 * 1024);
+		stored = store.add("Owner-Mod-1.0.0", write_download(temp, "Owner-Mod-1.0.0", 100, 'a')).value();
+	}
+
+	// Crash between moving the file in and saving the index.
+	std::filesystem::remove(temp / "store" / "index.json");
+
+	imm::store::zip_store store(temp / "store", 1024 * 1024);
+	const auto stats = store.stats();
+	EXPECT_EQ(stats.object_count, 1u);
+	EXPECT_EQ(stats.total_bytes, 100u);
+	EXPECT_EQ(stats.name_count, 0u);
+	EXPECT_TRUE(std::filesystem::exists(stored));
+}
@@ -0,0 +1,92 @@
+#include "string/case_fold.hpp"
+#include "string/intern_pool.hpp"
+
+#include <cctype>
+#include <gtest/gtest.h>
+
+using imm::string::fold_case;
+using imm::string::detail::to_lower_2_byte;
+
+TEST(case_fold, ascii_matches_tolower)
+{
+	std::string all;
+	for (int c = 1; c < 128; c++)
+	{
+		all += (char)c;
+	}
+
+	// Long enough for the SSE2 loop and the scalar tail, at every alignment.
+	for (size_t offset = 0; offset < 16; offset++)
+	{
+		const auto text   = all.substr(offset) + all;
+		const auto folded = fold_case(text);
+		ASSERT_EQ(folded.size(), text.size());
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			ASSERT_EQ(folded[i], (char)std::tolower((unsigned char)text[i])) << offset << ' ' << i;
+		}
+	}
+}
+
+TEST(case_fold, lowercases_two_byte_capitals)
+{
+	EXPECT_EQ(fold_case("ÀÉÎÕÜÞ"), "àéîõüþ");
+	EXPECT_EQ(fold_case("ĀĂĲĹĽŁŃŇŊŒŠŸŹŻŽ"), "āăĳĺľłńňŋœšÿźżž");
+	EXPECT_EQ(fold_case("ΑΒΓΔΩΪΫ"), "αβγδωϊϋ");
+	EXPECT_EQ(fold_case("ЀЁЉЏАЖЯ"), "ѐёљџажя");
+	EXPECT_EQ(fold_case("Risk Of Rain ÉDITION"), "risk of rain édition");
+}
+
+TEST(case_fold, leaves_everything_else_alone)
+{
+	// Multiplication sign, sharp s, dotted / dotless i, kra, n preceded by apostrophe, long s, no final capital sigma.
+	for (const char32_t cp : {0xD7, 0xDF, 0x130, 0x131, 0x138, 0x149, 0x17F, 0x3A2})
+	{
+		EXPECT_EQ(to_lower_2_byte(cp), cp) << std::hex << (uint32_t)cp;
+	}
+
+	// 3 byte sequences, stray continuation bytes and a truncated lead byte.
+	for (const std::string text : {"€ ✓ 日本", "\x80\xBF", "abc\xC3"})
+	{
+		EXPECT_EQ(fold_case(text), text);
+	}
+}
+
+TEST(case_fold, range_edges)
+{
+	EXPECT_EQ(to_lower_2_byte(0xC0), 0xE0);
+	EXPECT_EQ(to_lower_2_byte(0xDE), 0xFE);
+	EXPECT_EQ(to_lower_2_byte(0x100), 0x101);
+	EXPECT_EQ(to_lower_2_byte(0x132), 0x133);
+	EXPECT_EQ(to_lower_2_byte(0x139), 0x13A);
+	EXPECT_EQ(to_lower_2_byte(0x147), 0x148);
+	EXPECT_EQ(to_lower_2_byte(0x14A), 0x14B);
+	EXPECT_EQ(to_lower_2_byte(0x176), 0x177);
+	EXPECT_EQ(to_lower_2_byte(0x178), 0xFF);
+	EXPECT_EQ(to_lower_2_byte(0x179), 0x17A);
+	EXPECT_EQ(to_lower_2_byte(0x17D), 0x17E);
+	EXPECT_EQ(to_lower_2_byte(0x391), 0x3B1);
+	EXPECT_EQ(to_lower_2_byte(0x3AB), 0x3CB);
+	EXPECT_EQ(to_lower_2_byte(0x400), 0x450);
+	EXPECT_EQ(to_lower_2_byte(0x40F), 0x45F);
+	EXPECT_EQ(to_lower_2_byte(0x410), 0x430);
+	EXPECT_EQ(to_lower_2_byte(0x42F), 0x44F);
+}
+
+TEST(case_fold, is_idempotent)
+{
+	for (char32_t cp = 0x80; cp < 0x800; cp++)
+	{
+		const auto lower = to_lower_2_byte(cp);
+		ASSERT_GE(lower, 0x80u);
+		ASSERT_LT(lower, 0x800u);
+		ASSERT_EQ(to_lower_2_byte(lower), lower) << std::hex << (uint32_t)cp;
+	}
+}
+
+TEST(case_fold, interned_strings_fold_like_queries)
+{
+	const imm::string::interned owner("ŸÖÜR-Team");
+	EXPECT_EQ(owner.folded(), fold_case("ŸÖÜR-Team"));
+	EXPECT_EQ(owner.folded(), "ÿöür-team");
+}
@@ -0,0 +1,145 @@
+#include "string/string.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+	// What split and get_text_value replaced.
+	std::vector<std::string> getline_split(const std::string& text, char delim)
+	{
+		std::vector<std::string> result;
+		std::stringstream stream(text);
+		std::string field;
+		while (std::getline(stream, field, delim))
+		{
+			result.push_back(field);
+		}
+		return result;
+	}
+
+	template<typename T>
+	T stream_value(const std::string& text)
+	{
+		T value = (T)0;
+		std::stringstream(text) >> value;
+		return value;
+	}
+
+	const std::vector<std::string> number_texts = {
+	    "",
+	    "0",
+	    "42",
+	    "-42",
+	    "+42",
+	    "  42",
+	    "\t\n\v\f\r42",
+	    "42 ",
+	    "42abc",
+	    "abc",
+	    "+",
+	    "-",
+	    "+-42",
+	    "-+42",
+	    "--42",
+	    "007",
+	    "1.5",
+	    "-1.5",
+	    ".5",
+	    "-.5",
+	    "5.",
+	    ".",
+	    "1e3",
+	    "1.5E-3",
+	    "1e",
+	    "2.5e-",
+	    "1ex",
+	    "0x10",
+	    "inf",
+	    "-inf",
+	    "nan",
+	    "infinity",
+	    "127",
+	    "128",
+	    "-129",
+	    "32768",
+	    "65536",
+	    "2147483648",
+	    "-2147483649",
+	    "4294967296",
+	    "9223372036854775808",
+	    "-9223372036854775809",
+	    "18446744073709551616",
+	    "99999999999999999999999",
+	    "-99999999999999999999999",
+	    "1e39",
+	    "-1e39",
+	    "1e309",
+	    "-1e309",
+	};
+
+	template<typename T>
+	void expect_stream_values()
+	{
+		for (const auto& text : number_texts)
+		{
+			EXPECT_EQ(imm::string::get_text_value<T>(text), stream_value<T>(text)) << '"' << text << '"';
+		}
+	}
+} // namespace
+
+TEST(string, split_matches_getline)
+{
+	for (const std::string text : {"", ",", ",,", "a", "a,b,c", ",a", "a,", ",a,", "a,,b", ",,a,,b,,", "a b,c d"})
+	{
+		EXPECT_EQ(imm::string::split(text, ','), getline_split(text, ',')) << '"' << text << '"';
+	}
+}
+
+TEST(string, split_view_points_into_the_text)
+{
+	const std::string_view text = "Owner-Name-1.0.0";
+
+	std::vector<std::string_view> fields;
+	for (const auto field : imm::string::split_view(text, '-'))
+	{
+		EXPECT_GE(field.data(), text.data());
+		EXPECT_LE(field.data() + field.size(), text.data() + text.size());
+		fields.push_back(field);
+	}
+	EXPECT_EQ(fields, (std::vector<std::string_view>{"Owner", "Name", "1.0.0"}));
+}
+
+TEST(string, split_parses_fields)
+{
+	EXPECT_EQ(imm::string::split<int>("1,-2,,x,+3", ','), (std::vector<int>{1, -2, 0, 0, 3}));
+	EXPECT_EQ(imm::string::split<float>("1.5,-0.25", ','), (std::vector<float>{1.5f, -0.25f}));
+}
+
+TEST(string, get_text_value_matches_operator_extraction)
+{
+	expect_stream_values<short>();
+	expect_stream_values<unsigned short>();
+	expect_stream_values<int>();
+	expect_stream_values<unsigned int>();
+	expect_stream_values<int64_t>();
+	expect_stream_values<uint64_t>();
+	expect_stream_values<float>();
+	expect_stream_values<double>();
+	expect_stream_values<char>();
+	expect_stream_values<bool>();
+}
+
+TEST(string, get_text_value_clamps_and_wraps_like_operator_extraction)
+{
+	using imm::string::get_text_value;
+	EXPECT_EQ(get_text_value<int>("99999999999"), std::numeric_limits<int>::max());
+	EXPECT_EQ(get_text_value<int>("-99999999999"), std::numeric_limits<int>::min());
+	EXPECT_EQ(get_text_value<unsigned int>("-5"), 0u - 5u);
+	EXPECT_EQ(get_text_value<float>("1e39"), std::numeric_limits<float>::max());
+	EXPECT_EQ(get_text_value<double>("inf"), 0.0);
+	EXPECT_EQ(get_text_value<int>("\v\f7"), 7);
+	EXPECT_EQ(get_text_value<std::string>(" kept as is "), " kept as is ");
+}
@@ -0,0 +1,261 @@
+#include "http_stand_in.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+#ifdef _WIN32
+	#include <WinSock2.h>
+	#include <WS2tcpip.h>
+#else
+	#include <arpa/inet.h>
+	#include <netinet/in.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+#endif
+
+namespace imm::test
+{
+	namespace
+	{
+#ifdef _WIN32
+		using socket_type = SOCKET;
+
+		void close_socket(intptr_t socket)
+		{
+			closesocket((socket_type)socket);
+		}
+
+		int poll_sockets(pollfd* fds, size_t count, int timeout_ms)
+		{
+			return WSAPoll(fds, (ULONG)count, timeout_ms);
+		}
+
+		struct winsock
+		{
+			winsock()
+			{
+				WSADATA data;
+				WSAStartup(MAKEWORD(2, 2), &data);
+			}
+
+			~winsock()
+			{
+				WSACleanup();
+			}
+		};
+#else
+		using socket_type = int;
+
+		void close_socket(intptr_t socket)
+		{
+			::close((socket_type)socket);
+		}
+
+		int poll_sockets(pollfd* fds, size_t count, int timeout_ms)
+		{
+			return ::poll(fds, count, timeout_ms);
+		}
+#endif
+
+		bool send_all(intptr_t socket, std::string_view data)
+		{
+			while (data.size())
+			{
+				const auto sent = ::send((socket_type)socket, data.data(), (int)data.size(), 0);
+				if (sent <= 0)
+				{
+					return false;
+				}
+				data.remove_prefix((size_t)sent);
+			}
+			return true;
+		}
+
+		const char* reason_phrase(int status)
+		{
+			switch (status)
+			{
+			case 200: return "OK";
+			case 206: return "Partial Content";
+			case 304: return "Not Modified";
+			case 404: return "Not Found";
+			case 416: return "Range Not Satisfiable";
+			default:  return "Status";
+			}
+		}
+
+		std::string to_lower(std::string_view text)
+		{
+			std::string result(text);
+			for (auto& c : result)
+			{
+				c = (char)std::tolower((unsigned char)c);
+			}
+			return result;
+		}
+	} // namespace
+
+	http_stand_in::http_stand_in(request_handler on_request) :
+	    m_on_request(std::move(on_request))
+	{
+#ifdef _WIN32
+		static winsock ws;
+#endif
+
+		const auto listen_socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		m_listen_socket          = (intptr_t)listen_socket;
+
+		sockaddr_in address{};
+		address.sin_family      = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port        = 0;
+		::bind(listen_socket, (const sockaddr*)&address, sizeof(address));
+		::listen(listen_socket, 16);
+
+		socklen_t address_size = sizeof(address);
+		::getsockname(listen_socket, (sockaddr*)&address, &address_size);
+		m_port = ntohs(address.sin_port);
+
+		m_accept_thread = std::thread(&http_stand_in::accept_loop, this);
+	}
+
+	http_stand_in::~http_stand_in()
+	{
+		m_stop = true;
+		m_accept_thread.join();
+		close_socket(m_listen_socket);
+
+		// Connections only wait on their own delays, they all end on their own.
+		std::vector<std::thread> connection_threads;
+		{
+			std::unique_lock lock(m_mutex);
+			connection_threads = std::move(m_connection_threads);
+		}
+		for (auto& thread : connection_threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::string http_stand_in::url(const std::string& target) const
+	{
+		return "http://127.0.0.1:" + std::to_string(m_port) + target;
+	}
+
+	std::vector<http_request> http_stand_in::requests()
+	{
+		std::unique_lock lock(m_mutex);
+		return m_requests;
+	}
+
+	void http_stand_in::accept_loop()
+	{
+		while (!m_stop)
+		{
+			pollfd fd{.fd = (socket_type)m_listen_socket, .events = POLLIN};
+			if (poll_sockets(&fd, 1, 20) <= 0)
+			{
+				continue;
+			}
+
+			const auto socket = ::accept((socket_type)m_listen_socket, nullptr, nullptr);
+			if ((intptr_t)socket < 0)
+			{
+				continue;
+			}
+
+			std::unique_lock lock(m_mutex);
+			m_connection_threads.emplace_back(&http_stand_in::serve, this, (intptr_t)socket);
+		}
+	}
+
+	void http_stand_in::serve(intptr_t socket)
+	{
+		std::string received;
+		char buffer[4096];
+		while (received.find("\r\n\r\n") == std::string::npos)
+		{
+			const auto length = ::recv((socket_type)socket, buffer, sizeof(buffer), 0);
+			if (length <= 0)
+			{
+				close_socket(socket);
+				return;
+			}
+			received.append(buffer, (size_t)length);
+		}
+
+		http_request request;
+		std::string_view head(received.data(), received.find("\r\n\r\n"));
+		const auto request_line_end = head.find("\r\n");
+		const auto request_line     = head.substr(0, request_line_end);
+		const auto method_end       = request_line.find(' ');
+		const auto target_end       = request_line.find(' ', method_end + 1);
+		request.method              = std::string(request_line.substr(0, method_end));
+		request.target              = std::string(request_line.substr(method_end + 1, target_end - method_end - 1));
+
+		head.remove_prefix(request_line_end == std::string_view::npos ? head.size() : request_line_end + 2);
+		while (head.size())
+		{
+			const auto line_end = head.find("\r\n");
+			const auto line     = head.substr(0, line_end);
+			const auto colon    = line.find(':');
+			if (colon != std::string_view::npos)
+			{
+				auto value = line.substr(colon + 1);
+				while (value.size() && value.front() == ' ')
+				{
+					value.remove_prefix(1);
+				}
+				request.headers[to_lower(line.substr(0, colon))] = std::string(value);
+			}
+			head.remove_prefix(line_end == std::string_view::npos ? head.size() : line_end + 2);
+		}
+
+		{
+			std::unique_lock lock(m_mutex);
+			m_requests.push_back(request);
+		}
+
+		const auto response = m_on_request(request);
+
+		std::string response_head = "HTTP/1.1 " + std::to_string(response.status) + " " + reason_phrase(response.status) + "\r\n";
+		for (const auto& [name, value] : response.headers)
+		{
+			response_head += name + ": " + value + "\r\n";
+		}
+		if (response.status != 304)
+		{
+			response_head += "Content-Length: " + std::to_string(response.content_length ? response.content_length : response.body.size()) + "\r\n";
+		}
+		response_head += "Connection: close\r\n\r\n";
+
+		if (send_all(socket, response_head))
+		{
+			std::string_view body = std::string_view(response.body).substr(0, std::min(response.body.size(), response.drop_after));
+			const auto chunk_size = response.chunk_size ? response.chunk_size : body.size();
+			while (body.size() && !m_stop)
+			{
+				const auto chunk = body.substr(0, chunk_size);
+				if (!send_all(socket, chunk))
+				{
+					break;
+				}
+				body.remove_prefix(chunk.size());
+
+				if (body.size() && response.chunk_delay.count())
+				{
+					std::this_thread::sleep_for(response.chunk_delay);
+				}
+			}
+		}
+
+#ifdef _WIN32
+		::shutdown((socket_type)socket, SD_SEND);
+#else
+		::shutdown((socket_type)socket, SHUT_WR);
+#endif
+		close_socket(socket);
+	}
+} // namespace imm::test
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace imm::test
+{
+	struct http_request
+	{
+		std::string method;
+		std::string target;
+		// Names lower case.
+		std::map<std::string, std::string> headers;
+
+		std::string header(const std::string& name) const
+		{
+			const auto it = headers.find(name);
+			return it != headers.end() ? it->second : "";
+		}
+	};
+
+	struct http_response
+	{
+		int status = 200;
+		std::vector<std::pair<std::string, std::string>> headers{};
+		std::string body{};
+
+		// Content-Length sent, body.size() when 0. Lets a response announce more than it sends.
+		uint64_t content_length = 0;
+		// Throttling: the body goes out chunk_size bytes at a time with chunk_delay between chunks.
+		size_t chunk_size = 0;
+		std::chrono::milliseconds chunk_delay{};
+		// The connection is closed once this many body bytes are out, as if the transfer dropped.
+		size_t drop_after = SIZE_MAX;
+	};
+
+	// HTTP/1.1 server on 127.0.0.1 standing in for Thunderstore, every connection is answered by on_request
+	// on a thread of its own and closed after one response.
+	class http_stand_in
+	{
+	public:
+		using request_handler = std::function<http_response(const http_request&)>;
+
+	private:
+		request_handler m_on_request;
+		intptr_t m_listen_socket = -1;
+		uint16_t m_port          = 0;
+
+		std::atomic<bool> m_stop = false;
+		std::thread m_accept_thread;
+
+		std::mutex m_mutex;
+		std::vector<std::thread> m_connection_threads;
+		std::vector<http_request> m_requests;
+
+		void accept_loop();
+		void serve(intptr_t socket);
+
+	public:
+		explicit http_stand_in(request_handler on_request);
+		~http_stand_in();
+
+		http_stand_in(const http_stand_in&)            = delete;
+		http_stand_in& operator=(const http_stand_in&) = delete;
+
+		// "http://127.0.0.1:<port><target>"
+		std::string url(const std::string& target) const;
+
+		// Every request received so far, in arrival order.
+		std::vector<http_request> requests();
+	};
+} // namespace imm::test
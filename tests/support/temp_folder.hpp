@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+namespace imm::test
+{
+	// Empty folder under the system temp folder, removed with everything in it on destruction.
+	class temp_folder
+	{
+		std::filesystem::path m_path;
+
+	public:
+		temp_folder()
+		{
+			static std::atomic<uint64_t> counter = 0;
+			m_path = std::filesystem::temp_directory_path() /
+			         ("imm_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" + std::to_string(counter++));
+			std::filesystem::create_directories(m_path);
+		}
+
+		~temp_folder()
+		{
+			std::error_code ec;
+			std::filesystem::remove_all(m_path, ec);
+		}
+
+		temp_folder(const temp_folder&)            = delete;
+		temp_folder& operator=(const temp_folder&) = delete;
+
+		const std::filesystem::path& path() const
+		{
+			return m_path;
+		}
+
+		std::filesystem::path operator/(const std::filesystem::path& relative) const
+		{
+			return m_path / relative;
+		}
+	};
+} // namespace imm::test
@@ -0,0 +1,145 @@
+#include "support/http_stand_in.hpp"
+#include "support/temp_folder.hpp"
+#include "thunderstore/v1/catalog_cache.hpp"
+
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace
+{
+	const std::string index_v1 = R"([
+		{"name": "Alpha", "full_name": "Owner-Alpha", "owner": "Owner", "categories": ["Mods"],
+		 "versions": [{"name": "Alpha", "full_name": "Owner-Alpha-1.0.0", "version_number": "1.0.0", "dependencies": []}]},
+		{"name": "Beta", "full_name": "Owner-Beta", "owner": "Owner", "categories": ["Tools"],
+		 "versions": [{"name": "Beta", "full_name": "Owner-Beta-2.0.0", "version_number": "2.0.0", "dependencies": ["Owner-Alpha-1.0.0"]}]}
+	])";
+
+	// Serves index_v1 with an ETag, answers 304 when it is sent back.
+	imm::test::http_response serve_index(const imm::test::http_request& request)
+	{
+		if (request.header("if-none-match") == "\"v1\"")
+		{
+			return {.status = 304, .headers = {{"ETag", "\"v1\""}}};
+		}
+		return {.status = 200, .headers = {{"ETag", "\"v1\""}, {"Last-Modified", "Tue, 01 Oct 2024 00:00:00 GMT"}}, .body = index_v1};
+	}
+
+	std::vector<std::string> full_names_of(const std::vector<ts::v1::package>& packages)
+	{
+		std::vector<std::string> full_names;
+		for (const auto& package : packages)
+		{
+			full_names.push_back(package.full_name);
+		}
+		return full_names;
+	}
+} // namespace
+
+TEST(catalog_cache, first_refresh_streams_the_index_and_writes_a_snapshot)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(serve_index);
+
+	ts::v1::catalog_cache cache(folder.path());
+	EXPECT_FALSE(cache.load_snapshot([](const ts::v1::package_view&) {}));
+
+	std::vector<ts::v1::package> packages;
+	const auto result = cache.refresh(server.url("/api/v1/package/"),
+	                                  [&](ts::v1::package&& package)
+	                                  {
+		                                  packages.push_back(std::move(package));
+	                                  });
+
+	EXPECT_EQ(result, ts::v1::catalog_cache::refresh_result::updated);
+	EXPECT_EQ(full_names_of(packages), (std::vector<std::string>{"Owner-Alpha", "Owner-Beta"}));
+	ASSERT_EQ(server.requests().size(), 1u);
+	EXPECT_EQ(server.requests()[0].header("if-none-match"), "");
+	EXPECT_TRUE(std::filesystem::exists(folder / "catalog.bin"));
+}
+
+TEST(catalog_cache, warm_refresh_revalidates_and_keeps_the_snapshot_on_304)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(serve_index);
+	const auto url = server.url("/api/v1/package/");
+
+	ts::v1::catalog_cache(folder.path()).refresh(url, [](ts::v1::package&&) {});
+
+	ts::v1::catalog_cache cache(folder.path());
+	std::vector<ts::v1::package> snapshot_packages;
+	ASSERT_TRUE(cache.load_snapshot(
+	    [&](const ts::v1::package_view& package)
+	    {
+		    snapshot_packages.push_back(package.to_package());
+	    }));
+	EXPECT_EQ(full_names_of(snapshot_packages), (std::vector<std::string>{"Owner-Alpha", "Owner-Beta"}));
+	ASSERT_EQ(snapshot_packages[1].versions.size(), 1u);
+	ASSERT_EQ(snapshot_packages[1].versions[0].dependencies.size(), 1u);
+	EXPECT_EQ(snapshot_packages[1].versions[0].dependencies[0].str(), "Owner-Alpha-1.0.0");
+
+	size_t refreshed_count = 0;
+	const auto result      = cache.refresh(url,
+	                                       [&](ts::v1::package&&)
+	                                       {
+		                                       refreshed_count++;
+	                                       });
+
+	EXPECT_EQ(result, ts::v1::catalog_cache::refresh_result::not_modified);
+	EXPECT_EQ(refreshed_count, 0u);
+	const auto requests = server.requests();
+	ASSERT_EQ(requests.size(), 2u);
+	EXPECT_EQ(requests[1].header("if-none-match"), "\"v1\"");
+	EXPECT_EQ(requests[1].header("if-modified-since"), "Tue, 01 Oct 2024 00:00:00 GMT");
+}
+
+TEST(catalog_cache, validators_are_not_sent_without_a_loaded_snapshot)
+{
+	imm::test::temp_folder folder;
+	imm::test::http_stand_in server(serve_index);
+	const auto url = server.url("/api/v1/package/");
+
+	ts::v1::catalog_cache(folder.path()).refresh(url, [](ts::v1::package&&) {});
+
+	// A 304 here would leave the caller with no packages at all.
+	size_t refreshed_count = 0;
+	const auto result      = ts::v1::catalog_cache(folder.path())
+	                        .refresh(url,
+	                                 [&](ts::v1::package&&)
+	                                 {
+		                                 refreshed_count++;
+	                                 });
+
+	EXPECT_EQ(result, ts::v1::catalog_cache::refresh_result::updated);
+	EXPECT_EQ(refreshed_count, 2u);
+	EXPECT_EQ(server.requests().back().header("if-none-match"), "");
+}
+
+TEST(catalog_cache, failed_refresh_keeps_the_previous_snapshot)
+{
+	imm::test::temp_folder folder;
+	std::atomic<bool> broken = false;
+	imm::test::http_stand_in server(
+	    [&](const imm::test::http_request& request)
+	    {
+		    if (broken)
+		    {
+			    return imm::test::http_response{.status = 200, .body = R"([{"name": "Alpha", "versions": [)"};
+		    }
+		    return serve_index(request);
+	    });
+	const auto url = server.url("/api/v1/package/");
+
+	ts::v1::catalog_cache(folder.path()).refresh(url, [](ts::v1::package&&) {});
+
+	broken = true;
+	EXPECT_EQ(ts::v1::catalog_cache(folder.path()).refresh(url, [](ts::v1::package&&) {}), ts::v1::catalog_cache::refresh_result::failed);
+
+	size_t snapshot_count = 0;
+	EXPECT_TRUE(ts::v1::catalog_cache(folder.path())
+	                .load_snapshot(
+	                    [&](const ts::v1::package_view&)
+	                    {
+		                    snapshot_count++;
+	                    }));
+	EXPECT_EQ(snapshot_count, 2u);
+}
@@ -0,0 +1,73 @@
+#include "thunderstore/v1/package_lookup.hpp"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+	ts::v1::package make_package(std::string full_name, std::vector<std::string> version_numbers, bool is_local = false)
+	{
+		ts::v1::package pkg{};
+		pkg.full_name = std::move(full_name);
+		pkg.is_local  = is_local;
+		for (auto& version_number : version_numbers)
+		{
+			pkg.versions.push_back({.full_name = pkg.full_name + "-" + version_number, .version_number = version_number});
+		}
+		return pkg;
+	}
+} // namespace
+
+TEST(package_lookup, finds_packages_and_versions)
+{
+	auto bosses = make_package("Owner-Bosses", {"1.1.0", "1.0.0"});
+	auto items  = make_package("Owner-Items", {"2.0.0"});
+
+	ts::v1::package_lookup lookup;
+	lookup.add(&bosses);
+	lookup.add(&items);
+
+	EXPECT_EQ(lookup.find_package("Owner-Items"), &items);
+	EXPECT_EQ(lookup.find_package("Owner-Nothing"), nullptr);
+
+	const auto by_name = lookup.find_version("Owner-Bosses", "1.0.0");
+	ASSERT_TRUE(by_name);
+	EXPECT_EQ(by_name->pkg, &bosses);
+	EXPECT_EQ(by_name->version_index, 1);
+
+	const auto by_full_name = lookup.find_version("Owner-Bosses-1.1.0");
+	ASSERT_TRUE(by_full_name);
+	EXPECT_EQ(by_full_name->version_index, 0);
+
+	EXPECT_FALSE(lookup.find_version("Owner-Bosses", "3.0.0"));
+	EXPECT_FALSE(lookup.find_version("Owner-Bosses-3.0.0"));
+}
+
+TEST(package_lookup, prefers_the_catalog_package_over_a_local_one)
+{
+	auto local   = make_package("Owner-Bosses", {"1.0.0"}, true);
+	auto catalog = make_package("Owner-Bosses", {"1.0.0", "0.9.0"});
+
+	ts::v1::package_lookup lookup;
+	lookup.add(&local);
+	lookup.add(&catalog);
+
+	EXPECT_EQ(lookup.find_package("Owner-Bosses"), &catalog);
+	// Versions go to whichever was added first.
+	EXPECT_EQ(lookup.find_version("Owner-Bosses-1.0.0")->pkg, &local);
+	EXPECT_EQ(lookup.find_version("Owner-Bosses", "0.9.0")->pkg, &catalog);
+}
+
+TEST(package_lookup, follows_replaced_versions)
+{
+	auto bosses = make_package("Owner-Bosses", {"1.0.0"});
+
+	ts::v1::package_lookup lookup;
+	lookup.add(&bosses);
+
+	lookup.remove_versions(&bosses);
+	bosses.versions = make_package("Owner-Bosses", {"1.1.0", "1.0.0"}).versions;
+	lookup.add_versions(&bosses);
+
+	EXPECT_EQ(lookup.find_version("Owner-Bosses-1.0.0")->version_index, 1);
+	EXPECT_EQ(lookup.find_version("Owner-Bosses-1.1.0")->version_index, 0);
+}
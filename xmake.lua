@@ -59,6 +59,8 @@ add_requires("spdlog 1.13.0")
 
 add_requires("imgui v1.90.4-docking", { configs = { wchar32 = true, freetype = true } })
 
+add_requires("gtest")
+
 target("ImmediateModManager")
     add_defines("WIN32_LEAN_AND_MEAN", "NOMINMAX", "WINVER=0x0601", "_SILENCE_STDEXT_ARR_ITERS_DEPRECATION_WARNING", "SPDLOG_WCHAR_TO_UTF8_SUPPORT", "SPDLOG_WCHAR_FILENAMES", "SPDLOG_WCHAR_SUPPORT")
     set_kind("binary")
@@ -67,4 +69,35 @@ target("ImmediateModManager")
     add_headerfiles("src/**.h", "src/**.hpp")
     add_includedirs("src/")
     add_syslinks("User32", "Shell32", "Version", "d3d11", "dxgi")
-    add_packages("nlohmann_json", "semver", "imgui", "cpr", "stb", "kuba-zip", "breakpad", "spdlog")
\ No newline at end of file
+    add_packages("nlohmann_json", "semver", "imgui", "cpr", "stb", "kuba-zip", "breakpad", "spdlog")
+
+-- Everything but the window, the renderer and the panels, shared by the benchmarks and the tests.
+local headless_files = "src/**.cpp|main.cpp|gui/gui.cpp|imgui_impl/**.cpp|imgui_toggle/**.cpp|icons/icon_cache.cpp"
+
+-- One executable per file in bench/, so peak RSS only covers what that benchmark measured.
+-- Not built by default: xmake build -g bench, then xmake run bench_<name> <args>.
+-- tests/support comes along for the local HTTP server the network benchmarks download from.
+for _, file in ipairs(os.files("bench/*_bench.cpp")) do
+    local name = path.basename(file):gsub("_bench$", "")
+    target("bench_" .. name)
+        set_kind("binary")
+        set_default(false)
+        set_group("bench")
+        add_defines("WIN32_LEAN_AND_MEAN", "NOMINMAX", "WINVER=0x0601", "_SILENCE_STDEXT_ARR_ITERS_DEPRECATION_WARNING", "SPDLOG_WCHAR_TO_UTF8_SUPPORT", "SPDLOG_WCHAR_FILENAMES", "SPDLOG_WCHAR_SUPPORT")
+        add_files(file, headless_files, "tests/support/*.cpp")
+        add_includedirs("src/", "bench/", "tests/")
+        add_syslinks("User32", "Shell32", "Version", "Psapi", "Ws2_32")
+        add_packages("nlohmann_json", "semver", "imgui", "cpr", "stb", "kuba-zip", "spdlog")
+end
+
+-- Not built by default: xmake build tests, then xmake run tests (or xmake test).
+target("tests")
+    set_kind("binary")
+    set_default(false)
+    set_group("test")
+    add_defines("WIN32_LEAN_AND_MEAN", "NOMINMAX", "WINVER=0x0601", "_SILENCE_STDEXT_ARR_ITERS_DEPRECATION_WARNING", "SPDLOG_WCHAR_TO_UTF8_SUPPORT", "SPDLOG_WCHAR_FILENAMES", "SPDLOG_WCHAR_SUPPORT")
+    add_files("tests/**.cpp", headless_files)
+    add_includedirs("src/", "tests/")
+    add_syslinks("User32", "Shell32", "Version", "Ws2_32")
+    add_packages("nlohmann_json", "semver", "imgui", "cpr", "stb", "kuba-zip", "spdlog", "gtest")
+    add_tests("default")